@@ -0,0 +1,68 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include "act_lat.h"
+
+static int lat_bucket(uint32_t us)
+{
+    int b = 0;
+    while (us && b < ACT_LAT_BUCKETS - 1) {
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+static uint32_t lat_bucket_max(int b)
+{
+    return b == 0 ? 0 : (1u << b) - 1;
+}
+
+void act_lat_add(act_lat_t *lat, int64_t us)
+{
+    uint32_t v = us < 0 ? 0 : (us > UINT32_MAX ? UINT32_MAX : (uint32_t)us);
+    lat->bucket[lat_bucket(v)]++;
+    lat->count++;
+    lat->sum_us += v;
+    if (v > lat->max_us) {
+        lat->max_us = v;
+    }
+}
+
+uint32_t act_lat_percentile(const act_lat_t *lat, int pct)
+{
+    if (lat->count == 0) {
+        return 0;
+    }
+    // rank of the sample, rounded up so p100 is the last one
+    uint64_t rank = ((uint64_t)lat->count * pct + 99) / 100;
+    uint64_t seen = 0;
+    for (int b = 0; b < ACT_LAT_BUCKETS; b++) {
+        seen += lat->bucket[b];
+        if (seen >= rank && seen > 0) {
+            // the open-ended bucket reports the largest sample
+            return b == ACT_LAT_BUCKETS - 1 ? lat->max_us : lat_bucket_max(b);
+        }
+    }
+    return lat->max_us;
+}
+
+void act_lat_print(const act_lat_t *lat, const char *name)
+{
+    if (lat->count == 0) {
+        printf("%s latency: no samples\n", name);
+        return;
+    }
+    printf("%s latency: %lu samples, avg %lu us, p50 < %lu us, p99 < %lu us, max %lu us\n", name,
+           (unsigned long)lat->count, (unsigned long)(lat->sum_us / lat->count),
+           (unsigned long)act_lat_percentile(lat, 50) + 1, (unsigned long)act_lat_percentile(lat, 99) + 1,
+           (unsigned long)lat->max_us);
+    for (int b = 0; b < ACT_LAT_BUCKETS; b++) {
+        if (lat->bucket[b]) {
+            uint32_t hi = b == ACT_LAT_BUCKETS - 1 ? lat->max_us : lat_bucket_max(b);
+            printf("  %6lu - %6lu us %lu\n", b == 0 ? 0ul : (unsigned long)(1ul << (b - 1)),
+                   (unsigned long)hi, (unsigned long)lat->bucket[b]);
+        }
+    }
+}
@@ -0,0 +1,232 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "act_sim.h"
+
+// WS2812 at 800 kHz
+#define STRIP_BIT_NS    (1200)
+#define STRIP_RESET_US  (50)
+
+static void sim_log(act_sim_t *sim, act_event_kind_t kind, int id, uint32_t value, size_t bytes)
+{
+    if (sim->event_num == sim->event_cap) {
+        sim->dropped++;
+        return;
+    }
+    act_event_t *e = &sim->events[sim->event_num++];
+    e->t_us = sim->now_us;
+    e->kind = kind;
+    e->id = id;
+    e->bytes = bytes;
+    e->value = value;
+}
+
+static uint32_t fnv1a(const uint8_t *data, size_t bytes)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < bytes; i++) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+static esp_err_t sim_pwm_init(void *ctx, const int *gpio, int channel_num, uint32_t freq_hz, uint32_t duty_bits)
+{
+    act_sim_t *sim = ctx;
+    if (channel_num <= 0 || channel_num > ACT_SIM_PWM_CHANNELS || freq_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim->pwm_num = channel_num;
+    sim->pwm_on = true;
+    memset(sim->duty, 0, sizeof(sim->duty));
+    return ESP_OK;
+}
+
+static esp_err_t sim_pwm_write(void *ctx, uint32_t mask, const uint32_t *duty)
+{
+    act_sim_t *sim = ctx;
+    if (mask >> sim->pwm_num) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int ch = 0; ch < sim->pwm_num; ch++) {
+        if (mask & (1 << ch)) {
+            sim->duty[ch] = duty[ch];
+            sim_log(sim, ACT_EVENT_PWM, ch, duty[ch], 0);
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t sim_pwm_enable(void *ctx, bool on)
+{
+    act_sim_t *sim = ctx;
+    if (on != sim->pwm_on) {
+        sim->pwm_on = on;
+        sim_log(sim, ACT_EVENT_PWM_ENABLE, 0, on, 0);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t sim_strip_init(void *ctx, const act_strip_cfg_t *cfg, int strip_num, bool dma)
+{
+    act_sim_t *sim = ctx;
+    if (strip_num <= 0 || strip_num > ACT_SIM_STRIPS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < strip_num; i++) {
+        act_sim_strip_t *strip = &sim->strips[i];
+        strip->cfg = cfg[i];
+        strip->done_us = 0;
+        strip->frame = calloc(cfg[i].pixel_num, 3);
+        strip->symbols = cfg[i].encode ? malloc(cfg[i].symbol_num * sizeof(uint32_t)) : NULL;
+        if (strip->frame == NULL || (cfg[i].encode && strip->symbols == NULL)) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    sim->strip_num = strip_num;
+    return ESP_OK;
+}
+
+static esp_err_t sim_strip_send(void *ctx, int strip_id, const uint8_t *grb, size_t bytes)
+{
+    act_sim_t *sim = ctx;
+    if (strip_id < 0 || strip_id >= sim->strip_num || bytes > sim->strips[strip_id].cfg.pixel_num * 3u) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    act_sim_strip_t *strip = &sim->strips[strip_id];
+    // the callers keep one frame in flight, a second one here is a bug in the engine
+    if (strip->done_us) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (strip->cfg.encode) {
+        strip->cfg.encode(strip->cfg.encode_ctx, grb, bytes, strip->symbols);
+    }
+    memcpy(strip->frame, grb, bytes);
+    strip->done_us = sim->now_us + act_sim_strip_time_us(bytes);
+    sim_log(sim, ACT_EVENT_STRIP, strip_id, fnv1a(grb, bytes), bytes);
+    return ESP_OK;
+}
+
+static int sim_dout_find(const act_sim_t *sim, int gpio)
+{
+    for (int i = 0; i < sim->dout_num; i++) {
+        if (sim->dout_gpio[i] == gpio) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static esp_err_t sim_dout_init(void *ctx, int gpio)
+{
+    act_sim_t *sim = ctx;
+    if (sim_dout_find(sim, gpio) >= 0) {
+        return ESP_OK;
+    }
+    if (sim->dout_num == ACT_SIM_DOUTS) {
+        return ESP_ERR_NO_MEM;
+    }
+    sim->dout_gpio[sim->dout_num] = gpio;
+    sim->dout_level[sim->dout_num] = 0;
+    sim->dout_num++;
+    return ESP_OK;
+}
+
+static esp_err_t sim_dout_write(void *ctx, int gpio, int level)
+{
+    act_sim_t *sim = ctx;
+    int i = sim_dout_find(sim, gpio);
+    if (i < 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    sim->dout_level[i] = level ? 1 : 0;
+    sim_log(sim, ACT_EVENT_DOUT, gpio, sim->dout_level[i], 0);
+    return ESP_OK;
+}
+
+static int64_t sim_now_us(void *ctx)
+{
+    act_sim_t *sim = ctx;
+    return sim->now_us;
+}
+
+static const act_hal_ops_t sim_ops = {
+    .pwm_init = sim_pwm_init,
+    .pwm_write = sim_pwm_write,
+    .pwm_enable = sim_pwm_enable,
+    .strip_init = sim_strip_init,
+    .strip_send = sim_strip_send,
+    .dout_init = sim_dout_init,
+    .dout_write = sim_dout_write,
+    .now_us = sim_now_us,
+};
+
+esp_err_t act_sim_init(act_sim_t *sim, size_t event_cap)
+{
+    memset(sim, 0, sizeof(*sim));
+    sim->events = calloc(event_cap, sizeof(act_event_t));
+    if (event_cap && sim->events == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    sim->event_cap = event_cap;
+    sim->hal.ops = &sim_ops;
+    sim->hal.ctx = sim;
+    return ESP_OK;
+}
+
+void act_sim_deinit(act_sim_t *sim)
+{
+    for (int i = 0; i < ACT_SIM_STRIPS; i++) {
+        free(sim->strips[i].frame);
+        free(sim->strips[i].symbols);
+        sim->strips[i].frame = NULL;
+        sim->strips[i].symbols = NULL;
+    }
+    free(sim->events);
+    sim->events = NULL;
+}
+
+void act_sim_advance(act_sim_t *sim, int64_t us)
+{
+    int64_t end = sim->now_us + us;
+    for (;;) {
+        // earliest strip to finish, a done callback may start the next frame on any strip
+        int next = -1;
+        for (int i = 0; i < sim->strip_num; i++) {
+            int64_t done = sim->strips[i].done_us;
+            if (done && done <= end && (next < 0 || done < sim->strips[next].done_us)) {
+                next = i;
+            }
+        }
+        if (next < 0) {
+            break;
+        }
+        act_sim_strip_t *strip = &sim->strips[next];
+        sim->now_us = strip->done_us;
+        strip->done_us = 0;
+        sim_log(sim, ACT_EVENT_STRIP_DONE, next, 0, 0);
+        if (strip->cfg.done) {
+            strip->cfg.done(strip->cfg.done_ctx);
+        }
+    }
+    sim->now_us = end;
+}
+
+int64_t act_sim_strip_time_us(size_t bytes)
+{
+    return (int64_t)bytes * 8 * STRIP_BIT_NS / 1000 + STRIP_RESET_US;
+}
+
+int act_sim_dout_level(const act_sim_t *sim, int gpio)
+{
+    int i = sim_dout_find(sim, gpio);
+    return i < 0 ? -1 : sim->dout_level[i];
+}
+
+void act_sim_clear(act_sim_t *sim)
+{
+    sim->event_num = 0;
+    sim->dropped = 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ACT_STRIP_RESOLUTION_HZ (10000000)  /*!< Strip bit timing, 1 tick = 0.1 us */
+
+/**
+ * @brief The strip finished sending the last frame, runs in the transmit done ISR on hardware
+ */
+typedef void (*act_strip_done_t)(void *ctx);
+
+/**
+ * @brief Encode a frame into RMT symbols ahead of sending it, returns the symbol count
+ */
+typedef size_t (*act_strip_encode_t)(void *ctx, const uint8_t *grb, size_t bytes, uint32_t *symbols);
+
+typedef struct {
+    int                gpio_num;
+    uint16_t           pixel_num;
+    act_strip_encode_t encode;      /*!< NULL to encode while sending */
+    void              *encode_ctx;
+    size_t             symbol_num;  /*!< Most symbols `encode` writes for one frame */
+    act_strip_done_t   done;
+    void              *done_ctx;
+} act_strip_cfg_t;
+
+/**
+ * @brief Backend of every actuator output: PWM channels on one timer, addressable strips and digital outputs
+ *
+ * Engines only talk to these, so the same code drives the hardware or a simulation that
+ * records what would have gone out.
+ */
+typedef struct {
+    esp_err_t (*pwm_init)(void *ctx, const int *gpio, int channel_num, uint32_t freq_hz, uint32_t duty_bits);
+    /**
+     * Set the duties of the channels in `mask` to `duty[channel]`, latched together at the next period
+     */
+    esp_err_t (*pwm_write)(void *ctx, uint32_t mask, const uint32_t *duty);
+    /**
+     * Start or stop the PWM timer, a stopped timer holds every output low. A started timer
+     * begins a new period, duties written after that are latched at the next period.
+     */
+    esp_err_t (*pwm_enable)(void *ctx, bool on);
+    /**
+     * Set up all strips at once, with `dma` the longest one gets the DMA channel if there is one
+     */
+    esp_err_t (*strip_init)(void *ctx, const act_strip_cfg_t *cfg, int strip_num, bool dma);
+    /**
+     * Start sending a GRB frame without waiting, `grb` stays untouched until the done callback
+     */
+    esp_err_t (*strip_send)(void *ctx, int strip, const uint8_t *grb, size_t bytes);
+    esp_err_t (*dout_init)(void *ctx, int gpio);
+    esp_err_t (*dout_write)(void *ctx, int gpio, int level);
+    int64_t   (*now_us)(void *ctx);
+} act_hal_ops_t;
+
+typedef struct {
+    const act_hal_ops_t *ops;
+    void                *ctx;
+} act_hal_t;
+
+/**
+ * @brief Hardware backend: LEDC timer 0 low speed channels, RMT TX strips and GPIO outputs
+ */
+act_hal_t *act_hal_default(void);
+
+static inline esp_err_t act_pwm_init(act_hal_t *hal, const int *gpio, int channel_num, uint32_t freq_hz, uint32_t duty_bits)
+{
+    return hal->ops->pwm_init(hal->ctx, gpio, channel_num, freq_hz, duty_bits);
+}
+
+static inline esp_err_t act_pwm_write(act_hal_t *hal, uint32_t mask, const uint32_t *duty)
+{
+    return hal->ops->pwm_write(hal->ctx, mask, duty);
+}
+
+static inline esp_err_t act_pwm_enable(act_hal_t *hal, bool on)
+{
+    return hal->ops->pwm_enable(hal->ctx, on);
+}
+
+static inline esp_err_t act_strip_init(act_hal_t *hal, const act_strip_cfg_t *cfg, int strip_num, bool dma)
+{
+    return hal->ops->strip_init(hal->ctx, cfg, strip_num, dma);
+}
+
+static inline esp_err_t act_strip_send(act_hal_t *hal, int strip, const uint8_t *grb, size_t bytes)
+{
+    return hal->ops->strip_send(hal->ctx, strip, grb, bytes);
+}
+
+static inline esp_err_t act_dout_init(act_hal_t *hal, int gpio)
+{
+    return hal->ops->dout_init(hal->ctx, gpio);
+}
+
+static inline esp_err_t act_dout_write(act_hal_t *hal, int gpio, int level)
+{
+    return hal->ops->dout_write(hal->ctx, gpio, level);
+}
+
+static inline int64_t act_now_us(act_hal_t *hal)
+{
+    return hal->ops->now_us(hal->ctx);
+}
+
+#ifdef __cplusplus
+}
+#endif
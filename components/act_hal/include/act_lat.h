@@ -0,0 +1,40 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ACT_LAT_BUCKETS     (16)    /*!< Powers of two up to 32 ms, the last bucket takes everything above */
+
+/**
+ * @brief Histogram of request to output latencies, one bucket per power of two microseconds
+ *
+ * Bucket 0 holds 0 us, bucket n holds 2^(n-1) to 2^n - 1 us.
+ */
+typedef struct {
+    uint32_t bucket[ACT_LAT_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t sum_us;
+} act_lat_t;
+
+void act_lat_add(act_lat_t *lat, int64_t us);
+
+/**
+ * @brief Upper bound of the bucket holding the `pct` percentile, 0 when empty
+ */
+uint32_t act_lat_percentile(const act_lat_t *lat, int pct);
+
+/**
+ * @brief One summary line and one line per non-empty bucket
+ */
+void act_lat_print(const act_lat_t *lat, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
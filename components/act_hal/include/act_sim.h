@@ -0,0 +1,100 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include "act_hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ACT_SIM_PWM_CHANNELS    (8)
+#define ACT_SIM_STRIPS          (4)
+#define ACT_SIM_DOUTS           (4)
+
+typedef enum {
+    ACT_EVENT_PWM = 0,      /*!< `id` channel, `value` duty, one event per channel of a batch */
+    ACT_EVENT_PWM_ENABLE,   /*!< `value` 1 when the timer starts, 0 when it stops */
+    ACT_EVENT_STRIP,        /*!< `id` strip, `value` FNV-1a hash of the frame, `bytes` its length */
+    ACT_EVENT_STRIP_DONE,   /*!< `id` strip, the frame is on the wire and the reset time has passed */
+    ACT_EVENT_DOUT,         /*!< `id` GPIO, `value` level */
+} act_event_kind_t;
+
+typedef struct {
+    int64_t  t_us;
+    uint8_t  kind;          /*!< act_event_kind_t */
+    uint8_t  id;
+    uint16_t bytes;
+    uint32_t value;
+} act_event_t;
+
+typedef struct {
+    act_strip_cfg_t cfg;
+    uint8_t        *frame;      /*!< Copy of the last frame sent */
+    uint32_t       *symbols;    /*!< Pre-encoded like on hardware, so a profile includes the encoding */
+    int64_t         done_us;    /*!< When the frame in flight is out, 0 when idle */
+} act_sim_strip_t;
+
+/**
+ * @brief Backend that records every output with the time of a virtual clock
+ *
+ * Nothing happens on its own, the test moves the clock with `act_sim_advance`, which also
+ * reports strips done once a frame would have left the wire at WS2812 speed.
+ */
+typedef struct {
+    act_hal_t       hal;
+    int64_t         now_us;
+    act_event_t    *events;
+    size_t          event_cap;
+    size_t          event_num;
+    uint32_t        dropped;    /*!< Events past `event_cap` */
+    uint32_t        duty[ACT_SIM_PWM_CHANNELS];
+    int             pwm_num;
+    bool            pwm_on;
+    act_sim_strip_t strips[ACT_SIM_STRIPS];
+    int             strip_num;
+    int             dout_gpio[ACT_SIM_DOUTS];
+    int             dout_level[ACT_SIM_DOUTS];
+    int             dout_num;
+} act_sim_t;
+
+/**
+ * @return
+ *    - ESP_OK              Success
+ *    - ESP_ERR_NO_MEM      Event log could not be allocated
+ */
+esp_err_t act_sim_init(act_sim_t *sim, size_t event_cap);
+
+void act_sim_deinit(act_sim_t *sim);
+
+/**
+ * @brief Move the clock forward, strips whose frame is out by then report done in time order
+ */
+void act_sim_advance(act_sim_t *sim, int64_t us);
+
+/**
+ * @brief Time a frame of `bytes` takes on the wire, 1.2 us per bit plus the 50 us reset
+ */
+int64_t act_sim_strip_time_us(size_t bytes);
+
+/**
+ * @brief Level of a digital output, -1 when it was never set up
+ */
+int act_sim_dout_level(const act_sim_t *sim, int gpio);
+
+/**
+ * @brief Forget the recorded events, the output state stays
+ */
+void act_sim_clear(act_sim_t *sim);
+
+/**
+ * @brief Simulation behind `act_hal_default()` on the linux target, which follows the monotonic clock
+ *
+ * Only there, and only to be read once the engines writing to it are stopped.
+ */
+act_sim_t *act_sim_default(void);
+
+#ifdef __cplusplus
+}
+#endif
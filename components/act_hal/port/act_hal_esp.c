@@ -0,0 +1,349 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2022 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "driver/rmt_tx.h"
+#include "soc/soc_caps.h"
+#include "act_hal.h"
+
+static const char *TAG = "MK39 Actuator HAL";
+
+#define ACT_PWM_TIMER       LEDC_TIMER_0
+#define ACT_STRIP_MAX       SOC_RMT_TX_CANDIDATES_PER_GROUP
+// a DMA strip runs on two descriptors of at most 4092 bytes, a frame that fits needs no refills
+#define ACT_DMA_MAX_SYMBOLS (2 * 4092 / sizeof(rmt_symbol_word_t))
+
+typedef struct {
+    act_strip_cfg_t cfg;
+    rmt_channel_handle_t chan;
+    rmt_encoder_handle_t encoder;   // copy encoder for pre-encoded symbols, led strip encoder without them
+    uint32_t *symbols;              // frame encoded before sending, NULL when encoded in the ISR
+    bool dma;
+} act_esp_strip_t;
+
+typedef struct {
+    int pwm_num;
+    act_esp_strip_t strips[ACT_STRIP_MAX];
+    int strip_num;
+} act_esp_t;
+
+static act_esp_t esp_ctx;
+static rmt_transmit_config_t tx_config = {
+    .loop_count = 0, // no transfer loop
+};
+
+typedef struct {
+    rmt_encoder_t base;
+    rmt_encoder_t *bytes_encoder;
+    rmt_encoder_t *copy_encoder;
+    int state;
+    rmt_symbol_word_t reset_code;
+} rmt_led_strip_encoder_t;
+
+static size_t rmt_encode_led_strip(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
+{
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    rmt_encoder_handle_t bytes_encoder = led_encoder->bytes_encoder;
+    rmt_encoder_handle_t copy_encoder = led_encoder->copy_encoder;
+    rmt_encode_state_t session_state = RMT_ENCODING_RESET;
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    size_t encoded_symbols = 0;
+    switch (led_encoder->state) {
+    case 0: // send RGB data
+        encoded_symbols += bytes_encoder->encode(bytes_encoder, channel, primary_data, data_size, &session_state);
+        if (session_state & RMT_ENCODING_COMPLETE) {
+            led_encoder->state = 1; // switch to next state when current encoding session finished
+        }
+        if (session_state & RMT_ENCODING_MEM_FULL) {
+            state |= RMT_ENCODING_MEM_FULL;
+            goto out; // yield if there's no free space for encoding artifacts
+        }
+    // fall-through
+    case 1: // send reset code
+        encoded_symbols += copy_encoder->encode(copy_encoder, channel, &led_encoder->reset_code,
+                                                sizeof(led_encoder->reset_code), &session_state);
+        if (session_state & RMT_ENCODING_COMPLETE) {
+            led_encoder->state = RMT_ENCODING_RESET; // back to the initial encoding session
+            state |= RMT_ENCODING_COMPLETE;
+        }
+        if (session_state & RMT_ENCODING_MEM_FULL) {
+            state |= RMT_ENCODING_MEM_FULL;
+            goto out; // yield if there's no free space for encoding artifacts
+        }
+    }
+out:
+    *ret_state = state;
+    return encoded_symbols;
+}
+
+static esp_err_t rmt_del_led_strip_encoder(rmt_encoder_t *encoder)
+{
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    rmt_del_encoder(led_encoder->bytes_encoder);
+    rmt_del_encoder(led_encoder->copy_encoder);
+    free(led_encoder);
+    return ESP_OK;
+}
+
+static esp_err_t rmt_led_strip_encoder_reset(rmt_encoder_t *encoder)
+{
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    rmt_encoder_reset(led_encoder->bytes_encoder);
+    rmt_encoder_reset(led_encoder->copy_encoder);
+    led_encoder->state = RMT_ENCODING_RESET;
+    return ESP_OK;
+}
+
+static esp_err_t rmt_new_led_strip_encoder(uint32_t resolution, rmt_encoder_handle_t *ret_encoder)
+{
+    esp_err_t ret = ESP_OK;
+    rmt_led_strip_encoder_t *led_encoder = NULL;
+    led_encoder = rmt_alloc_encoder_mem(sizeof(rmt_led_strip_encoder_t));
+    ESP_GOTO_ON_FALSE(led_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for led strip encoder");
+    led_encoder->base.encode = rmt_encode_led_strip;
+    led_encoder->base.del = rmt_del_led_strip_encoder;
+    led_encoder->base.reset = rmt_led_strip_encoder_reset;
+    // different led strip might have its own timing requirements, following parameter is for WS2812
+    rmt_bytes_encoder_config_t bytes_encoder_config = {
+        .bit0 = {
+            .level0 = 1,
+            .duration0 = 0.3 * resolution / 1000000, // T0H=0.3us
+            .level1 = 0,
+            .duration1 = 0.9 * resolution / 1000000, // T0L=0.9us
+        },
+        .bit1 = {
+            .level0 = 1,
+            .duration0 = 0.9 * resolution / 1000000, // T1H=0.9us
+            .level1 = 0,
+            .duration1 = 0.3 * resolution / 1000000, // T1L=0.3us
+        },
+        .flags.msb_first = 1 // WS2812 transfer bit order: G7...G0R7...R0B7...B0
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_bytes_encoder(&bytes_encoder_config, &led_encoder->bytes_encoder), err, TAG, "create bytes encoder failed");
+    rmt_copy_encoder_config_t copy_encoder_config = {};
+    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &led_encoder->copy_encoder), err, TAG, "create copy encoder failed");
+
+    uint32_t reset_ticks = resolution / 1000000 * 50 / 2; // reset code duration defaults to 50us
+    led_encoder->reset_code = (rmt_symbol_word_t) {
+        .level0 = 0,
+        .duration0 = reset_ticks,
+        .level1 = 0,
+        .duration1 = reset_ticks,
+    };
+    *ret_encoder = &led_encoder->base;
+    return ESP_OK;
+err:
+    if (led_encoder) {
+        if (led_encoder->bytes_encoder) {
+            rmt_del_encoder(led_encoder->bytes_encoder);
+        }
+        if (led_encoder->copy_encoder) {
+            rmt_del_encoder(led_encoder->copy_encoder);
+        }
+        free(led_encoder);
+    }
+    return ret;
+}
+
+static esp_err_t esp_pwm_init(void *ctx, const int *gpio, int channel_num, uint32_t freq_hz, uint32_t duty_bits)
+{
+    act_esp_t *esp = ctx;
+    ESP_RETURN_ON_FALSE(channel_num > 0 && channel_num <= LEDC_CHANNEL_MAX, ESP_ERR_INVALID_ARG, TAG, "%d PWM channels", channel_num);
+    ledc_timer_config_t timer_cfg = {
+        .speed_mode = LEDC_LOW_SPEED_MODE,
+        .duty_resolution = duty_bits,
+        .timer_num = ACT_PWM_TIMER,
+        .freq_hz = freq_hz,
+        .clk_cfg = LEDC_AUTO_CLK,
+    };
+    ESP_RETURN_ON_ERROR(ledc_timer_config(&timer_cfg), TAG, "PWM timer failed");
+    for (int ch = 0; ch < channel_num; ch++) {
+        ledc_channel_config_t channel_cfg = {
+            .gpio_num = gpio[ch],
+            .speed_mode = LEDC_LOW_SPEED_MODE,
+            .channel = ch,
+            .intr_type = LEDC_INTR_DISABLE,
+            .timer_sel = ACT_PWM_TIMER,
+            .duty = 0,
+            .hpoint = 0,
+        };
+        ESP_RETURN_ON_ERROR(ledc_channel_config(&channel_cfg), TAG, "PWM on GPIO %d failed", gpio[ch]);
+    }
+    esp->pwm_num = channel_num;
+    return ESP_OK;
+}
+
+static esp_err_t esp_pwm_write(void *ctx, uint32_t mask, const uint32_t *duty)
+{
+    act_esp_t *esp = ctx;
+    if (mask >> esp->pwm_num) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // all channels run off one timer and take a new duty at its next period, so the
+    // duties are all set before any is latched to start them in the same period
+    for (int ch = 0; ch < esp->pwm_num; ch++) {
+        if (mask & (1 << ch)) {
+            ledc_set_duty(LEDC_LOW_SPEED_MODE, ch, duty[ch]);
+        }
+    }
+    for (int ch = 0; ch < esp->pwm_num; ch++) {
+        if (mask & (1 << ch)) {
+            ledc_update_duty(LEDC_LOW_SPEED_MODE, ch);
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t esp_pwm_enable(void *ctx, bool on)
+{
+    if (!on) {
+        return ledc_timer_pause(LEDC_LOW_SPEED_MODE, ACT_PWM_TIMER);
+    }
+    // the first period starts now, so callers know when a duty written later is latched
+    ledc_timer_rst(LEDC_LOW_SPEED_MODE, ACT_PWM_TIMER);
+    return ledc_timer_resume(LEDC_LOW_SPEED_MODE, ACT_PWM_TIMER);
+}
+
+static bool esp_strip_done(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *edata, void *user_ctx)
+{
+    act_esp_strip_t *strip = user_ctx;
+    strip->cfg.done(strip->cfg.done_ctx);
+    return false;
+}
+
+static esp_err_t esp_strip_create(act_esp_strip_t *strip, const act_strip_cfg_t *cfg, size_t mem_symbols, bool dma)
+{
+    size_t symbol_num = cfg->encode ? cfg->symbol_num : cfg->pixel_num * 3u * 8 + 1;
+    rmt_tx_channel_config_t chan_config = {
+        .clk_src = RMT_CLK_SRC_DEFAULT, // select source clock
+        .gpio_num = cfg->gpio_num,
+        .mem_block_symbols = mem_symbols, // increase the block size can make the LED less flickering
+        .resolution_hz = ACT_STRIP_RESOLUTION_HZ,
+        .trans_queue_depth = 4, // set the number of transactions that can be pending in the background
+    };
+    esp_err_t ret = ESP_ERR_NOT_SUPPORTED;
+    if (dma) {
+        // the DMA buffer takes the whole frame when it fits, otherwise it refills once per descriptor
+        chan_config.flags.with_dma = true;
+        chan_config.mem_block_symbols = symbol_num < ACT_DMA_MAX_SYMBOLS ? (symbol_num + 1) & ~1 : ACT_DMA_MAX_SYMBOLS;
+        ret = rmt_new_tx_channel(&chan_config, &strip->chan);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "no RMT DMA for GPIO %d (%s), using channel memory", cfg->gpio_num, esp_err_to_name(ret));
+        }
+    }
+    if (ret != ESP_OK) {
+        chan_config.flags.with_dma = false;
+        chan_config.mem_block_symbols = mem_symbols;
+        ESP_RETURN_ON_ERROR(rmt_new_tx_channel(&chan_config, &strip->chan), TAG, "create channel on GPIO %d failed", cfg->gpio_num);
+    }
+    strip->cfg = *cfg;
+    strip->dma = chan_config.flags.with_dma;
+    ESP_LOGI(TAG, "%d pixels on GPIO %d, %d symbol %s buffer", cfg->pixel_num, cfg->gpio_num,
+             (int)chan_config.mem_block_symbols, strip->dma ? "DMA" : "RMT");
+
+    strip->symbols = cfg->encode ? malloc(symbol_num * sizeof(uint32_t)) : NULL;
+    if (strip->symbols) {
+        rmt_copy_encoder_config_t copy_config = {};
+        ESP_RETURN_ON_ERROR(rmt_new_copy_encoder(&copy_config, &strip->encoder), TAG, "create copy encoder failed");
+    } else {
+        if (cfg->encode) {
+            ESP_LOGW(TAG, "no memory to pre-encode %d pixels, encoding in the ISR", cfg->pixel_num);
+        }
+        ESP_RETURN_ON_ERROR(rmt_new_led_strip_encoder(ACT_STRIP_RESOLUTION_HZ, &strip->encoder), TAG, "create encoder failed");
+    }
+    if (cfg->done) {
+        rmt_tx_event_callbacks_t cbs = {
+            .on_trans_done = esp_strip_done,
+        };
+        ESP_RETURN_ON_ERROR(rmt_tx_register_event_callbacks(strip->chan, &cbs, strip), TAG, "register callback failed");
+    }
+    return rmt_enable(strip->chan);
+}
+
+static esp_err_t esp_strip_init(void *ctx, const act_strip_cfg_t *cfg, int strip_num, bool dma)
+{
+    act_esp_t *esp = ctx;
+    ESP_RETURN_ON_FALSE(strip_num > 0 && strip_num <= ACT_STRIP_MAX, ESP_ERR_INVALID_ARG, TAG, "%d strips", strip_num);
+    // a single strip keeps the large block, several share the TX channel memory
+    size_t mem_symbols = strip_num == 1 ? 256 : SOC_RMT_MEM_WORDS_PER_CHANNEL * (SOC_RMT_TX_CANDIDATES_PER_GROUP / strip_num);
+    // the S3 has one DMA capable TX channel, the longest strip claims it before the others are created
+    int dma_strip = -1;
+    if (dma) {
+        dma_strip = 0;
+        for (int i = 1; i < strip_num; i++) {
+            if (cfg[i].pixel_num > cfg[dma_strip].pixel_num) {
+                dma_strip = i;
+            }
+        }
+        ESP_RETURN_ON_ERROR(esp_strip_create(&esp->strips[dma_strip], &cfg[dma_strip], mem_symbols, true), TAG, "strip %d", dma_strip);
+    }
+    for (int i = 0; i < strip_num; i++) {
+        if (i != dma_strip) {
+            ESP_RETURN_ON_ERROR(esp_strip_create(&esp->strips[i], &cfg[i], mem_symbols, false), TAG, "strip %d", i);
+        }
+    }
+    esp->strip_num = strip_num;
+    return ESP_OK;
+}
+
+static esp_err_t esp_strip_send(void *ctx, int strip_id, const uint8_t *grb, size_t bytes)
+{
+    act_esp_t *esp = ctx;
+    if (strip_id < 0 || strip_id >= esp->strip_num) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    act_esp_strip_t *strip = &esp->strips[strip_id];
+    // queued behind nothing, the engines keep one transaction in flight
+    if (strip->symbols == NULL) {
+        return rmt_transmit(strip->chan, strip->encoder, grb, bytes, &tx_config);
+    }
+    // the whole frame is encoded in one pass here, the ISR only copies symbols
+    size_t symbol_num = strip->cfg.encode(strip->cfg.encode_ctx, grb, bytes, strip->symbols);
+    return rmt_transmit(strip->chan, strip->encoder, strip->symbols, symbol_num * sizeof(uint32_t), &tx_config);
+}
+
+static esp_err_t esp_dout_init(void *ctx, int gpio)
+{
+    //clear GPIO state in case of reboot or other operation
+    gpio_reset_pin(gpio);
+    return gpio_set_direction(gpio, GPIO_MODE_OUTPUT);
+}
+
+static esp_err_t esp_dout_write(void *ctx, int gpio, int level)
+{
+    return gpio_set_level(gpio, level);
+}
+
+static int64_t esp_now_us(void *ctx)
+{
+    return esp_timer_get_time();
+}
+
+static const act_hal_ops_t esp_ops = {
+    .pwm_init = esp_pwm_init,
+    .pwm_write = esp_pwm_write,
+    .pwm_enable = esp_pwm_enable,
+    .strip_init = esp_strip_init,
+    .strip_send = esp_strip_send,
+    .dout_init = esp_dout_init,
+    .dout_write = esp_dout_write,
+    .now_us = esp_now_us,
+};
+
+static act_hal_t esp_hal = {
+    .ops = &esp_ops,
+    .ctx = &esp_ctx,
+};
+
+act_hal_t *act_hal_default(void)
+{
+    return &esp_hal;
+}
@@ -0,0 +1,122 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <pthread.h>
+#include <time.h>
+#include "act_sim.h"
+
+// host stand-in for the linux target, the outputs go to a simulation that follows the
+// monotonic clock instead of a virtual one
+
+#define ACT_LINUX_EVENTS    (4096)
+
+static act_sim_t linux_sim;
+static pthread_mutex_t linux_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int64_t linux_clock_us(void)
+{
+    static int64_t origin_us = -1;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    int64_t now_us = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    if (origin_us < 0) {
+        origin_us = now_us;
+    }
+    return now_us - origin_us;
+}
+
+// call with linux_lock held, the simulation may run ahead after a frame was sent
+static void linux_sync(void)
+{
+    int64_t us = linux_clock_us() - linux_sim.now_us;
+    act_sim_advance(&linux_sim, us > 0 ? us : 0);
+}
+
+#define LINUX_FORWARD(call) do {                        \
+    pthread_mutex_lock(&linux_lock);                    \
+    linux_sync();                                       \
+    esp_err_t ret = linux_sim.hal.ops->call;            \
+    pthread_mutex_unlock(&linux_lock);                  \
+    return ret;                                         \
+} while (0)
+
+static esp_err_t linux_pwm_init(void *ctx, const int *gpio, int channel_num, uint32_t freq_hz, uint32_t duty_bits)
+{
+    LINUX_FORWARD(pwm_init(&linux_sim, gpio, channel_num, freq_hz, duty_bits));
+}
+
+static esp_err_t linux_pwm_write(void *ctx, uint32_t mask, const uint32_t *duty)
+{
+    LINUX_FORWARD(pwm_write(&linux_sim, mask, duty));
+}
+
+static esp_err_t linux_pwm_enable(void *ctx, bool on)
+{
+    LINUX_FORWARD(pwm_enable(&linux_sim, on));
+}
+
+static esp_err_t linux_strip_init(void *ctx, const act_strip_cfg_t *cfg, int strip_num, bool dma)
+{
+    LINUX_FORWARD(strip_init(&linux_sim, cfg, strip_num, dma));
+}
+
+static esp_err_t linux_strip_send(void *ctx, int strip, const uint8_t *grb, size_t bytes)
+{
+    pthread_mutex_lock(&linux_lock);
+    linux_sync();
+    esp_err_t ret = linux_sim.hal.ops->strip_send(&linux_sim, strip, grb, bytes);
+    // nothing else moves the clock while a render task waits for the frame, so it is reported
+    // done right away, stamped with the time it would be out
+    if (ret == ESP_OK) {
+        act_sim_advance(&linux_sim, act_sim_strip_time_us(bytes));
+    }
+    pthread_mutex_unlock(&linux_lock);
+    return ret;
+}
+
+static esp_err_t linux_dout_init(void *ctx, int gpio)
+{
+    LINUX_FORWARD(dout_init(&linux_sim, gpio));
+}
+
+static esp_err_t linux_dout_write(void *ctx, int gpio, int level)
+{
+    LINUX_FORWARD(dout_write(&linux_sim, gpio, level));
+}
+
+static int64_t linux_now_us(void *ctx)
+{
+    return linux_clock_us();
+}
+
+static const act_hal_ops_t linux_ops = {
+    .pwm_init = linux_pwm_init,
+    .pwm_write = linux_pwm_write,
+    .pwm_enable = linux_pwm_enable,
+    .strip_init = linux_strip_init,
+    .strip_send = linux_strip_send,
+    .dout_init = linux_dout_init,
+    .dout_write = linux_dout_write,
+    .now_us = linux_now_us,
+};
+
+static act_hal_t linux_hal = {
+    .ops = &linux_ops,
+    .ctx = &linux_sim,
+};
+
+act_hal_t *act_hal_default(void)
+{
+    pthread_mutex_lock(&linux_lock);
+    if (linux_sim.events == NULL) {
+        act_sim_init(&linux_sim, ACT_LINUX_EVENTS);
+    }
+    pthread_mutex_unlock(&linux_lock);
+    return &linux_hal;
+}
+
+act_sim_t *act_sim_default(void)
+{
+    act_hal_default();
+    return &linux_sim;
+}
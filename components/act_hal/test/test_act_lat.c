@@ -0,0 +1,47 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "act_lat.h"
+
+TEST_CASE("act_lat buckets by powers of two", "[act_hal]")
+{
+    act_lat_t lat;
+    memset(&lat, 0, sizeof(lat));
+    TEST_ASSERT_EQUAL(0, act_lat_percentile(&lat, 50));
+
+    act_lat_add(&lat, -5);
+    act_lat_add(&lat, 0);
+    act_lat_add(&lat, 1);
+    act_lat_add(&lat, 1023);
+    act_lat_add(&lat, 1024);
+    act_lat_add(&lat, 10000000);
+    TEST_ASSERT_EQUAL(6, lat.count);
+    TEST_ASSERT_EQUAL(2, lat.bucket[0]);
+    TEST_ASSERT_EQUAL(1, lat.bucket[1]);
+    TEST_ASSERT_EQUAL(1, lat.bucket[10]);
+    TEST_ASSERT_EQUAL(1, lat.bucket[11]);
+    TEST_ASSERT_EQUAL(1, lat.bucket[ACT_LAT_BUCKETS - 1]);
+    TEST_ASSERT_EQUAL(10000000, lat.max_us);
+    TEST_ASSERT_EQUAL(10000000 + 1 + 1023 + 1024, lat.sum_us);
+    act_lat_print(&lat, "act_lat");
+}
+
+TEST_CASE("act_lat percentiles tell a period wait from a quick dispatch", "[act_hal]")
+{
+    act_lat_t slow, fast;
+    memset(&slow, 0, sizeof(slow));
+    memset(&fast, 0, sizeof(fast));
+    for (int i = 0; i < 100; i++) {
+        act_lat_add(&slow, 20000 + i * 37);
+        act_lat_add(&fast, 40 + i);
+    }
+    act_lat_add(&fast, 9000);
+    // 16 ms and up share the top bucket, which reports the largest sample
+    TEST_ASSERT_EQUAL(20000 + 99 * 37, act_lat_percentile(&slow, 50));
+    TEST_ASSERT_EQUAL(127, act_lat_percentile(&fast, 50));
+    TEST_ASSERT_EQUAL(255, act_lat_percentile(&fast, 99));
+    TEST_ASSERT_EQUAL(16383, act_lat_percentile(&fast, 100));
+}
@@ -0,0 +1,139 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "act_sim.h"
+
+typedef struct {
+    act_sim_t *sim;
+    int        strip;
+    int        done;
+    int        resend;      // frames to send again from the done callback
+    uint8_t    grb[30];
+} strip_ctx_t;
+
+static void strip_done(void *ctx)
+{
+    strip_ctx_t *s = ctx;
+    s->done++;
+    if (s->resend > 0) {
+        s->resend--;
+        TEST_ASSERT_EQUAL(ESP_OK, act_strip_send(&s->sim->hal, s->strip, s->grb, sizeof(s->grb)));
+    }
+}
+
+static size_t strip_encode(void *ctx, const uint8_t *grb, size_t bytes, uint32_t *symbols)
+{
+    for (size_t i = 0; i < bytes; i++) {
+        symbols[i] = grb[i];
+    }
+    return bytes;
+}
+
+TEST_CASE("act_sim PWM batches are logged per channel with the clock", "[act_hal]")
+{
+    act_sim_t sim;
+    TEST_ASSERT_EQUAL(ESP_OK, act_sim_init(&sim, 16));
+    static const int gpio[] = { 4, 5 };
+    TEST_ASSERT_EQUAL(ESP_OK, act_pwm_init(&sim.hal, gpio, 2, 50, 14));
+
+    act_sim_advance(&sim, 20000);
+    const uint32_t duty[] = { 410, 2048 };
+    TEST_ASSERT_EQUAL(ESP_OK, act_pwm_write(&sim.hal, 0x3, duty));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, act_pwm_write(&sim.hal, 0x4, duty));
+    TEST_ASSERT_EQUAL(2, sim.event_num);
+    for (int ch = 0; ch < 2; ch++) {
+        TEST_ASSERT_EQUAL(ACT_EVENT_PWM, sim.events[ch].kind);
+        TEST_ASSERT_EQUAL(ch, sim.events[ch].id);
+        TEST_ASSERT_EQUAL(duty[ch], sim.events[ch].value);
+        TEST_ASSERT_EQUAL(20000, sim.events[ch].t_us);
+        TEST_ASSERT_EQUAL(duty[ch], sim.duty[ch]);
+    }
+
+    // only a change of state is an event
+    act_pwm_enable(&sim.hal, true);
+    act_pwm_enable(&sim.hal, false);
+    act_pwm_enable(&sim.hal, false);
+    TEST_ASSERT_EQUAL(3, sim.event_num);
+    TEST_ASSERT_EQUAL(ACT_EVENT_PWM_ENABLE, sim.events[2].kind);
+    TEST_ASSERT_EQUAL(0, sim.events[2].value);
+    TEST_ASSERT_FALSE(sim.pwm_on);
+    act_sim_deinit(&sim);
+}
+
+TEST_CASE("act_sim strips report done at wire speed in time order", "[act_hal]")
+{
+    act_sim_t sim;
+    TEST_ASSERT_EQUAL(ESP_OK, act_sim_init(&sim, 32));
+    strip_ctx_t ctx[2] = { { .sim = &sim, .strip = 0 }, { .sim = &sim, .strip = 1, .resend = 1 } };
+    const act_strip_cfg_t cfg[2] = {
+        { .gpio_num = 8, .pixel_num = 100, .done = strip_done, .done_ctx = &ctx[0] },
+        { .gpio_num = 9, .pixel_num = 10, .encode = strip_encode, .symbol_num = 30, .done = strip_done, .done_ctx = &ctx[1] },
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, act_strip_init(&sim.hal, cfg, 2, true));
+
+    uint8_t frame[300];
+    memset(frame, 0x11, sizeof(frame));
+    memset(ctx[1].grb, 0x22, sizeof(ctx[1].grb));
+    TEST_ASSERT_EQUAL(ESP_OK, act_strip_send(&sim.hal, 0, frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL(ESP_OK, act_strip_send(&sim.hal, 1, ctx[1].grb, sizeof(ctx[1].grb)));
+    // one frame in flight per strip
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, act_strip_send(&sim.hal, 0, frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, act_strip_send(&sim.hal, 1, frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL_HEX32(0x22, sim.strips[1].symbols[29]);
+
+    int64_t t0 = act_sim_strip_time_us(sizeof(frame));
+    int64_t t1 = act_sim_strip_time_us(sizeof(ctx[1].grb));
+    TEST_ASSERT_EQUAL(338, t1);
+    act_sim_advance(&sim, 10000);
+    TEST_ASSERT_EQUAL(10000, sim.now_us);
+    TEST_ASSERT_EQUAL(1, ctx[0].done);
+    TEST_ASSERT_EQUAL(2, ctx[1].done);
+
+    // strip 1 finishes, sends again from its callback, finishes again, then strip 0
+    const struct { uint8_t kind, id; int64_t t_us; } want[] = {
+        { ACT_EVENT_STRIP, 0, 0 },
+        { ACT_EVENT_STRIP, 1, 0 },
+        { ACT_EVENT_STRIP_DONE, 1, t1 },
+        { ACT_EVENT_STRIP, 1, t1 },
+        { ACT_EVENT_STRIP_DONE, 1, 2 * t1 },
+        { ACT_EVENT_STRIP_DONE, 0, t0 },
+    };
+    TEST_ASSERT_EQUAL(sizeof(want) / sizeof(want[0]), sim.event_num);
+    for (size_t i = 0; i < sim.event_num; i++) {
+        TEST_ASSERT_EQUAL(want[i].kind, sim.events[i].kind);
+        TEST_ASSERT_EQUAL(want[i].id, sim.events[i].id);
+        TEST_ASSERT_EQUAL(want[i].t_us, sim.events[i].t_us);
+    }
+    TEST_ASSERT_EQUAL(sim.events[1].value, sim.events[3].value);
+    TEST_ASSERT_NOT_EQUAL(sim.events[0].value, sim.events[1].value);
+    TEST_ASSERT_EQUAL_MEMORY(frame, sim.strips[0].frame, sizeof(frame));
+    act_sim_deinit(&sim);
+}
+
+TEST_CASE("act_sim digital outputs and a full log", "[act_hal]")
+{
+    act_sim_t sim;
+    TEST_ASSERT_EQUAL(ESP_OK, act_sim_init(&sim, 2));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, act_dout_write(&sim.hal, 38, 1));
+    TEST_ASSERT_EQUAL(-1, act_sim_dout_level(&sim, 38));
+    TEST_ASSERT_EQUAL(ESP_OK, act_dout_init(&sim.hal, 38));
+    TEST_ASSERT_EQUAL(0, act_sim_dout_level(&sim, 38));
+
+    for (int i = 0; i < 4; i++) {
+        act_sim_advance(&sim, 1000);
+        TEST_ASSERT_EQUAL(ESP_OK, act_dout_write(&sim.hal, 38, i & 1));
+    }
+    TEST_ASSERT_EQUAL(1, act_sim_dout_level(&sim, 38));
+    TEST_ASSERT_EQUAL(4000, act_now_us(&sim.hal));
+    // the log keeps the first events and counts the rest
+    TEST_ASSERT_EQUAL(2, sim.event_num);
+    TEST_ASSERT_EQUAL(2, sim.dropped);
+    TEST_ASSERT_EQUAL(2000, sim.events[1].t_us);
+    act_sim_clear(&sim);
+    TEST_ASSERT_EQUAL(0, sim.event_num);
+    TEST_ASSERT_EQUAL(1, act_sim_dout_level(&sim, 38));
+    act_sim_deinit(&sim);
+}
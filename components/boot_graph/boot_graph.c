@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "boot_graph.h"
+
+static const char *TAG = "MK39 Boot";
+
+#define BOOT_STEP_DEFAULT_STACK (4 * 1024)
+
+typedef struct {
+    boot_graph_t *graph;
+    int           index;
+} boot_task_arg_t;
+
+struct boot_graph {
+    const boot_step_t  *steps;
+    int                 num;
+    EventGroupHandle_t  done;
+    int64_t             start_us;
+    boot_task_arg_t     args[BOOT_GRAPH_MAX_STEPS];
+    boot_step_record_t  records[BOOT_GRAPH_MAX_STEPS];
+};
+
+static void boot_step_task(void *arg)
+{
+    boot_task_arg_t *task_arg = (boot_task_arg_t *)arg;
+    boot_graph_t *graph = task_arg->graph;
+    const boot_step_t *step = &graph->steps[task_arg->index];
+    boot_step_record_t *rec = &graph->records[task_arg->index];
+
+    if (step->deps) {
+        xEventGroupWaitBits(graph->done, step->deps, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    rec->ready_us = esp_timer_get_time();
+    rec->ret = ESP_OK;
+    for (int i = 0; i < graph->num; i++) {
+        if ((step->deps & BOOT_STEP_BIT(i)) && graph->records[i].ret != ESP_OK) {
+            ESP_LOGE(TAG, "%s skipped, %s failed", step->name, graph->steps[i].name);
+            rec->ret = ESP_ERR_INVALID_STATE;
+            break;
+        }
+    }
+    rec->start_us = esp_timer_get_time();
+    rec->core = xPortGetCoreID();
+    if (rec->ret == ESP_OK) {
+        rec->ret = step->fn(step->arg);
+        if (rec->ret != ESP_OK) {
+            ESP_LOGE(TAG, "%s failed: %s", step->name, esp_err_to_name(rec->ret));
+        }
+    }
+    rec->end_us = esp_timer_get_time();
+    // the event group orders the record writes before the dependents read them
+    xEventGroupSetBits(graph->done, BOOT_STEP_BIT(task_arg->index));
+    vTaskDelete(NULL);
+}
+
+boot_graph_t *boot_graph_start(const boot_step_t *steps, int num, UBaseType_t priority)
+{
+    if (steps == NULL || num <= 0 || num > BOOT_GRAPH_MAX_STEPS) {
+        return NULL;
+    }
+    // only backward edges, so the graph can not hold a cycle
+    for (int i = 0; i < num; i++) {
+        if (steps[i].fn == NULL || (steps[i].deps & ~(BOOT_STEP_BIT(i) - 1))) {
+            ESP_LOGE(TAG, "bad step %d", i);
+            return NULL;
+        }
+    }
+    boot_graph_t *graph = calloc(1, sizeof(boot_graph_t));
+    if (graph == NULL) {
+        return NULL;
+    }
+    graph->done = xEventGroupCreate();
+    if (graph->done == NULL) {
+        free(graph);
+        return NULL;
+    }
+    graph->steps = steps;
+    graph->num = num;
+    graph->start_us = esp_timer_get_time();
+    for (int i = 0; i < num; i++) {
+        graph->args[i].graph = graph;
+        graph->args[i].index = i;
+        uint32_t stack = steps[i].stack_size ? steps[i].stack_size : BOOT_STEP_DEFAULT_STACK;
+        if (xTaskCreatePinnedToCore(boot_step_task, steps[i].name, stack, &graph->args[i], priority, NULL,
+                                    steps[i].core) != pdPASS) {
+            // finish the step as failed so waiters and dependents do not hang
+            ESP_LOGE(TAG, "no memory for %s", steps[i].name);
+            graph->records[i].ret = ESP_ERR_NO_MEM;
+            xEventGroupSetBits(graph->done, BOOT_STEP_BIT(i));
+        }
+    }
+    return graph;
+}
+
+esp_err_t boot_graph_wait(boot_graph_t *graph, uint32_t mask, TickType_t timeout)
+{
+    if (graph == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    mask &= BOOT_STEP_BIT(graph->num) - 1;
+    if (mask == 0) {
+        return ESP_OK;
+    }
+    EventBits_t bits = xEventGroupWaitBits(graph->done, mask, pdFALSE, pdTRUE, timeout);
+    if ((bits & mask) != mask) {
+        return ESP_ERR_TIMEOUT;
+    }
+    for (int i = 0; i < graph->num; i++) {
+        if ((mask & BOOT_STEP_BIT(i)) && graph->records[i].ret != ESP_OK) {
+            return graph->records[i].ret;
+        }
+    }
+    return ESP_OK;
+}
+
+const boot_step_record_t *boot_graph_get_record(boot_graph_t *graph, int index)
+{
+    if (graph == NULL || index < 0 || index >= graph->num) {
+        return NULL;
+    }
+    if ((xEventGroupGetBits(graph->done) & BOOT_STEP_BIT(index)) == 0) {
+        return NULL;
+    }
+    return &graph->records[index];
+}
+
+void boot_graph_print(boot_graph_t *graph)
+{
+    if (graph == NULL) {
+        return;
+    }
+    EventBits_t bits = xEventGroupGetBits(graph->done);
+    int64_t last_us = graph->start_us;
+    int64_t busy_us = 0;
+    printf("boot timeline, ms since reset\n  %-16s %6s %6s %6s %6s core\n", "step", "ready", "start", "end", "time");
+    for (int i = 0; i < graph->num; i++) {
+        const boot_step_record_t *rec = &graph->records[i];
+        if ((bits & BOOT_STEP_BIT(i)) == 0) {
+            printf("  %-16s pending\n", graph->steps[i].name);
+            continue;
+        }
+        printf("  %-16s %6lld %6lld %6lld %6lld %4d%s\n", graph->steps[i].name, rec->ready_us / 1000,
+               rec->start_us / 1000, rec->end_us / 1000, (rec->end_us - rec->start_us) / 1000, rec->core,
+               rec->ret == ESP_OK ? "" : " failed");
+        busy_us += rec->end_us - rec->start_us;
+        if (rec->end_us > last_us) {
+            last_us = rec->end_us;
+        }
+    }
+    printf("  graph %lld ms, %lld ms of init work\n", (last_us - graph->start_us) / 1000, busy_us / 1000);
+}
+
+void boot_graph_destroy(boot_graph_t *graph)
+{
+    if (graph == NULL) {
+        return;
+    }
+    vEventGroupDelete(graph->done);
+    free(graph);
+}
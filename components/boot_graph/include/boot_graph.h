@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Most steps in one graph, one event group bit each
+ */
+#define BOOT_GRAPH_MAX_STEPS    24
+
+/**
+ * @brief Dependency mask bit of the step at `index` in the step table
+ */
+#define BOOT_STEP_BIT(index)    (1UL << (index))
+
+/**
+ * @brief Initializer run by a boot step, a failure skips every step depending on it
+ */
+typedef esp_err_t (*boot_step_fn_t)(void *arg);
+
+/**
+ * @brief One node of the boot dependency graph
+ */
+typedef struct {
+    const char     *name;       /*!< Shown in the boot timeline */
+    boot_step_fn_t  fn;         /*!< Initializer */
+    void           *arg;        /*!< Passed to `fn` */
+    uint32_t        deps;       /*!< `BOOT_STEP_BIT()` of the steps which must finish first, only earlier steps */
+    int             core;       /*!< Core to run on, `tskNO_AFFINITY` to let the scheduler pick */
+    uint32_t        stack_size; /*!< Task stack in bytes, 0 for the default 4 KB */
+} boot_step_t;
+
+/**
+ * @brief Timeline entry of a step, times in microseconds since reset
+ */
+typedef struct {
+    int64_t   ready_us;   /*!< All dependencies finished */
+    int64_t   start_us;   /*!< Initializer entered */
+    int64_t   end_us;     /*!< Initializer returned */
+    int       core;       /*!< Core the initializer ran on */
+    esp_err_t ret;        /*!< Result, `ESP_ERR_INVALID_STATE` when skipped for a failed dependency */
+} boot_step_record_t;
+
+typedef struct boot_graph boot_graph_t;
+
+/**
+ * @brief Start all steps, each runs in its own task once its dependencies are done
+ *
+ * Returns without waiting, so independent initializers overlap on both cores.
+ * `steps` must stay valid until `boot_graph_wait` has returned for all steps.
+ *
+ * @param steps Step table, dependencies refer to indexes in this table
+ * @param num Number of steps, at most `BOOT_GRAPH_MAX_STEPS`
+ * @param priority Priority of the step tasks
+ * @return Graph handle, NULL on invalid table or no memory
+ */
+boot_graph_t *boot_graph_start(const boot_step_t *steps, int num, UBaseType_t priority);
+
+/**
+ * @brief Wait until the steps in `mask` have finished
+ *
+ * @return ESP_OK when all of them succeeded, ESP_ERR_TIMEOUT, or the first failure in table order
+ */
+esp_err_t boot_graph_wait(boot_graph_t *graph, uint32_t mask, TickType_t timeout);
+
+/**
+ * @brief Timeline entry of a finished step, NULL if it is still pending
+ */
+const boot_step_record_t *boot_graph_get_record(boot_graph_t *graph, int index);
+
+/**
+ * @brief Print the boot timeline of the finished steps
+ */
+void boot_graph_print(boot_graph_t *graph);
+
+/**
+ * @brief Free the graph, all steps must have finished
+ */
+void boot_graph_destroy(boot_graph_t *graph);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "boot_prof.h"
+#include "boot_prof_port.h"
+
+static boot_prof_phase_t phases[BOOT_PROF_MAX_PHASES];
+static uint32_t start_internal[BOOT_PROF_MAX_PHASES];
+static uint32_t start_psram[BOOT_PROF_MAX_PHASES];
+static atomic_bool phase_done[BOOT_PROF_MAX_PHASES];
+static atomic_int phase_num;
+static uint32_t min_internal = UINT32_MAX;
+static uint32_t min_psram = UINT32_MAX;
+
+// lowest free memory seen at any phase edge, racing updates only lose a sample
+static void track_min(uint32_t internal_free, uint32_t psram_free)
+{
+    if (internal_free < min_internal) {
+        min_internal = internal_free;
+    }
+    if (psram_free < min_psram) {
+        min_psram = psram_free;
+    }
+}
+
+int boot_prof_begin(const char *name)
+{
+    int phase = atomic_fetch_add(&phase_num, 1);
+    if (phase >= BOOT_PROF_MAX_PHASES) {
+        return -1;
+    }
+    boot_prof_phase_t *p = &phases[phase];
+    p->end_us = -1;
+    p->name = name;
+    p->core = boot_prof_port_core();
+    boot_prof_port_heap(&start_internal[phase], &start_psram[phase]);
+    track_min(start_internal[phase], start_psram[phase]);
+    p->start_us = boot_prof_port_time_us();
+    return phase;
+}
+
+void boot_prof_end(int phase)
+{
+    if (phase < 0 || phase >= BOOT_PROF_MAX_PHASES) {
+        return;
+    }
+    boot_prof_phase_t *p = &phases[phase];
+    int64_t end_us = boot_prof_port_time_us();
+    boot_prof_port_heap(&p->internal_free, &p->psram_free);
+    track_min(p->internal_free, p->psram_free);
+    p->internal_delta = (int32_t)(p->internal_free - start_internal[phase]);
+    p->psram_delta = (int32_t)(p->psram_free - start_psram[phase]);
+    // published last, a reader which sees the flag sees the end time and heap numbers
+    p->end_us = end_us;
+    atomic_store(&phase_done[phase], true);
+}
+
+void boot_prof_mark(const char *name)
+{
+    boot_prof_end(boot_prof_begin(name));
+}
+
+const boot_prof_phase_t *boot_prof_get(int index)
+{
+    int num = atomic_load(&phase_num);
+    if (index < 0 || index >= num || index >= BOOT_PROF_MAX_PHASES) {
+        return NULL;
+    }
+    return &phases[index];
+}
+
+void boot_prof_report(FILE *out)
+{
+    int num = atomic_load(&phase_num);
+    if (num > BOOT_PROF_MAX_PHASES) {
+        num = BOOT_PROF_MAX_PHASES;
+    }
+    int64_t last_us = 0;
+    fprintf(out, "boot profile, %d phases, times in ms since reset, memory in KB\n", num);
+    fprintf(out, "%-16s %8s %8s %8s %5s %9s %10s %11s %12s\n", "phase", "start", "end", "time", "core",
+            "int_free", "int_delta", "psram_free", "psram_delta");
+    for (int i = 0; i < num; i++) {
+        const boot_prof_phase_t *p = &phases[i];
+        if (p->name == NULL) {
+            continue;
+        }
+        if (!atomic_load(&phase_done[i])) {
+            fprintf(out, "%-16s %8lld %8s\n", p->name, (long long)(p->start_us / 1000), "running");
+            continue;
+        }
+        fprintf(out, "%-16s %8lld %8lld %8lld %5d %9u %10d %11u %12d\n", p->name, (long long)(p->start_us / 1000),
+                (long long)(p->end_us / 1000), (long long)((p->end_us - p->start_us) / 1000), p->core,
+                (unsigned)(p->internal_free / 1024), (int)(p->internal_delta / 1024),
+                (unsigned)(p->psram_free / 1024), (int)(p->psram_delta / 1024));
+        if (p->end_us > last_us) {
+            last_us = p->end_us;
+        }
+    }
+    fprintf(out, "total %lld ms, min int_free %u KB, min psram_free %u KB\n", (long long)(last_us / 1000),
+            (unsigned)(min_internal == UINT32_MAX ? 0 : min_internal / 1024),
+            (unsigned)(min_psram == UINT32_MAX ? 0 : min_psram / 1024));
+}
+
+int boot_prof_save(const char *path)
+{
+    FILE *out = fopen(path, "w");
+    if (out == NULL) {
+        return -1;
+    }
+    boot_prof_report(out);
+    return fclose(out) == 0 ? 0 : -1;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Most phases recorded in one boot, later ones are dropped
+ */
+#define BOOT_PROF_MAX_PHASES    24
+
+/**
+ * @brief Startup phase record, times in microseconds since reset
+ *
+ * Heap numbers are free bytes when the phase ended. With phases running in
+ * parallel the deltas include the work of the other phases as well.
+ */
+typedef struct {
+    const char *name;
+    int64_t     start_us;
+    int64_t     end_us;          /*!< -1 while the phase is still running, heap fields are valid once it is set */
+    int         core;            /*!< Core the phase started on */
+    uint32_t    internal_free;   /*!< Free internal RAM at the end */
+    int32_t     internal_delta;  /*!< Change of free internal RAM over the phase */
+    uint32_t    psram_free;      /*!< Free PSRAM at the end */
+    int32_t     psram_delta;     /*!< Change of free PSRAM over the phase */
+} boot_prof_phase_t;
+
+/**
+ * @brief Start a phase, safe to call from several tasks
+ *
+ * @param name Phase name, must stay valid, e.g. a string literal
+ * @return Handle for `boot_prof_end`, -1 when the table is full
+ */
+int boot_prof_begin(const char *name);
+
+/**
+ * @brief End a phase started by `boot_prof_begin`, a handle of -1 is ignored
+ */
+void boot_prof_end(int phase);
+
+/**
+ * @brief Record an instant, e.g. the first audio frame
+ */
+void boot_prof_mark(const char *name);
+
+/**
+ * @brief Get a recorded phase in the order they were started, NULL past the end
+ */
+const boot_prof_phase_t *boot_prof_get(int index);
+
+/**
+ * @brief Write the startup timeline
+ *
+ * The format is the same on target and in the host build, so reports can be
+ * diffed between builds for regression tracking:
+ *
+ *     boot profile, N phases, times in ms since reset, memory in KB
+ *     phase              start      end     time  core  int_free  int_delta  psram_free  psram_delta
+ *     <name>             <...>
+ *     total <ms> ms, min int_free <KB> KB, min psram_free <KB> KB
+ *
+ * @param out Stream to write to, e.g. stdout
+ */
+void boot_prof_report(FILE *out);
+
+/**
+ * @brief Write the startup timeline to a file, e.g. on a mounted SD card
+ *
+ * @return 0 on success, -1 when the file can not be written
+ */
+int boot_prof_save(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,20 @@
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "boot_prof_port.h"
+
+int64_t boot_prof_port_time_us(void)
+{
+    return esp_timer_get_time();
+}
+
+int boot_prof_port_core(void)
+{
+    return xPortGetCoreID();
+}
+
+void boot_prof_port_heap(uint32_t *internal_free, uint32_t *psram_free)
+{
+    *internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    *psram_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+}
@@ -0,0 +1,27 @@
+#include <time.h>
+#include "boot_prof_port.h"
+
+// host stand-in for the linux target, heap numbers are not tracked and read 0
+
+int64_t boot_prof_port_time_us(void)
+{
+    static int64_t origin_us = -1;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    int64_t now_us = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    if (origin_us < 0) {
+        origin_us = now_us;
+    }
+    return now_us - origin_us;
+}
+
+int boot_prof_port_core(void)
+{
+    return 0;
+}
+
+void boot_prof_port_heap(uint32_t *internal_free, uint32_t *psram_free)
+{
+    *internal_free = 0;
+    *psram_free = 0;
+}
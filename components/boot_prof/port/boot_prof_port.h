@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdint.h>
+
+// platform part of the profiler, one implementation per build target
+
+// microseconds since reset, or since process start on the host
+int64_t boot_prof_port_time_us(void);
+
+int boot_prof_port_core(void);
+
+// free bytes of internal RAM and PSRAM
+void boot_prof_port_heap(uint32_t *internal_free, uint32_t *psram_free);
@@ -0,0 +1,81 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "unity.h"
+#include "boot_prof.h"
+
+#define REPORT_HEADER "phase               start      end     time  core  int_free  int_delta  psram_free  psram_delta\n"
+
+static bool read_line(FILE *in, char *line, int size)
+{
+    return fgets(line, size, in) != NULL;
+}
+
+TEST_CASE("boot_prof report keeps its format", "[boot_prof]")
+{
+    int init = boot_prof_begin("init");
+    TEST_ASSERT_TRUE(init >= 0);
+    int models = boot_prof_begin("models");
+    TEST_ASSERT_EQUAL(-1, boot_prof_get(models)->end_us);
+    boot_prof_end(init);
+    boot_prof_mark("first_frame");
+    TEST_ASSERT_TRUE(boot_prof_get(init)->end_us >= boot_prof_get(init)->start_us);
+    TEST_ASSERT_EQUAL(-1, boot_prof_get(models)->end_us);
+
+    FILE *out = tmpfile();
+    TEST_ASSERT_NOT_NULL(out);
+    boot_prof_report(out);
+    rewind(out);
+
+    // phases recorded before the test are reported as well, the header tells how many
+    char line[160];
+    int num = 0;
+    TEST_ASSERT_TRUE(read_line(out, line, sizeof(line)));
+    TEST_ASSERT_EQUAL(1, sscanf(line, "boot profile, %d phases, times in ms since reset, memory in KB", &num));
+    TEST_ASSERT_TRUE(num >= 3);
+    TEST_ASSERT_NOT_NULL(boot_prof_get(num - 1));
+    TEST_ASSERT_NULL(boot_prof_get(num));
+    TEST_ASSERT_TRUE(read_line(out, line, sizeof(line)));
+    TEST_ASSERT_EQUAL_STRING(REPORT_HEADER, line);
+
+    // one row per phase in start order, a finished one has every column
+    int running = 0;
+    for (int i = 0; i < num; i++) {
+        const boot_prof_phase_t *p = boot_prof_get(i);
+        char name[32];
+        char state[16];
+        long long start, end, time;
+        int core, int_delta, psram_delta;
+        unsigned int_free, psram_free;
+        TEST_ASSERT_TRUE(read_line(out, line, sizeof(line)));
+        if (p->end_us < 0) {
+            TEST_ASSERT_EQUAL(3, sscanf(line, "%31s %lld %15s", name, &start, state));
+            TEST_ASSERT_EQUAL_STRING("running", state);
+            running++;
+        } else {
+            TEST_ASSERT_EQUAL(9, sscanf(line, "%31s %lld %lld %lld %d %u %d %u %d", name, &start, &end, &time,
+                                        &core, &int_free, &int_delta, &psram_free, &psram_delta));
+            TEST_ASSERT_EQUAL(p->end_us / 1000, end);
+            TEST_ASSERT_EQUAL((p->end_us - p->start_us) / 1000, time);
+            TEST_ASSERT_EQUAL(p->core, core);
+            TEST_ASSERT_EQUAL(p->internal_free / 1024, int_free);
+            TEST_ASSERT_EQUAL(p->psram_free / 1024, psram_free);
+        }
+        TEST_ASSERT_EQUAL_STRING(p->name, name);
+        TEST_ASSERT_EQUAL(p->start_us / 1000, start);
+    }
+    TEST_ASSERT_TRUE(running >= 1);
+    long long total;
+    unsigned min_int, min_psram;
+    TEST_ASSERT_TRUE(read_line(out, line, sizeof(line)));
+    TEST_ASSERT_EQUAL(3, sscanf(line, "total %lld ms, min int_free %u KB, min psram_free %u KB", &total, &min_int,
+                                &min_psram));
+    // the mark ended last
+    TEST_ASSERT_EQUAL(boot_prof_get(num - 1)->end_us / 1000, total);
+    TEST_ASSERT_FALSE(read_line(out, line, sizeof(line)));
+    fclose(out);
+    boot_prof_end(models);
+}
@@ -0,0 +1,341 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "audio_codec_ctrl_cache.h"
+#include "device/es7210/es7210_reg.h"
+#include "device/es8311/es8311_reg.h"
+#include "esp_log.h"
+
+#define TAG "Ctrl_Cache"
+
+#define CACHE_REG_MAX   (256)
+#define BIT_WORDS       (CACHE_REG_MAX / 32)
+#define CACHE_BATCH_MAX (32)
+#define BIT_GET(m, i)   (((m)[(i) >> 5] >> ((i) & 31)) & 1)
+#define BIT_SET(m, i)   ((m)[(i) >> 5] |= (1u << ((i) & 31)))
+#define BIT_CLR(m, i)   ((m)[(i) >> 5] &= ~(1u << ((i) & 31)))
+
+typedef struct {
+    audio_codec_ctrl_if_t        base;
+    const audio_codec_ctrl_if_t *ctrl_if;
+    uint16_t                     reg_num;
+    int16_t                      reset_reg;
+    uint8_t                      reset_mask;
+    bool                         write_back;
+    bool                         is_open;
+    uint32_t                     valid[BIT_WORDS];
+    uint32_t                     dirty[BIT_WORDS];
+    uint32_t                     volatile_mask[BIT_WORDS];
+    uint8_t                      value[CACHE_REG_MAX];
+    audio_codec_cache_stats_t    stats;
+} cache_ctrl_t;
+
+static bool cacheable(cache_ctrl_t *cache, int reg, int reg_len, int data_len)
+{
+    return reg_len == 1 && data_len == 1 && reg >= 0 && reg < cache->reg_num
+           && BIT_GET(cache->volatile_mask, reg) == 0;
+}
+
+static bool is_reset(cache_ctrl_t *cache, int reg, int reg_len, const void *data)
+{
+    if (reg_len != 1 || reg != cache->reset_reg) {
+        return false;
+    }
+    return cache->reset_mask == 0 || (*(const uint8_t *) data & cache->reset_mask);
+}
+
+static int cache_send(cache_ctrl_t *cache, audio_codec_reg_val_t *batch, int num)
+{
+    if (num == 0) {
+        return ESP_CODEC_DEV_OK;
+    }
+    int ret = audio_codec_ctrl_write_regs(cache->ctrl_if, 1, batch, num);
+    cache->stats.bus_write += num;
+    if (ret != ESP_CODEC_DEV_OK) {
+        // Device state unknown, read it back next time
+        for (int i = 0; i < num; i++) {
+            BIT_CLR(cache->valid, batch[i].reg);
+        }
+    }
+    return ret;
+}
+
+static int cache_flush(cache_ctrl_t *cache)
+{
+    audio_codec_reg_val_t batch[CACHE_BATCH_MAX];
+    int n = 0;
+    int ret = ESP_CODEC_DEV_OK;
+    for (int i = 0; i < BIT_WORDS; i++) {
+        while (cache->dirty[i]) {
+            int reg = i * 32 + __builtin_ctz(cache->dirty[i]);
+            BIT_CLR(cache->dirty, reg);
+            batch[n].reg = reg;
+            batch[n].value = cache->value[reg];
+            if (++n == CACHE_BATCH_MAX) {
+                ret |= cache_send(cache, batch, n);
+                n = 0;
+            }
+        }
+    }
+    ret |= cache_send(cache, batch, n);
+    return ret;
+}
+
+static void cache_drop(cache_ctrl_t *cache, int reg, int len)
+{
+    for (int i = reg; i < reg + len && i < cache->reg_num; i++) {
+        if (i >= 0) {
+            BIT_CLR(cache->valid, i);
+        }
+    }
+}
+
+static int _cache_ctrl_open(const audio_codec_ctrl_if_t *ctrl, void *cfg, int cfg_size)
+{
+    if (ctrl == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    cache_ctrl_t *cache = (cache_ctrl_t *) ctrl;
+    cache->is_open = true;
+    return ESP_CODEC_DEV_OK;
+}
+
+static bool _cache_ctrl_is_open(const audio_codec_ctrl_if_t *ctrl)
+{
+    if (ctrl) {
+        cache_ctrl_t *cache = (cache_ctrl_t *) ctrl;
+        return cache->is_open && cache->ctrl_if->is_open(cache->ctrl_if);
+    }
+    return false;
+}
+
+static int _cache_ctrl_read_reg(const audio_codec_ctrl_if_t *ctrl, int reg, int reg_len, void *data, int data_len)
+{
+    if (ctrl == NULL || data == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    cache_ctrl_t *cache = (cache_ctrl_t *) ctrl;
+    if (cache->is_open == false) {
+        return ESP_CODEC_DEV_WRONG_STATE;
+    }
+    bool hit = cacheable(cache, reg, reg_len, data_len);
+    if (hit && BIT_GET(cache->valid, reg)) {
+        *(uint8_t *) data = cache->value[reg];
+        cache->stats.hit_read++;
+        return ESP_CODEC_DEV_OK;
+    }
+    if (hit == false) {
+        // Keep bus order when bypassing the cache
+        cache_flush(cache);
+    }
+    int ret = cache->ctrl_if->read_reg(cache->ctrl_if, reg, reg_len, data, data_len);
+    cache->stats.bus_read++;
+    if (hit && ret == ESP_CODEC_DEV_OK) {
+        cache->value[reg] = *(uint8_t *) data;
+        BIT_SET(cache->valid, reg);
+    }
+    return ret;
+}
+
+static int _cache_ctrl_write_reg(const audio_codec_ctrl_if_t *ctrl, int reg, int reg_len, void *data, int data_len)
+{
+    if (ctrl == NULL || data == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    cache_ctrl_t *cache = (cache_ctrl_t *) ctrl;
+    if (cache->is_open == false) {
+        return ESP_CODEC_DEV_WRONG_STATE;
+    }
+    if (is_reset(cache, reg, reg_len, data)) {
+        // Keep bus order, then forget everything the reset changes
+        int ret = cache_flush(cache);
+        memset(cache->valid, 0, sizeof(cache->valid));
+        cache->stats.bus_write++;
+        return ret | cache->ctrl_if->write_reg(cache->ctrl_if, reg, reg_len, data, data_len);
+    }
+    if (cacheable(cache, reg, reg_len, data_len) == false) {
+        cache_flush(cache);
+        if (reg_len == 1) {
+            cache_drop(cache, reg, data_len);
+        }
+        cache->stats.bus_write++;
+        return cache->ctrl_if->write_reg(cache->ctrl_if, reg, reg_len, data, data_len);
+    }
+    uint8_t v = *(uint8_t *) data;
+    if (BIT_GET(cache->valid, reg) && cache->value[reg] == v) {
+        cache->stats.skip_write++;
+        return ESP_CODEC_DEV_OK;
+    }
+    cache->value[reg] = v;
+    BIT_SET(cache->valid, reg);
+    if (cache->write_back) {
+        BIT_SET(cache->dirty, reg);
+        return ESP_CODEC_DEV_OK;
+    }
+    int ret = cache->ctrl_if->write_reg(cache->ctrl_if, reg, 1, &v, 1);
+    cache->stats.bus_write++;
+    if (ret != ESP_CODEC_DEV_OK) {
+        BIT_CLR(cache->valid, reg);
+    }
+    return ret;
+}
+
+static int _cache_ctrl_write_regs(const audio_codec_ctrl_if_t *ctrl, int reg_len, const audio_codec_reg_val_t *regs,
+                                  int num)
+{
+    if (ctrl == NULL || (regs == NULL && num)) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    cache_ctrl_t *cache = (cache_ctrl_t *) ctrl;
+    if (cache->is_open == false) {
+        return ESP_CODEC_DEV_WRONG_STATE;
+    }
+    if (reg_len != 1) {
+        cache_flush(cache);
+        cache->stats.bus_write += num;
+        return audio_codec_ctrl_write_regs(cache->ctrl_if, reg_len, regs, num);
+    }
+    audio_codec_reg_val_t batch[CACHE_BATCH_MAX];
+    int n = 0;
+    int ret = ESP_CODEC_DEV_OK;
+    for (int i = 0; i < num; i++) {
+        int reg = regs[i].reg;
+        uint8_t v = regs[i].value;
+        if (cache->write_back || is_reset(cache, reg, 1, &v) || cacheable(cache, reg, 1, 1) == false) {
+            // Send queued writes first to keep register order
+            ret |= cache_send(cache, batch, n);
+            n = 0;
+            ret |= _cache_ctrl_write_reg(ctrl, reg, 1, &v, 1);
+            continue;
+        }
+        if (BIT_GET(cache->valid, reg) && cache->value[reg] == v) {
+            cache->stats.skip_write++;
+            continue;
+        }
+        cache->value[reg] = v;
+        BIT_SET(cache->valid, reg);
+        batch[n++] = regs[i];
+        if (n == CACHE_BATCH_MAX) {
+            ret |= cache_send(cache, batch, n);
+            n = 0;
+        }
+    }
+    ret |= cache_send(cache, batch, n);
+    return ret;
+}
+
+static int _cache_ctrl_close(const audio_codec_ctrl_if_t *ctrl)
+{
+    if (ctrl == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    cache_ctrl_t *cache = (cache_ctrl_t *) ctrl;
+    int ret = ESP_CODEC_DEV_OK;
+    if (cache->is_open) {
+        ret = cache_flush(cache);
+    }
+    cache->is_open = false;
+    return ret;
+}
+
+const audio_codec_ctrl_if_t *audio_codec_new_cache_ctrl(audio_codec_cache_cfg_t *cfg)
+{
+    if (cfg == NULL || cfg->ctrl_if == NULL || cfg->reg_num == 0 || cfg->reg_num > CACHE_REG_MAX
+        || (cfg->volatile_num && cfg->volatile_reg == NULL)) {
+        ESP_LOGE(TAG, "Bad configuration");
+        return NULL;
+    }
+    cache_ctrl_t *cache = calloc(1, sizeof(cache_ctrl_t));
+    if (cache == NULL) {
+        ESP_LOGE(TAG, "No memory for instance");
+        return NULL;
+    }
+    cache->base.open = _cache_ctrl_open;
+    cache->base.is_open = _cache_ctrl_is_open;
+    cache->base.read_reg = _cache_ctrl_read_reg;
+    cache->base.write_reg = _cache_ctrl_write_reg;
+    cache->base.close = _cache_ctrl_close;
+    cache->base.write_regs = _cache_ctrl_write_regs;
+    cache->ctrl_if = cfg->ctrl_if;
+    cache->reg_num = cfg->reg_num;
+    cache->reset_reg = cfg->reset_reg;
+    cache->reset_mask = cfg->reset_mask;
+    cache->write_back = cfg->write_back;
+    for (int i = 0; i < cfg->volatile_num; i++) {
+        BIT_SET(cache->volatile_mask, cfg->volatile_reg[i]);
+    }
+    cache->is_open = true;
+    return &cache->base;
+}
+
+static const uint8_t es7210_volatile_reg[] = {
+    ES7210_CHIP_ID1_REG3D, ES7210_CHIP_ID0_REG3E, ES7210_CHIP_VER_REG3F,
+};
+
+static const uint8_t es8311_volatile_reg[] = {
+    ES8311_FLAG_REGFC, ES8311_CHD1_REGFD, ES8311_CHD2_REGFE, ES8311_CHVER_REGFF,
+};
+
+const audio_codec_ctrl_if_t *audio_codec_new_codec_cache_ctrl(const audio_codec_ctrl_if_t *ctrl_if,
+                                                              audio_codec_cache_codec_t codec)
+{
+    audio_codec_cache_cfg_t cfg = {
+        .ctrl_if = ctrl_if,
+        .reg_num = CACHE_REG_MAX,
+    };
+    switch (codec) {
+        case AUDIO_CODEC_CACHE_ES7210:
+            cfg.volatile_reg = es7210_volatile_reg;
+            cfg.volatile_num = sizeof(es7210_volatile_reg);
+            cfg.reset_reg = ES7210_RESET_REG00;
+            // 0x41 is the running value, the driver resets with 0x71 and 0xFF
+            cfg.reset_mask = 0x3E;
+            break;
+        case AUDIO_CODEC_CACHE_ES8311:
+            cfg.volatile_reg = es8311_volatile_reg;
+            cfg.volatile_num = sizeof(es8311_volatile_reg);
+            cfg.reset_reg = ES8311_RESET_REG00;
+            // Bits 4:0 reset the blocks, CSM_ON and MSC above them are only settings
+            cfg.reset_mask = 0x1F;
+            break;
+        default:
+            ESP_LOGE(TAG, "Unknown codec %d", codec);
+            return NULL;
+    }
+    return audio_codec_new_cache_ctrl(&cfg);
+}
+
+int audio_codec_cache_sync(const audio_codec_ctrl_if_t *ctrl)
+{
+    if (ctrl == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    cache_ctrl_t *cache = (cache_ctrl_t *) ctrl;
+    if (cache->is_open == false) {
+        return ESP_CODEC_DEV_WRONG_STATE;
+    }
+    return cache_flush(cache);
+}
+
+int audio_codec_cache_invalidate(const audio_codec_ctrl_if_t *ctrl)
+{
+    if (ctrl == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    cache_ctrl_t *cache = (cache_ctrl_t *) ctrl;
+    memset(cache->valid, 0, sizeof(cache->valid));
+    memset(cache->dirty, 0, sizeof(cache->dirty));
+    return ESP_CODEC_DEV_OK;
+}
+
+int audio_codec_cache_get_stats(const audio_codec_ctrl_if_t *ctrl, audio_codec_cache_stats_t *stats)
+{
+    if (ctrl == NULL || stats == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    cache_ctrl_t *cache = (cache_ctrl_t *) ctrl;
+    *stats = cache->stats;
+    return ESP_CODEC_DEV_OK;
+}
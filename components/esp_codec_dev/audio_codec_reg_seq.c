@@ -0,0 +1,79 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stddef.h>
+#include "audio_codec_reg_seq.h"
+#include "esp_codec_dev_os.h"
+#include "esp_log.h"
+
+#define TAG "Reg_Seq"
+
+#define SEQ_ARG(op)    ((op) & ~AUDIO_CODEC_SEQ_OP_MASK)
+#define SEQ_GROUP_MAX  (SEQ_ARG(0xFF) + 1)
+
+static int seq_op_len(uint8_t op)
+{
+    int n = SEQ_ARG(op) + 1;
+    switch (op & AUDIO_CODEC_SEQ_OP_MASK) {
+        case AUDIO_CODEC_SEQ_OP_WRITE:
+            return 1 + 2 * n;
+        case AUDIO_CODEC_SEQ_OP_BURST:
+            return 2 + n;
+        case AUDIO_CODEC_SEQ_OP_DELAY:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+int audio_codec_reg_seq_run(const audio_codec_ctrl_if_t *ctrl_if, const uint8_t *seq, int size)
+{
+    if (ctrl_if == NULL || seq == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    audio_codec_reg_val_t regs[SEQ_GROUP_MAX];
+    int i = 0;
+    while (i < size && seq[i] != AUDIO_CODEC_SEQ_OP_END) {
+        uint8_t op = seq[i];
+        const uint8_t *arg = &seq[i + 1];
+        int len = seq_op_len(op);
+        if (len == 0) {
+            break;
+        }
+        if (i + len > size) {
+            ESP_LOGE(TAG, "Truncated op at offset %d", i);
+            return ESP_CODEC_DEV_INVALID_ARG;
+        }
+        int n = SEQ_ARG(op) + 1;
+        int ret = ESP_CODEC_DEV_OK;
+        switch (op & AUDIO_CODEC_SEQ_OP_MASK) {
+            case AUDIO_CODEC_SEQ_OP_WRITE:
+                for (int j = 0; j < n; j++) {
+                    regs[j].reg = arg[2 * j];
+                    regs[j].value = arg[2 * j + 1];
+                }
+                ret = audio_codec_ctrl_write_regs(ctrl_if, 1, regs, n);
+                break;
+            case AUDIO_CODEC_SEQ_OP_BURST:
+                ret = ctrl_if->write_reg(ctrl_if, arg[0], 1, (void *) &arg[1], n);
+                break;
+            default:
+                esp_codec_dev_sleep((SEQ_ARG(op) << 8) | arg[0]);
+                break;
+        }
+        if (ret != ESP_CODEC_DEV_OK) {
+            ESP_LOGE(TAG, "Fail to write registers at offset %d", i);
+            return ret;
+        }
+        i += len;
+    }
+    if (i >= size) {
+        ESP_LOGE(TAG, "Sequence not ended at offset %d", i);
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    if (seq[i] != AUDIO_CODEC_SEQ_OP_END) {
+        ESP_LOGE(TAG, "Bad opcode 0x%x at offset %d", seq[i], i);
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    return ESP_CODEC_DEV_OK;
+}
@@ -114,6 +114,23 @@ static int es7210_write_reg(audio_codec_es7210_t *codec, int reg, int value)
     return codec->ctrl_if->write_reg(codec->ctrl_if, reg, 1, &value, 1);
 }
 
+static const audio_codec_reg_val_t es7210_init_regs[] = {
+    {ES7210_RESET_REG00, 0xff},
+    {ES7210_RESET_REG00, 0x41},
+    {ES7210_CLOCK_OFF_REG01, 0x3f},
+    {ES7210_TIME_CONTROL0_REG09, 0x30}, /* Set chip state cycle */
+    {ES7210_TIME_CONTROL1_REG0A, 0x30}, /* Set power on state cycle */
+    {ES7210_ADC12_HPF2_REG23, 0x2a},    /* Quick setup */
+    {ES7210_ADC12_HPF1_REG22, 0x0a},
+    {ES7210_ADC34_HPF2_REG20, 0x0a},
+    {ES7210_ADC34_HPF1_REG21, 0x2a},
+};
+
+static int es7210_write_regs(audio_codec_es7210_t *codec, const audio_codec_reg_val_t *regs, int num)
+{
+    return audio_codec_ctrl_write_regs(codec->ctrl_if, 1, regs, num);
+}
+
 static int es7210_read_reg(audio_codec_es7210_t *codec, int reg, int *value)
 {
     *value = 0;
@@ -157,15 +174,13 @@ static int es7210_config_sample(audio_codec_es7210_t *codec, int sample_fre)
         regv |= coeff_div[coeff].adc_div;
         regv |= coeff_div[coeff].doubler << 6;
         regv |= coeff_div[coeff].dll << 7;
-        ret |= es7210_write_reg(codec, ES7210_MAINCLK_REG02, regv);
-        /* Set osr */
-        regv = coeff_div[coeff].osr;
-        ret |= es7210_write_reg(codec, ES7210_OSR_REG07, regv);
-        /* Set lrck */
-        regv = coeff_div[coeff].lrck_h;
-        ret |= es7210_write_reg(codec, ES7210_LRCK_DIVH_REG04, regv);
-        regv = coeff_div[coeff].lrck_l;
-        ret |= es7210_write_reg(codec, ES7210_LRCK_DIVL_REG05, regv);
+        audio_codec_reg_val_t regs[] = {
+            {ES7210_MAINCLK_REG02, regv},
+            {ES7210_OSR_REG07, coeff_div[coeff].osr},       /* Set osr */
+            {ES7210_LRCK_DIVH_REG04, coeff_div[coeff].lrck_h}, /* Set lrck */
+            {ES7210_LRCK_DIVL_REG05, coeff_div[coeff].lrck_l},
+        };
+        ret |= es7210_write_regs(codec, regs, sizeof(regs) / sizeof(regs[0]));
     }
     return ret;
 }
@@ -409,15 +424,7 @@ static int es7210_open(const audio_codec_if_t *h, void *cfg, int cfg_size)
     }
     int ret = 0;
     codec->ctrl_if = codec_cfg->ctrl_if;
-    ret |= es7210_write_reg(codec, ES7210_RESET_REG00, 0xff);
-    ret |= es7210_write_reg(codec, ES7210_RESET_REG00, 0x41);
-    ret |= es7210_write_reg(codec, ES7210_CLOCK_OFF_REG01, 0x3f);
-    ret |= es7210_write_reg(codec, ES7210_TIME_CONTROL0_REG09, 0x30); /* Set chip state cycle */
-    ret |= es7210_write_reg(codec, ES7210_TIME_CONTROL1_REG0A, 0x30); /* Set power on state cycle */
-    ret |= es7210_write_reg(codec, ES7210_ADC12_HPF2_REG23, 0x2a);    /* Quick setup */
-    ret |= es7210_write_reg(codec, ES7210_ADC12_HPF1_REG22, 0x0a);
-    ret |= es7210_write_reg(codec, ES7210_ADC34_HPF2_REG20, 0x0a);
-    ret |= es7210_write_reg(codec, ES7210_ADC34_HPF1_REG21, 0x2a);
+    ret |= es7210_write_regs(codec, es7210_init_regs, sizeof(es7210_init_regs) / sizeof(es7210_init_regs[0]));
     if (ret != 0) {
         ESP_LOGE(TAG, "Write register fail");
         return ESP_CODEC_DEV_WRITE_FAIL;
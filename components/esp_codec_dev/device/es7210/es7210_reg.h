@@ -42,6 +42,9 @@ extern "C" {
 #define ES7210_MIC4_POWER_REG4A      0x4A
 #define ES7210_MIC12_POWER_REG4B     0x4B /* MICBias & ADC & PGA Power */
 #define ES7210_MIC34_POWER_REG4C     0x4C
+#define ES7210_CHIP_ID1_REG3D        0x3D /* CHIP ID1, read only */
+#define ES7210_CHIP_ID0_REG3E        0x3E /* CHIP ID0, read only */
+#define ES7210_CHIP_VER_REG3F        0x3F /* VERSION, read only */
 
 typedef enum {
     ES7210_AD1_AD0_00 = 0x80,
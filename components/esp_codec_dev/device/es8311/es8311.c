@@ -154,11 +154,30 @@ static const esp_codec_dev_vol_range_t vol_range = {
     },
 };
 
+static const audio_codec_reg_val_t es8311_init_regs[] = {
+    {ES8311_CLK_MANAGER_REG01, 0x30},
+    {ES8311_CLK_MANAGER_REG02, 0x00},
+    {ES8311_CLK_MANAGER_REG03, 0x10},
+    {ES8311_ADC_REG16, 0x24},
+    {ES8311_CLK_MANAGER_REG04, 0x10},
+    {ES8311_CLK_MANAGER_REG05, 0x00},
+    {ES8311_SYSTEM_REG0B, 0x00},
+    {ES8311_SYSTEM_REG0C, 0x00},
+    {ES8311_SYSTEM_REG10, 0x1F},
+    {ES8311_SYSTEM_REG11, 0x7F},
+    {ES8311_RESET_REG00, 0x80},
+};
+
 static int es8311_write_reg(audio_codec_es8311_t *codec, int reg, int value)
 {
     return codec->cfg.ctrl_if->write_reg(codec->cfg.ctrl_if, reg, 1, &value, 1);
 }
 
+static int es8311_write_regs(audio_codec_es8311_t *codec, const audio_codec_reg_val_t *regs, int num)
+{
+    return audio_codec_ctrl_write_regs(codec->cfg.ctrl_if, 1, regs, num);
+}
+
 static int es8311_read_reg(audio_codec_es8311_t *codec, int reg, int *value)
 {
     *value = 0;
@@ -421,8 +440,16 @@ static int es8311_config_sample(audio_codec_es8311_t *codec, int sample_rate)
         return ESP_CODEC_DEV_NOT_SUPPORT;
     }
     int ret = 0;
-    ret = es8311_read_reg(codec, ES8311_CLK_MANAGER_REG02, &regv);
-    regv &= 0x7;
+    int reg02, reg03, reg04, reg06, reg07;
+    ret |= es8311_read_reg(codec, ES8311_CLK_MANAGER_REG02, &reg02);
+    ret |= es8311_read_reg(codec, ES8311_CLK_MANAGER_REG03, &reg03);
+    ret |= es8311_read_reg(codec, ES8311_CLK_MANAGER_REG04, &reg04);
+    ret |= es8311_read_reg(codec, ES8311_CLK_MANAGER_REG07, &reg07);
+    ret |= es8311_read_reg(codec, ES8311_CLK_MANAGER_REG06, &reg06);
+    if (ret != 0) {
+        return ESP_CODEC_DEV_READ_FAIL;
+    }
+    regv = reg02 & 0x7;
     regv |= (coeff_div[coeff].pre_div - 1) << 5;
     datmp = 0;
     switch (coeff_div[coeff].pre_multi) {
@@ -445,41 +472,25 @@ static int es8311_config_sample(audio_codec_es8311_t *codec, int sample_rate)
         datmp = 3;
     }
     regv |= (datmp) << 3;
-    ret |= es8311_write_reg(codec, ES8311_CLK_MANAGER_REG02, regv);
-
-    regv = 0x00;
-    regv |= (coeff_div[coeff].adc_div - 1) << 4;
-    regv |= (coeff_div[coeff].dac_div - 1) << 0;
-    ret |= es8311_write_reg(codec, ES8311_CLK_MANAGER_REG05, regv);
-
-    ret |= es8311_read_reg(codec, ES8311_CLK_MANAGER_REG03, &regv);
-    regv &= 0x80;
-    regv |= coeff_div[coeff].fs_mode << 6;
-    regv |= coeff_div[coeff].adc_osr << 0;
-    ret |= es8311_write_reg(codec, ES8311_CLK_MANAGER_REG03, regv);
-
-    ret |= es8311_read_reg(codec, ES8311_CLK_MANAGER_REG04, &regv);
-    regv &= 0x80;
-    regv |= coeff_div[coeff].dac_osr << 0;
-    ret |= es8311_write_reg(codec, ES8311_CLK_MANAGER_REG04, regv);
-
-    ret |= es8311_read_reg(codec, ES8311_CLK_MANAGER_REG07, &regv);
-    regv &= 0xC0;
-    regv |= coeff_div[coeff].lrck_h << 0;
-    ret |= es8311_write_reg(codec, ES8311_CLK_MANAGER_REG07, regv);
-
-    regv = 0x00;
-    regv |= coeff_div[coeff].lrck_l << 0;
-    ret |= es8311_write_reg(codec, ES8311_CLK_MANAGER_REG08, regv);
-
-    ret = es8311_read_reg(codec, ES8311_CLK_MANAGER_REG06, &regv);
-    regv &= 0xE0;
+    reg02 = regv;
+
+    reg06 &= 0xE0;
     if (coeff_div[coeff].bclk_div < 19) {
-        regv |= (coeff_div[coeff].bclk_div - 1) << 0;
+        reg06 |= (coeff_div[coeff].bclk_div - 1) << 0;
     } else {
-        regv |= (coeff_div[coeff].bclk_div) << 0;
-    }
-    ret |= es8311_write_reg(codec, ES8311_CLK_MANAGER_REG06, regv);
+        reg06 |= (coeff_div[coeff].bclk_div) << 0;
+    }
+    // Same write order as single register setting, sent with one call
+    audio_codec_reg_val_t regs[] = {
+        {ES8311_CLK_MANAGER_REG02, reg02},
+        {ES8311_CLK_MANAGER_REG05, ((coeff_div[coeff].adc_div - 1) << 4) | (coeff_div[coeff].dac_div - 1)},
+        {ES8311_CLK_MANAGER_REG03, (reg03 & 0x80) | (coeff_div[coeff].fs_mode << 6) | coeff_div[coeff].adc_osr},
+        {ES8311_CLK_MANAGER_REG04, (reg04 & 0x80) | coeff_div[coeff].dac_osr},
+        {ES8311_CLK_MANAGER_REG07, (reg07 & 0xC0) | coeff_div[coeff].lrck_h},
+        {ES8311_CLK_MANAGER_REG08, coeff_div[coeff].lrck_l},
+        {ES8311_CLK_MANAGER_REG06, reg06},
+    };
+    ret = es8311_write_regs(codec, regs, sizeof(regs) / sizeof(regs[0]));
     return ret == 0 ? ESP_CODEC_DEV_OK : ESP_CODEC_DEV_WRITE_FAIL;
 }
 
@@ -496,17 +507,7 @@ static int es8311_open(const audio_codec_if_t *h, void *cfg, int cfg_size)
     }
     int regv;
     int ret = ESP_CODEC_DEV_OK;
-    ret |= es8311_write_reg(codec, ES8311_CLK_MANAGER_REG01, 0x30);
-    ret |= es8311_write_reg(codec, ES8311_CLK_MANAGER_REG02, 0x00);
-    ret |= es8311_write_reg(codec, ES8311_CLK_MANAGER_REG03, 0x10);
-    ret |= es8311_write_reg(codec, ES8311_ADC_REG16, 0x24);
-    ret |= es8311_write_reg(codec, ES8311_CLK_MANAGER_REG04, 0x10);
-    ret |= es8311_write_reg(codec, ES8311_CLK_MANAGER_REG05, 0x00);
-    ret |= es8311_write_reg(codec, ES8311_SYSTEM_REG0B, 0x00);
-    ret |= es8311_write_reg(codec, ES8311_SYSTEM_REG0C, 0x00);
-    ret |= es8311_write_reg(codec, ES8311_SYSTEM_REG10, 0x1F);
-    ret |= es8311_write_reg(codec, ES8311_SYSTEM_REG11, 0x7F);
-    ret |= es8311_write_reg(codec, ES8311_RESET_REG00, 0x80);
+    ret |= es8311_write_regs(codec, es8311_init_regs, sizeof(es8311_init_regs) / sizeof(es8311_init_regs[0]));
 
     ret = es8311_read_reg(codec, ES8311_RESET_REG00, &regv);
     if (codec_cfg->master_mode) {
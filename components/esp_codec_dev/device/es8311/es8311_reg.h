@@ -72,6 +72,7 @@ extern "C" {
 /*
  * CHIP
  */
+#define ES8311_FLAG_REGFC        0xFC /* FLAG, read only status */
 #define ES8311_CHD1_REGFD        0xFD /* CHIP ID1 */
 #define ES8311_CHD2_REGFE        0xFE /* CHIP ID2 */
 #define ES8311_CHVER_REGFF       0xFF /* VERSION */
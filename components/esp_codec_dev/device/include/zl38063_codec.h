@@ -22,13 +22,16 @@ extern "C" {
  *               To playback other sample rate need do resampling firstly
  */
 typedef struct {
-    const audio_codec_ctrl_if_t *ctrl_if;     /*!< Codec Control interface */
-    const audio_codec_gpio_if_t *gpio_if;     /*!< Codec GPIO interface */
-    esp_codec_dec_work_mode_t    codec_mode;  /*!< Codec work mode: ADC or DAC */
-    int16_t                      pa_pin;      /*!< PA chip power pin */
-    bool                         pa_reverted; /*!< false: enable PA when pin set to 1, true: enable PA when pin set to 0 */
-    int16_t                      reset_pin;   /*!< Reset pin */
-    esp_codec_dev_hw_gain_t      hw_gain;     /*!< Hardware gain */
+    const audio_codec_ctrl_if_t *ctrl_if;       /*!< Codec Control interface */
+    const audio_codec_gpio_if_t *gpio_if;       /*!< Codec GPIO interface */
+    esp_codec_dec_work_mode_t    codec_mode;    /*!< Codec work mode: ADC or DAC */
+    int16_t                      pa_pin;        /*!< PA chip power pin */
+    bool                         pa_reverted;   /*!< false: enable PA when pin set to 1, true: enable PA when pin set to 0 */
+    int16_t                      reset_pin;     /*!< Reset pin */
+    esp_codec_dev_hw_gain_t      hw_gain;       /*!< Hardware gain */
+    const uint8_t               *fw_image;      /*!< Firmware image made by `tools/zl38063_s3_to_bin.py`, e.g. mapped from flash
+                                                     partition. Set to NULL to use built-in firmware */
+    uint32_t                     fw_image_size; /*!< Size of `fw_image` in bytes */
 } zl38063_codec_cfg_t;
 
 /**
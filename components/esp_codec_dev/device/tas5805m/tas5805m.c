@@ -7,7 +7,8 @@
 #include "esp_log.h"
 #include "tas5805m_dac.h"
 #include "tas5805m_reg.h"
-#include "tas5805m_reg_cfg.h"
+#include "tas5805m_registers_seq.h"
+#include "audio_codec_reg_seq.h"
 #include "esp_codec_dev_os.h"
 #include "esp_codec_dev_vol.h"
 
@@ -44,41 +45,6 @@ static int tas5805m_read_reg(audio_codec_tas5805m_t *codec, int reg, int *value)
     return codec->cfg.ctrl_if->read_reg(codec->cfg.ctrl_if, reg, 1, value, 1);
 }
 
-static int tas5805m_write_data(audio_codec_tas5805m_t *codec, uint8_t reg_addr, uint8_t *data, int size)
-{
-    return codec->cfg.ctrl_if->write_reg(codec->cfg.ctrl_if, reg_addr, 1, data, size);
-}
-
-static int tas5805m_transmit_registers(audio_codec_tas5805m_t *codec, const tas5805m_cfg_reg_t *conf_buf, int size)
-{
-    int i = 0;
-    int ret = 0;
-    while (i < size) {
-        switch (conf_buf[i].offset) {
-            case CFG_META_SWITCH:
-                // Used in legacy applications.  Ignored here.
-                break;
-            case CFG_META_DELAY:
-                esp_codec_dev_sleep(conf_buf[i].value);
-                break;
-            case CFG_META_BURST:
-                ret = tas5805m_write_data(codec, conf_buf[i + 1].offset, (uint8_t *) (&conf_buf[i + 1].value),
-                                          conf_buf[i].value);
-                i += (conf_buf[i].value / 2) + 1;
-                break;
-            default:
-                ret = tas5805m_write_reg(codec, conf_buf[i].offset, conf_buf[i].value);
-                break;
-        }
-        i++;
-    }
-    if (ret != ESP_CODEC_DEV_OK) {
-        ESP_LOGE(TAG, "Fail to load configuration to tas5805m");
-        return ret;
-    }
-    return ret;
-}
-
 static int tas5805m_set_mute_fade(audio_codec_tas5805m_t *codec, int value)
 {
     int ret = 0;
@@ -137,8 +103,8 @@ static int tas5805m_open(const audio_codec_if_t *h, void *cfg, int cfg_size)
     }
     memcpy(&codec->cfg, codec_cfg, sizeof(tas5805m_codec_cfg_t));
     tas5805m_reset(codec, codec_cfg->reset_pin);
-    int ret = tas5805m_transmit_registers(codec, tas5805m_registers,
-                                          sizeof(tas5805m_registers) / sizeof(tas5805m_registers[0]));
+    // Compiled from `tas5805m_registers` in tas5805m_reg_cfg.h at build time
+    int ret = audio_codec_reg_seq_run(codec->cfg.ctrl_if, tas5805m_registers_seq, sizeof(tas5805m_registers_seq));
     if (ret != ESP_CODEC_DEV_OK) {
         ESP_LOGE(TAG, "Fail write register group");
     } else {
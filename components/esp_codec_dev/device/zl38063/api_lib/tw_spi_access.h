@@ -6,5 +6,6 @@
 #include <stdlib.h>
 
 int tw_upload_dsp_firmware(int mode);
+int tw_upload_dsp_image(int mode, const unsigned char *image, unsigned long size);
 
 #endif
@@ -766,6 +766,151 @@ VprocStatusType VprocTwolfHbiBootConclude(void)
     // return status;
 }
 
+/*The following functions load a packed image made by tools/zl38063_s3_to_bin.py
+ * The S3 text is parsed on the host already, each block of the image fits one
+ * 256 bytes window of page 255 and is sent as a single SPI burst
+ */
+static uint32 TwolfImageGet32(const unsigned char *p)
+{
+    return (uint32) p[0] | ((uint32) p[1] << 8) | ((uint32) p[2] << 16) | ((uint32) p[3] << 24);
+}
+
+static uint16 TwolfImageGet16(const unsigned char *p)
+{
+    return (uint16) (p[0] | (p[1] << 8));
+}
+
+/*TwolfImageCrc32() - same CRC32 as zlib, 4 bits per step to keep the table small*/
+static uint32 TwolfImageCrc32(const unsigned char *p, uint32 len)
+{
+    static const uint32 crcTable[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    uint32 crc = 0xFFFFFFFF;
+    while (len--) {
+        crc = crcTable[(crc ^ *p) & 0x0F] ^ (crc >> 4);
+        crc = crcTable[(crc ^ (*p >> 4)) & 0x0F] ^ (crc >> 4);
+        p++;
+    }
+    return ~crc;
+}
+
+/*TwolfImageCheck() - verify the image header, block layout and CRC
+ * before the device is put into boot mode
+ */
+static VprocStatusType TwolfImageCheck(const unsigned char *pImage, uint32 size)
+{
+    uint32 blockNum, bodySize, pos, i;
+    if (pImage == NULL || size < TWOLF_IMAGE_HEADER_SIZE) {
+        return VPROC_STATUS_INVALID_ARG;
+    }
+    if (TwolfImageGet32(pImage) != TWOLF_IMAGE_MAGIC || TwolfImageGet16(pImage + 4) != TWOLF_IMAGE_VERSION) {
+        DEBUG_LOGE(TAG_SPI, "ERROR: not a firmware image\n");
+        return VPROC_STATUS_ERR_IMAGE;
+    }
+    blockNum = TwolfImageGet32(pImage + 8);
+    bodySize = TwolfImageGet32(pImage + 20);
+    if (bodySize != size - TWOLF_IMAGE_HEADER_SIZE
+        || TwolfImageCrc32(pImage + TWOLF_IMAGE_HEADER_SIZE, bodySize) != TwolfImageGet32(pImage + 24)) {
+        DEBUG_LOGE(TAG_SPI, "ERROR: firmware image is corrupted\n");
+        return VPROC_STATUS_ERR_IMAGE;
+    }
+    pos = TWOLF_IMAGE_HEADER_SIZE;
+    for (i = 0; i < blockNum; i++) {
+        uint32 address;
+        uint16 numWords;
+        if (pos + TWOLF_IMAGE_BLOCK_SIZE > size) {
+            break;
+        }
+        address = TwolfImageGet32(pImage + pos);
+        numWords = TwolfImageGet16(pImage + pos + 4);
+        if (numWords == 0 || numWords > 126 || (address & 0xFF) + numWords * 2 > 256) {
+            break;
+        }
+        pos += TWOLF_IMAGE_BLOCK_SIZE + ((numWords * 2 + 3) & ~3);
+    }
+    if (i != blockNum || pos != size) {
+        DEBUG_LOGE(TAG_SPI, "ERROR: bad block %d in firmware image\n", (int) i);
+        return VPROC_STATUS_ERR_IMAGE;
+    }
+    return VPROC_STATUS_SUCCESS;
+}
+
+static VprocStatusType HbiImageBoot(const unsigned char *pImage)
+{
+    VprocStatusType status = VPROC_STATUS_SUCCESS;
+    uint32 blockNum = TwolfImageGet32(pImage + 8);
+    uint32 execAddr = TwolfImageGet32(pImage + 12);
+    uint32 window = 0xFFFFFFFF;
+    uint32 pos = TWOLF_IMAGE_HEADER_SIZE;
+    uint16 gTargetAddr[2] = {0, 0};
+    uint32 i;
+
+    for (i = 0; i < blockNum; i++) {
+        uint32 address = TwolfImageGet32(pImage + pos);
+        uint16 numWords = TwolfImageGet16(pImage + pos + 4);
+        pos += TWOLF_IMAGE_BLOCK_SIZE;
+        /*move the page 255 window only when the block leaves the current one*/
+        if ((address & 0xFFFFFF00) != window) {
+            window = address & 0xFFFFFF00;
+            gTargetAddr[0] = (uint16) ((window & 0xFFFF0000) >> 16);
+            gTargetAddr[1] = (uint16) (window & 0x0000FFFF);
+            status = VprocTwolfHbiWrite(PAGE_255_BASE_HI_REG, 2, gTargetAddr);
+            if (status != VPROC_STATUS_SUCCESS) {
+                DEBUG_LOGE(TAG_SPI, "Unable to set target address 0x%08x\n", (unsigned int) window);
+                return VPROC_STATUS_FW_LOAD_FAILED;
+            }
+        }
+        if (VprocHALWrite(HBI_SELECT_PAGE(0xFF)) != 0
+            || VprocHALWrite(HBI_PAGED_WRITE((address & 0xFF) / 2, numWords - 1)) != 0
+            || VprocHALWriteBlock(pImage + pos, numWords * 2) != 0) {
+            DEBUG_LOGE(TAG_SPI, "Unable to write block at 0x%08x\n", (unsigned int) address);
+            return VPROC_STATUS_FW_LOAD_FAILED;
+        }
+        pos += (numWords * 2 + 3) & ~3;
+    }
+
+    /* program the program's execution start register */
+    gTargetAddr[0] = (uint16) ((execAddr & 0xFFFF0000) >> 16);
+    gTargetAddr[1] = (uint16) (execAddr & 0x0000FFFF);
+    status = VprocTwolfHbiWrite(0x12C, 2, gTargetAddr);
+    if (status != VPROC_STATUS_SUCCESS) {
+        DEBUG_LOGE(TAG_SPI, " unable to program page 1 execution address\n");
+        return status;
+    }
+    DEBUG_LOGI(TAG_SPI, "execAddr 0x%08x, %d blocks\n", (unsigned int) execAddr, (int) blockNum);
+    return VPROC_STATUS_SUCCESS;
+}
+
+/*VprocTwolfHbiBootImage - use this function to bootload a packed firmware image
+ * into the device, the image is checked before the device enters boot mode
+ * \param[in] pointer to the image
+ * \param[in] size of the image in bytes
+ *
+ * \retval ::VPROC_STATUS_SUCCESS
+ * \retval ::VPROC_STATUS_ERR_IMAGE
+ * \retval ::VPROC_STATUS_ERR_HBI
+ * \retval ::VPROC_STATUS_FW_LOAD_FAILED
+ */
+VprocStatusType VprocTwolfHbiBootImage(const unsigned char *pImage, unsigned long size)
+{
+    VprocStatusType status = TwolfImageCheck(pImage, (uint32) size);
+    if (status != VPROC_STATUS_SUCCESS) {
+        return status;
+    }
+    status = VprocTwolfHbiBootPrepare();
+    if (status != VPROC_STATUS_SUCCESS) {
+        return status;
+    }
+    status = HbiImageBoot(pImage);
+    if (status != VPROC_STATUS_SUCCESS) {
+        DEBUG_LOGE(TAG_SPI, "ERROR %d: \n", status);
+        return status;
+    }
+    return VprocTwolfHbiBootConclude();
+}
+
 /*USe this function to erase a slave flash device controlled by the Twolf*/
 VprocStatusType VprocTwolfEraseFlash(void)
 {
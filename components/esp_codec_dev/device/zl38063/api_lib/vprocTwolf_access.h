@@ -51,6 +51,22 @@ VprocStatusType
 VprocTwolfHbiBoot_alt(/*use this function to boot load the firmware (*.c) from the host to the device RAM*/
                       twFirmware *st_firmware); /*Pointer to the firmware image in host RAM*/
 
+/*Packed firmware image converted from the *.s3 by tools/zl38063_s3_to_bin.py
+ * Header (little endian): magic, version, flags, block number, execution address,
+ *                         program base address, size of block area, CRC32 of block area
+ * Block: target address (32-bit), number of words (16-bit), reserved (16-bit),
+ *        data words in SPI byte order, padded to 4 bytes
+ */
+#define TWOLF_IMAGE_MAGIC       0x57464C5A /*'ZLFW'*/
+#define TWOLF_IMAGE_VERSION     1
+#define TWOLF_IMAGE_HEADER_SIZE 28
+#define TWOLF_IMAGE_BLOCK_SIZE  8
+
+VprocStatusType
+VprocTwolfHbiBootImage(/*use this function to boot load a packed image, e.g. mapped from a flash partition*/
+                       const unsigned char *pImage, /*Pointer to the image*/
+                       unsigned long size);         /*Size of the image in bytes*/
+
 VprocStatusType VprocTwolfLoadConfig(dataArr *pCr2Buf, unsigned short numElements);
 
 VprocStatusType VprocTwolfHbiCleanup(void);
@@ -17,6 +17,8 @@
  *       accordingly
  **********************************************************************/
 
+#define VPROC_HAL_BLOCK_MAX 256 /*one 256 bytes window of page 255*/
+
 static audio_codec_ctrl_if_t *vproc_ctrl_if;
 
 void VprocSetCtrlIf(void *ctrl_if)
@@ -70,6 +72,25 @@ int VprocHALWrite(unsigned short val)
     return ret;
 }
 
+/* This is the platform dependent low level spi
+ * function to write a block of data already in SPI byte order in one transfer.
+ * The data may sit in mapped flash which SPI DMA can not read, so it is
+ * copied into internal RAM first
+ */
+int VprocHALWriteBlock(const unsigned char *pData, unsigned short len)
+{
+    static uint32_t block_buf[VPROC_HAL_BLOCK_MAX / sizeof(uint32_t)];
+    int ret = 0;
+    if (len > VPROC_HAL_BLOCK_MAX) {
+        return -1;
+    }
+    if (vproc_ctrl_if) {
+        memcpy(block_buf, pData, len);
+        ret = vproc_ctrl_if->write_reg(vproc_ctrl_if, 0, 0, block_buf, len);
+    }
+    return ret;
+}
+
 /* This is the platform dependent low level spi
  * function to read 16-bit data from the ZL380xx device
  */
@@ -115,6 +115,7 @@ extern int VprocHALInit(void);
 extern void Vproc_msDelay(unsigned short time);
 extern void VprocWait(unsigned long int time);
 extern int VprocHALWrite(unsigned short val);
+extern int VprocHALWriteBlock(const unsigned char *pData, unsigned short len);
 extern int VprocHALRead(unsigned short *pVal);
 
 #ifdef __cplusplus
@@ -33,13 +33,15 @@
  * Basically instead of loading the *.s3, *cr2 directly,
  * use the tw_convert tool to convert the ascii hex fwr mage into code and compile
  * with the application
+ * When image is set, the firmware is booted from the packed image
+ * made by tools/zl38063_s3_to_bin.py instead of the compiled st_twFirmware
  *
  * input arg: mode:  0 - load both firmware and confing
  *                   1 - load firmware only
  *                   2 - load config only
  *                  -1 - Force loading
  */
-int tw_upload_dsp_firmware(int mode)
+static int tw_upload_dsp(int mode, const unsigned char *image, unsigned long size)
 {
     union {
         short a;
@@ -67,16 +69,19 @@ int tw_upload_dsp_firmware(int mode)
     }
 
     if ((mode == 0) || (mode == 1)) {
-        twFirmware st_Firmware;
-        st_Firmware.st_Fwr = (twFwr *) st_twFirmware;
-        st_Firmware.twFirmwareStreamLen = (uint16) firmwareStreamLen;
-        st_Firmware.execAddr = (uint32) executionAddress;
-        st_Firmware.havePrgmBase = (uint8) haveProgramBaseAddress;
-        st_Firmware.prgmBase = (uint32) programBaseAddress;
-
         ESP_LOGI(TAG_SPI, "1- Firmware boot loading started ....");
+        if (image) {
+            status = VprocTwolfHbiBootImage(image, size);
+        } else {
+            twFirmware st_Firmware;
+            st_Firmware.st_Fwr = (twFwr *) st_twFirmware;
+            st_Firmware.twFirmwareStreamLen = (uint16) firmwareStreamLen;
+            st_Firmware.execAddr = (uint32) executionAddress;
+            st_Firmware.havePrgmBase = (uint8) haveProgramBaseAddress;
+            st_Firmware.prgmBase = (uint32) programBaseAddress;
 
-        status = VprocTwolfHbiBoot_alt(&st_Firmware);
+            status = VprocTwolfHbiBoot_alt(&st_Firmware);
+        }
         if (status != VPROC_STATUS_SUCCESS) {
             DEBUG_LOGE(TAG_SPI, "Error %d:VprocTwolfHbiBoot()", status);
             // VprocTwolfHbiCleanup();
@@ -139,6 +144,19 @@ int tw_upload_dsp_firmware(int mode)
     return status;
 }
 
+int tw_upload_dsp_firmware(int mode)
+{
+    return tw_upload_dsp(mode, NULL, 0);
+}
+
+int tw_upload_dsp_image(int mode, const unsigned char *image, unsigned long size)
+{
+    if (image == NULL) {
+        return -1;
+    }
+    return tw_upload_dsp(mode, image, size);
+}
+
 int zl38063_comm(int argc, char **argv)
 {
     VprocStatusType status = VPROC_STATUS_SUCCESS;
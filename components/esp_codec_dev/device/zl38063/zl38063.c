@@ -167,7 +167,11 @@ static int zl38063_open(const audio_codec_if_t *h, void *cfg, int cfg_size)
     }
     if (status == 0) {
         ESP_LOGI(TAG, "Start upload firmware");
-        ret = tw_upload_dsp_firmware(0);
+        if (codec_cfg->fw_image) {
+            ret = tw_upload_dsp_image(0, codec_cfg->fw_image, codec_cfg->fw_image_size);
+        } else {
+            ret = tw_upload_dsp_firmware(0);
+        }
         if (ret != 0) {
             ESP_LOGE(TAG, "Fail to upload firmware");
             return ESP_CODEC_DEV_WRITE_FAIL;
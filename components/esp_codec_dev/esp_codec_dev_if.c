@@ -37,6 +37,24 @@ int audio_codec_delete_ctrl_if(const audio_codec_ctrl_if_t *h)
     return ESP_CODEC_DEV_INVALID_ARG;
 }
 
+int audio_codec_ctrl_write_regs(const audio_codec_ctrl_if_t *h, int reg_len, const audio_codec_reg_val_t *regs, int num)
+{
+    if (h == NULL || (regs == NULL && num)) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    if (h->write_regs) {
+        return h->write_regs(h, reg_len, regs, num);
+    }
+    for (int i = 0; i < num; i++) {
+        int value = regs[i].value;
+        int ret = h->write_reg(h, regs[i].reg, reg_len, &value, 1);
+        if (ret != ESP_CODEC_DEV_OK) {
+            return ret;
+        }
+    }
+    return ESP_CODEC_DEV_OK;
+}
+
 int audio_codec_delete_data_if(const audio_codec_data_if_t *h)
 {
     if (h) {
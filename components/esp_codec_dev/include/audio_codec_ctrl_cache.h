@@ -0,0 +1,103 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef _AUDIO_CODEC_CTRL_CACHE_H_
+#define _AUDIO_CODEC_CTRL_CACHE_H_
+
+#include "audio_codec_ctrl_if.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Register cache configuration
+ *
+ *        The cache wraps the control interface of one codec device and keeps a shadow copy of its
+ *        8 bits registers, so read-modify-write helpers like `es7210_update_reg_bit` only touch the bus
+ *        for the write, and writes of an unchanged value are skipped.
+ *        Only single byte accesses with one byte register address are cached, others pass through
+ *        and invalidate the registers they cover.
+ */
+typedef struct {
+    const audio_codec_ctrl_if_t *ctrl_if;      /*!< Bus control interface of the device, not owned by the cache */
+    uint16_t                     reg_num;      /*!< Registers `0` to `reg_num - 1` are cached, max 256 */
+    const uint8_t               *volatile_reg; /*!< Registers changed by the device itself, never cached */
+    uint8_t                      volatile_num; /*!< Number of `volatile_reg` */
+    int16_t                      reset_reg;    /*!< Writes to this register reset the device and drop the cache,
+                                                    set to -1 if not used */
+    uint8_t                      reset_mask;   /*!< Bits of `reset_reg` which start the reset, writes without any of
+                                                    them are cached like other registers, 0 for any write */
+    bool                         write_back;   /*!< Only mark writes dirty, `audio_codec_cache_sync` sends them */
+} audio_codec_cache_cfg_t;
+
+/**
+ * @brief Bus transaction counters of a cache
+ */
+typedef struct {
+    uint32_t bus_read;   /*!< Reads sent to the bus */
+    uint32_t bus_write;  /*!< Writes sent to the bus */
+    uint32_t hit_read;   /*!< Reads served from the cache */
+    uint32_t skip_write; /*!< Writes dropped because the register already held the value */
+} audio_codec_cache_stats_t;
+
+/**
+ * @brief Codecs with a known register map for `audio_codec_new_codec_cache_ctrl`
+ */
+typedef enum {
+    AUDIO_CODEC_CACHE_ES7210, /*!< ES7210 ADC */
+    AUDIO_CODEC_CACHE_ES8311, /*!< ES8311 codec */
+} audio_codec_cache_codec_t;
+
+/**
+ * @brief         New register cache control interface
+ * @param         cfg: Cache configuration
+ * @return        NULL: Wrong configuration or memory not enough
+ *                Others: Control interface to give to the codec driver instead of `cfg->ctrl_if`
+ */
+const audio_codec_ctrl_if_t *audio_codec_new_cache_ctrl(audio_codec_cache_cfg_t *cfg);
+
+/**
+ * @brief         New write-through register cache set up for a known codec
+ *                Read-only and status registers of the codec always go to the bus, writes setting reset bits
+ *                of its reset register send pending writes and drop the cache
+ * @param         ctrl_if: Bus control interface of the codec, not owned by the cache
+ * @param         codec: Codec behind `ctrl_if`
+ * @return        NULL: Wrong configuration or memory not enough
+ *                Others: Control interface to give to the codec driver instead of `ctrl_if`
+ */
+const audio_codec_ctrl_if_t *audio_codec_new_codec_cache_ctrl(const audio_codec_ctrl_if_t *ctrl_if,
+                                                              audio_codec_cache_codec_t codec);
+
+/**
+ * @brief         Send dirty registers to the device in address order
+ * @param         ctrl: Cache control interface
+ * @return        ESP_CODEC_DEV_OK: Sync success
+ *                ESP_CODEC_DEV_INVALID_ARG: Input is NULL pointer
+ *                Others: Bus write failed
+ */
+int audio_codec_cache_sync(const audio_codec_ctrl_if_t *ctrl);
+
+/**
+ * @brief         Drop all cached values, e.g. after a hardware reset through GPIO
+ *                Dirty registers not synced yet are lost
+ * @param         ctrl: Cache control interface
+ * @return        ESP_CODEC_DEV_OK: Invalidate success
+ *                ESP_CODEC_DEV_INVALID_ARG: Input is NULL pointer
+ */
+int audio_codec_cache_invalidate(const audio_codec_ctrl_if_t *ctrl);
+
+/**
+ * @brief         Get bus transaction counters
+ * @param         ctrl: Cache control interface
+ * @param         stats: Counters output
+ * @return        ESP_CODEC_DEV_OK: Get success
+ *                ESP_CODEC_DEV_INVALID_ARG: Input is NULL pointer
+ */
+int audio_codec_cache_get_stats(const audio_codec_ctrl_if_t *ctrl, audio_codec_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,45 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef _AUDIO_CODEC_REG_SEQ_H_
+#define _AUDIO_CODEC_REG_SEQ_H_
+
+#include "audio_codec_ctrl_if.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Register sequence opcodes
+ *
+ *        Sequences are compiled from register tables by `tools/gen_reg_seq.py` at build time.
+ *        Each opcode keeps a count or delay in its low 6 bits:
+ *          WRITE: `n + 1` pairs of register and value follow, sent by one `write_regs` call
+ *          BURST: start register and `n + 1` data bytes follow, sent as one auto-increment write,
+ *                 only generated for devices which auto-increment
+ *          DELAY: one more byte follows, delay is `(low6 << 8 | byte)` ms
+ *        Registers are 1 byte long, the sequence ends with `AUDIO_CODEC_SEQ_OP_END`
+ */
+#define AUDIO_CODEC_SEQ_OP_WRITE (0x00)
+#define AUDIO_CODEC_SEQ_OP_BURST (0x40)
+#define AUDIO_CODEC_SEQ_OP_DELAY (0x80)
+#define AUDIO_CODEC_SEQ_OP_END   (0xFF)
+#define AUDIO_CODEC_SEQ_OP_MASK  (0xC0)
+
+/**
+ * @brief         Run a compiled register sequence
+ * @param         ctrl_if: Codec control interface
+ * @param         seq: Sequence bytecode
+ * @param         size: Size of `seq` in bytes
+ * @return        ESP_CODEC_DEV_OK: Run success
+ *                ESP_CODEC_DEV_INVALID_ARG: Input is NULL pointer or sequence is malformed
+ *                Others: Register write failed, the sequence stops at the failed operation
+ */
+int audio_codec_reg_seq_run(const audio_codec_ctrl_if_t *ctrl_if, const uint8_t *seq, int size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -49,6 +49,8 @@ extern "C" {
 typedef struct {
     uint8_t port; /*!< I2C port, this port need pre-installed by other modules */
     uint8_t addr; /*!< I2C address, default address can be gotten from codec head files */
+    bool    auto_inc; /*!< Device increments register address after each data byte,
+                           consecutive registers of batch write are sent as one burst */
 } audio_codec_i2c_cfg_t;
 
 /**
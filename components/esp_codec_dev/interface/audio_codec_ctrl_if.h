@@ -14,6 +14,14 @@ extern "C" {
 
 typedef struct audio_codec_ctrl_if_t audio_codec_ctrl_if_t;
 
+/**
+ * @brief Register setting used for batch write
+ */
+typedef struct {
+    uint16_t reg;   /*!< Register address */
+    uint8_t  value; /*!< Register value */
+} audio_codec_reg_val_t;
+
 /**
  * @brief Audio codec control interface structure
  */
@@ -25,6 +33,8 @@ struct audio_codec_ctrl_if_t {
     int (*write_reg)(const audio_codec_ctrl_if_t *ctrl,
                       int reg, int reg_len, void *data, int data_len);       /*!< Write data to codec device register */
     int (*close)(const audio_codec_ctrl_if_t *ctrl);                         /*!< Close codec control interface */
+    int (*write_regs)(const audio_codec_ctrl_if_t *ctrl, int reg_len,
+                      const audio_codec_reg_val_t *regs, int num);           /*!< Write 8 bits registers in order with one call (optional) */
 };
 
 /**
@@ -35,6 +45,19 @@ struct audio_codec_ctrl_if_t {
  */
 int audio_codec_delete_ctrl_if(const audio_codec_ctrl_if_t *ctrl_if);
 
+/**
+ * @brief         Write several 8 bits registers in order
+ *                Use `write_regs` of the interface if provided, else write them one by one
+ * @param         ctrl_if: Audio codec interface
+ * @param         reg_len: Register address length in bytes
+ * @param         regs: Register settings
+ * @param         num: Number of `regs`
+ * @return        ESP_CODEC_DEV_OK: Write success
+ *                ESP_CODEC_DEV_INVALID_ARG: Input is NULL pointer
+ *                Others: Write failed, registers after the failed one may not be written
+ */
+int audio_codec_ctrl_write_regs(const audio_codec_ctrl_if_t *ctrl_if, int reg_len, const audio_codec_reg_val_t *regs, int num);
+
 #ifdef __cplusplus
 }
 #endif
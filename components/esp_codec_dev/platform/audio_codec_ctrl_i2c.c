@@ -16,11 +16,15 @@
 
 #define TAG "I2C_If"
 
+/* Registers sent in one auto-increment frame */
+#define I2C_BURST_MAX (32)
+
 typedef struct {
     audio_codec_ctrl_if_t base;
     bool                  is_open;
     uint8_t               port;
     uint8_t               addr;
+    bool                  auto_inc;
 } i2c_ctrl_t;
 
 static int _i2c_ctrl_open(const audio_codec_ctrl_if_t *ctrl, void *cfg, int cfg_size)
@@ -32,6 +36,7 @@ static int _i2c_ctrl_open(const audio_codec_ctrl_if_t *ctrl, void *cfg, int cfg_
     audio_codec_i2c_cfg_t *i2c_cfg = (audio_codec_i2c_cfg_t *) cfg;
     i2c_ctrl->port = i2c_cfg->port;
     i2c_ctrl->addr = i2c_cfg->addr;
+    i2c_ctrl->auto_inc = i2c_cfg->auto_inc;
     return 0;
 }
 
@@ -59,11 +64,7 @@ static int _i2c_ctrl_read_reg(const audio_codec_ctrl_if_t *ctrl, int addr, int a
     ret |= i2c_master_start(cmd);
     ret |= i2c_master_write_byte(cmd, i2c_ctrl->addr, 1);
     ret |= i2c_master_write(cmd, (uint8_t *) &addr, addr_len, 1);
-    ret |= i2c_master_stop(cmd);
-    ret |= i2c_master_cmd_begin(i2c_ctrl->port, cmd, 1000 / TICK_PER_MS);
-    i2c_cmd_link_delete(cmd);
-
-    cmd = i2c_cmd_link_create();
+    // Repeated start into the read phase, a single transaction on the bus
     ret |= i2c_master_start(cmd);
     ret |= i2c_master_write_byte(cmd, i2c_ctrl->addr | 0x01, 1);
 
@@ -107,6 +108,47 @@ static int _i2c_ctrl_write_reg(const audio_codec_ctrl_if_t *ctrl, int addr, int
     return ret ? ESP_CODEC_DEV_WRITE_FAIL : ESP_CODEC_DEV_OK;
 }
 
+static int _i2c_ctrl_write_regs(const audio_codec_ctrl_if_t *ctrl, int addr_len, const audio_codec_reg_val_t *regs,
+                                int num)
+{
+    i2c_ctrl_t *i2c_ctrl = (i2c_ctrl_t *) ctrl;
+    if (ctrl == NULL || (regs == NULL && num)) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    if (i2c_ctrl->is_open == false) {
+        return ESP_CODEC_DEV_WRONG_STATE;
+    }
+    esp_err_t ret = ESP_OK;
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    // All frames go in one transaction, joined by repeated starts and ended by a single stop
+    for (int i = 0; i < num;) {
+        int end = i + 1;
+        // Devices which auto-increment take a run of consecutive registers in one frame
+        while (i2c_ctrl->auto_inc && end < num && end - i < I2C_BURST_MAX && regs[end].reg == regs[end - 1].reg + 1) {
+            end++;
+        }
+        int addr = regs[i].reg;
+        ret |= i2c_master_start(cmd);
+        ret |= i2c_master_write_byte(cmd, i2c_ctrl->addr, 1);
+        // Copy the address, the link only keeps pointers to written buffers
+        for (int j = 0; j < addr_len; j++) {
+            ret |= i2c_master_write_byte(cmd, ((uint8_t *) &addr)[j], 1);
+        }
+        for (; i < end; i++) {
+            ret |= i2c_master_write_byte(cmd, regs[i].value, 1);
+        }
+    }
+    if (num) {
+        ret |= i2c_master_stop(cmd);
+        ret |= i2c_master_cmd_begin(i2c_ctrl->port, cmd, 1000 / TICK_PER_MS);
+    }
+    i2c_cmd_link_delete(cmd);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Fail to write registers to dev %x", i2c_ctrl->addr);
+    }
+    return ret ? ESP_CODEC_DEV_WRITE_FAIL : ESP_CODEC_DEV_OK;
+}
+
 static int _i2c_ctrl_close(const audio_codec_ctrl_if_t *ctrl)
 {
     if (ctrl == NULL) {
@@ -133,6 +175,7 @@ const audio_codec_ctrl_if_t *audio_codec_new_i2c_ctrl(audio_codec_i2c_cfg_t *i2c
     ctrl->base.read_reg = _i2c_ctrl_read_reg;
     ctrl->base.write_reg = _i2c_ctrl_write_reg;
     ctrl->base.close = _i2c_ctrl_close;
+    ctrl->base.write_regs = _i2c_ctrl_write_regs;
     int ret = _i2c_ctrl_open(&ctrl->base, i2c_cfg, sizeof(audio_codec_i2c_cfg_t));
     if (ret != 0) {
         free(ctrl);
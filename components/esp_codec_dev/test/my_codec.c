@@ -123,6 +123,7 @@ static bool my_codec_ctrl_is_open(const audio_codec_ctrl_if_t *ctrl)
 static int my_codec_ctrl_read_addr(const audio_codec_ctrl_if_t *ctrl, int addr, int addr_len, void *data, int data_len)
 {
     my_codec_ctrl_t *ctrl_if = (my_codec_ctrl_t *) ctrl;
+    ctrl_if->read_count++;
     if (data_len == 1 && addr < MY_CODEC_REG_MAX) {
         *(uint8_t *) data = ctrl_if->reg[addr];
         return 0;
@@ -133,6 +134,7 @@ static int my_codec_ctrl_read_addr(const audio_codec_ctrl_if_t *ctrl, int addr,
 static int my_codec_ctrl_write_addr(const audio_codec_ctrl_if_t *ctrl, int addr, int addr_len, void *data, int data_len)
 {
     my_codec_ctrl_t *ctrl_if = (my_codec_ctrl_t *) ctrl;
+    ctrl_if->write_count++;
     if (data_len == 1 && addr < MY_CODEC_REG_MAX) {
         ctrl_if->reg[addr] = *(uint8_t *) data;
         return 0;
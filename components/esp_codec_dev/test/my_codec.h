@@ -41,6 +41,8 @@ typedef enum {
 typedef struct {
     audio_codec_ctrl_if_t base;
     uint8_t               reg[MY_CODEC_REG_MAX];
+    int                   read_count;  /*!< Register reads received, used to count bus transactions */
+    int                   write_count; /*!< Register writes received */
     bool                  is_open;
 } my_codec_ctrl_t;
 
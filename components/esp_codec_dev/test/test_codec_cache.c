@@ -0,0 +1,212 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "my_codec.h"
+#include "audio_codec_ctrl_cache.h"
+
+/*
+ * Read-modify-write like codec drivers do to set one bit
+ */
+static int update_bit(const audio_codec_ctrl_if_t *ctrl, int reg, uint8_t mask, uint8_t val)
+{
+    uint8_t regv = 0;
+    int ret = ctrl->read_reg(ctrl, reg, 1, &regv, 1);
+    regv = (regv & ~mask) | (val & mask);
+    ret |= ctrl->write_reg(ctrl, reg, 1, &regv, 1);
+    return ret;
+}
+
+static void run_update_sequence(const audio_codec_ctrl_if_t *ctrl)
+{
+    for (int i = 0; i < 4; i++) {
+        TEST_ESP_OK(update_bit(ctrl, MY_CODEC_REG_VOL, 0x0F, i));
+        TEST_ESP_OK(update_bit(ctrl, MY_CODEC_REG_MUTE, 0x01, 1));
+    }
+}
+
+TEST_CASE("esp codec dev register cache test", "[esp_codec_dev]")
+{
+    // Count bus transactions without cache
+    const audio_codec_ctrl_if_t *ctrl_if = my_codec_ctrl_new();
+    TEST_ASSERT_NOT_NULL(ctrl_if);
+    my_codec_ctrl_t *codec_ctrl = (my_codec_ctrl_t *) ctrl_if;
+    run_update_sequence(ctrl_if);
+    TEST_ASSERT_EQUAL(8, codec_ctrl->read_count);
+    TEST_ASSERT_EQUAL(8, codec_ctrl->write_count);
+    uint8_t direct_reg[MY_CODEC_REG_MAX];
+    memcpy(direct_reg, codec_ctrl->reg, sizeof(direct_reg));
+    audio_codec_delete_ctrl_if(ctrl_if);
+
+    // Same sequence through cache, only first read of each register and changed values reach the bus
+    ctrl_if = my_codec_ctrl_new();
+    TEST_ASSERT_NOT_NULL(ctrl_if);
+    codec_ctrl = (my_codec_ctrl_t *) ctrl_if;
+    uint8_t volatile_reg[] = {MY_CODEC_REG_SUSPEND};
+    audio_codec_cache_cfg_t cache_cfg = {
+        .ctrl_if = ctrl_if,
+        .reg_num = MY_CODEC_REG_MAX,
+        .volatile_reg = volatile_reg,
+        .volatile_num = sizeof(volatile_reg),
+        .reset_reg = -1,
+    };
+    const audio_codec_ctrl_if_t *cache_if = audio_codec_new_cache_ctrl(&cache_cfg);
+    TEST_ASSERT_NOT_NULL(cache_if);
+    run_update_sequence(cache_if);
+    TEST_ASSERT_EQUAL(2, codec_ctrl->read_count);
+    TEST_ASSERT_EQUAL(4, codec_ctrl->write_count);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(direct_reg, codec_ctrl->reg, MY_CODEC_REG_MAX);
+
+    audio_codec_cache_stats_t stats;
+    TEST_ESP_OK(audio_codec_cache_get_stats(cache_if, &stats));
+    TEST_ASSERT_EQUAL(2, stats.bus_read);
+    TEST_ASSERT_EQUAL(6, stats.hit_read);
+    TEST_ASSERT_EQUAL(4, stats.bus_write);
+    TEST_ASSERT_EQUAL(4, stats.skip_write);
+
+    // Volatile register always read from bus
+    uint8_t regv = 0;
+    TEST_ESP_OK(cache_if->read_reg(cache_if, MY_CODEC_REG_SUSPEND, 1, &regv, 1));
+    TEST_ESP_OK(cache_if->read_reg(cache_if, MY_CODEC_REG_SUSPEND, 1, &regv, 1));
+    TEST_ASSERT_EQUAL(4, codec_ctrl->read_count);
+
+    // Value changed outside of cache is seen after invalidate
+    codec_ctrl->reg[MY_CODEC_REG_MIC_GAIN] = 20;
+    TEST_ESP_OK(cache_if->read_reg(cache_if, MY_CODEC_REG_MIC_GAIN, 1, &regv, 1));
+    codec_ctrl->reg[MY_CODEC_REG_MIC_GAIN] = 40;
+    TEST_ESP_OK(cache_if->read_reg(cache_if, MY_CODEC_REG_MIC_GAIN, 1, &regv, 1));
+    TEST_ASSERT_EQUAL(20, regv);
+    TEST_ESP_OK(audio_codec_cache_invalidate(cache_if));
+    TEST_ESP_OK(cache_if->read_reg(cache_if, MY_CODEC_REG_MIC_GAIN, 1, &regv, 1));
+    TEST_ASSERT_EQUAL(40, regv);
+
+    audio_codec_delete_ctrl_if(cache_if);
+    audio_codec_delete_ctrl_if(ctrl_if);
+}
+
+TEST_CASE("esp codec dev register cache write back test", "[esp_codec_dev]")
+{
+    const audio_codec_ctrl_if_t *ctrl_if = my_codec_ctrl_new();
+    TEST_ASSERT_NOT_NULL(ctrl_if);
+    my_codec_ctrl_t *codec_ctrl = (my_codec_ctrl_t *) ctrl_if;
+    audio_codec_cache_cfg_t cache_cfg = {
+        .ctrl_if = ctrl_if,
+        .reg_num = MY_CODEC_REG_MAX,
+        .reset_reg = MY_CODEC_REG_SUSPEND,
+        .write_back = true,
+    };
+    const audio_codec_ctrl_if_t *cache_if = audio_codec_new_cache_ctrl(&cache_cfg);
+    TEST_ASSERT_NOT_NULL(cache_if);
+
+    // Writes stay in cache until sync, last value wins
+    for (int i = 1; i <= 10; i++) {
+        uint8_t v = (uint8_t) i;
+        TEST_ESP_OK(cache_if->write_reg(cache_if, MY_CODEC_REG_VOL, 1, &v, 1));
+        TEST_ESP_OK(cache_if->write_reg(cache_if, MY_CODEC_REG_MIC_GAIN, 1, &v, 1));
+    }
+    TEST_ASSERT_EQUAL(0, codec_ctrl->write_count);
+    TEST_ASSERT_EQUAL(0, codec_ctrl->reg[MY_CODEC_REG_VOL]);
+    TEST_ESP_OK(audio_codec_cache_sync(cache_if));
+    TEST_ASSERT_EQUAL(2, codec_ctrl->write_count);
+    TEST_ASSERT_EQUAL(10, codec_ctrl->reg[MY_CODEC_REG_VOL]);
+    TEST_ASSERT_EQUAL(10, codec_ctrl->reg[MY_CODEC_REG_MIC_GAIN]);
+    TEST_ESP_OK(audio_codec_cache_sync(cache_if));
+    TEST_ASSERT_EQUAL(2, codec_ctrl->write_count);
+
+    // Reset register sends pending writes before it, then drops cached values
+    uint8_t v = 5;
+    TEST_ESP_OK(cache_if->write_reg(cache_if, MY_CODEC_REG_VOL, 1, &v, 1));
+    v = 1;
+    TEST_ESP_OK(cache_if->write_reg(cache_if, MY_CODEC_REG_SUSPEND, 1, &v, 1));
+    TEST_ASSERT_EQUAL(4, codec_ctrl->write_count);
+    TEST_ASSERT_EQUAL(5, codec_ctrl->reg[MY_CODEC_REG_VOL]);
+    codec_ctrl->reg[MY_CODEC_REG_VOL] = 0;
+    TEST_ESP_OK(cache_if->read_reg(cache_if, MY_CODEC_REG_VOL, 1, &v, 1));
+    TEST_ASSERT_EQUAL(1, codec_ctrl->read_count);
+    TEST_ASSERT_EQUAL(0, v);
+
+    // Pending writes are sent on close
+    v = 7;
+    TEST_ESP_OK(cache_if->write_reg(cache_if, MY_CODEC_REG_MUTE, 1, &v, 1));
+    audio_codec_delete_ctrl_if(cache_if);
+    TEST_ASSERT_EQUAL(7, codec_ctrl->reg[MY_CODEC_REG_MUTE]);
+    audio_codec_delete_ctrl_if(ctrl_if);
+}
+
+TEST_CASE("esp codec dev register batch write test", "[esp_codec_dev]")
+{
+    const audio_codec_ctrl_if_t *ctrl_if = my_codec_ctrl_new();
+    TEST_ASSERT_NOT_NULL(ctrl_if);
+    my_codec_ctrl_t *codec_ctrl = (my_codec_ctrl_t *) ctrl_if;
+    audio_codec_reg_val_t regs[] = {
+        {MY_CODEC_REG_VOL, 10},
+        {MY_CODEC_REG_MUTE, 1},
+        {MY_CODEC_REG_MIC_GAIN, 20},
+        {MY_CODEC_REG_MUTE, 0},
+    };
+    int num = sizeof(regs) / sizeof(regs[0]);
+    // Interface without `write_regs` falls back to register write in order
+    TEST_ESP_OK(audio_codec_ctrl_write_regs(ctrl_if, 1, regs, num));
+    TEST_ASSERT_EQUAL(4, codec_ctrl->write_count);
+    TEST_ASSERT_EQUAL(10, codec_ctrl->reg[MY_CODEC_REG_VOL]);
+    TEST_ASSERT_EQUAL(0, codec_ctrl->reg[MY_CODEC_REG_MUTE]);
+    TEST_ASSERT_EQUAL(20, codec_ctrl->reg[MY_CODEC_REG_MIC_GAIN]);
+
+    // Cache forwards only changed registers, keeping order
+    audio_codec_cache_cfg_t cache_cfg = {
+        .ctrl_if = ctrl_if,
+        .reg_num = MY_CODEC_REG_MAX,
+        .reset_reg = -1,
+    };
+    const audio_codec_ctrl_if_t *cache_if = audio_codec_new_cache_ctrl(&cache_cfg);
+    TEST_ASSERT_NOT_NULL(cache_if);
+    TEST_ESP_OK(audio_codec_ctrl_write_regs(cache_if, 1, regs, num));
+    TEST_ASSERT_EQUAL(8, codec_ctrl->write_count);
+    TEST_ESP_OK(audio_codec_ctrl_write_regs(cache_if, 1, regs, num));
+    TEST_ASSERT_EQUAL(10, codec_ctrl->write_count);
+    TEST_ASSERT_EQUAL(0, codec_ctrl->reg[MY_CODEC_REG_MUTE]);
+
+    audio_codec_delete_ctrl_if(cache_if);
+    audio_codec_delete_ctrl_if(ctrl_if);
+}
+
+TEST_CASE("esp codec dev register cache codec preset test", "[esp_codec_dev]")
+{
+    const audio_codec_ctrl_if_t *ctrl_if = my_codec_ctrl_new();
+    TEST_ASSERT_NOT_NULL(ctrl_if);
+    my_codec_ctrl_t *codec_ctrl = (my_codec_ctrl_t *) ctrl_if;
+    const audio_codec_ctrl_if_t *cache_if = audio_codec_new_codec_cache_ctrl(ctrl_if, AUDIO_CODEC_CACHE_ES8311);
+    TEST_ASSERT_NOT_NULL(cache_if);
+
+    // Settings are cached, the flag and chip id registers always go to the bus
+    uint8_t regv = 0;
+    TEST_ESP_OK(cache_if->read_reg(cache_if, MY_CODEC_REG_VOL, 1, &regv, 1));
+    TEST_ESP_OK(cache_if->read_reg(cache_if, MY_CODEC_REG_VOL, 1, &regv, 1));
+    TEST_ASSERT_EQUAL(1, codec_ctrl->read_count);
+    cache_if->read_reg(cache_if, 0xFC, 1, &regv, 1);
+    cache_if->read_reg(cache_if, 0xFC, 1, &regv, 1);
+    cache_if->read_reg(cache_if, 0xFD, 1, &regv, 1);
+    TEST_ASSERT_EQUAL(4, codec_ctrl->read_count);
+
+    // Register 0 is also the state machine and master mode control, only its reset bits drop the cache
+    TEST_ESP_OK(cache_if->read_reg(cache_if, MY_CODEC_REG_MIC_GAIN, 1, &regv, 1));
+    regv = 0xC0;
+    TEST_ESP_OK(cache_if->write_reg(cache_if, 0, 1, &regv, 1));
+    TEST_ESP_OK(cache_if->read_reg(cache_if, 0, 1, &regv, 1));
+    TEST_ASSERT_EQUAL(0xC0, regv);
+    TEST_ESP_OK(cache_if->read_reg(cache_if, MY_CODEC_REG_MIC_GAIN, 1, &regv, 1));
+    TEST_ASSERT_EQUAL(5, codec_ctrl->read_count);
+    TEST_ASSERT_EQUAL(1, codec_ctrl->write_count);
+    regv = 0x1F;
+    TEST_ESP_OK(cache_if->write_reg(cache_if, 0, 1, &regv, 1));
+    TEST_ASSERT_EQUAL(2, codec_ctrl->write_count);
+    TEST_ESP_OK(cache_if->read_reg(cache_if, MY_CODEC_REG_MIC_GAIN, 1, &regv, 1));
+    TEST_ESP_OK(cache_if->read_reg(cache_if, 0, 1, &regv, 1));
+    TEST_ASSERT_EQUAL(7, codec_ctrl->read_count);
+
+    TEST_ASSERT_NULL(audio_codec_new_codec_cache_ctrl(ctrl_if, (audio_codec_cache_codec_t) 100));
+    audio_codec_delete_ctrl_if(cache_if);
+    audio_codec_delete_ctrl_if(ctrl_if);
+}
@@ -0,0 +1,168 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "audio_codec_reg_seq.h"
+#include "tas5805m_reg_cfg.h"
+#include "tas5805m_registers_seq.h"
+#include "tas5805m_registers_seq_single.h"
+
+#define BUS_LOG_MAX (4096)
+#define TAS5805M_PAGE_REG (0x00)
+#define TAS5805M_BOOK_REG (0x7f)
+
+/*
+ * Mock bus which logs every register write as an address and value pair,
+ * a multi-byte write counts as auto-increment writes
+ */
+typedef struct {
+    audio_codec_ctrl_if_t base;
+    uint8_t               log[BUS_LOG_MAX][2];
+    int                   log_num;
+    int                   transfers;
+    bool                  auto_inc;
+} bus_log_ctrl_t;
+
+static bool bus_log_is_open(const audio_codec_ctrl_if_t *ctrl)
+{
+    return true;
+}
+
+static int bus_log_write_reg(const audio_codec_ctrl_if_t *ctrl, int reg, int reg_len, void *data, int data_len)
+{
+    bus_log_ctrl_t *bus = (bus_log_ctrl_t *) ctrl;
+    bus->transfers++;
+    for (int i = 0; i < data_len; i++) {
+        if (bus->log_num >= BUS_LOG_MAX) {
+            return ESP_CODEC_DEV_WRITE_FAIL;
+        }
+        bus->log[bus->log_num][0] = (uint8_t) (reg + i);
+        bus->log[bus->log_num][1] = ((uint8_t *) data)[i];
+        bus->log_num++;
+    }
+    return ESP_CODEC_DEV_OK;
+}
+
+static int bus_log_write_regs(const audio_codec_ctrl_if_t *ctrl, int reg_len, const audio_codec_reg_val_t *regs, int num)
+{
+    bus_log_ctrl_t *bus = (bus_log_ctrl_t *) ctrl;
+    // Same framing as the I2C control, on a device which auto-increments a run of up to
+    // 32 consecutive registers shares one transfer
+    int run = 0;
+    for (int i = 0; i < num; i++) {
+        uint8_t v = regs[i].value;
+        bus_log_write_reg(ctrl, regs[i].reg, reg_len, &v, 1);
+        run = (i && bus->auto_inc && run < 32 && regs[i].reg == regs[i - 1].reg + 1) ? run + 1 : 1;
+        if (run > 1) {
+            bus->transfers--;
+        }
+    }
+    return ESP_CODEC_DEV_OK;
+}
+
+static bus_log_ctrl_t *bus_log_new(void)
+{
+    bus_log_ctrl_t *bus = (bus_log_ctrl_t *) calloc(1, sizeof(bus_log_ctrl_t));
+    TEST_ASSERT_NOT_NULL(bus);
+    bus->base.is_open = bus_log_is_open;
+    bus->base.write_reg = bus_log_write_reg;
+    bus->base.write_regs = bus_log_write_regs;
+    return bus;
+}
+
+/*
+ * Table interpreter the tas5805m driver used before, kept as reference
+ */
+static void replay_table(bus_log_ctrl_t *bus, const tas5805m_cfg_reg_t *conf_buf, int size)
+{
+    for (int i = 0; i < size; i++) {
+        switch (conf_buf[i].offset) {
+            case CFG_META_SWITCH:
+            case CFG_META_DELAY:
+                break;
+            case CFG_META_BURST:
+                bus_log_write_reg(&bus->base, conf_buf[i + 1].offset, 1, (uint8_t *) &conf_buf[i + 1].value,
+                                  conf_buf[i].value);
+                i += (conf_buf[i].value / 2) + 1;
+                break;
+            default: {
+                uint8_t v = conf_buf[i].value;
+                bus_log_write_reg(&bus->base, conf_buf[i].offset, 1, &v, 1);
+                break;
+            }
+        }
+    }
+}
+
+/*
+ * The generator drops selects of the page or book already current, remove them from the reference log too
+ */
+static void drop_reselects(bus_log_ctrl_t *bus)
+{
+    int page = -1, book = -1;
+    int n = 0;
+    for (int i = 0; i < bus->log_num; i++) {
+        uint8_t reg = bus->log[i][0], v = bus->log[i][1];
+        if (reg == TAS5805M_PAGE_REG) {
+            if (v == page) {
+                continue;
+            }
+            page = v;
+        } else if (reg == TAS5805M_BOOK_REG && page == 0) {
+            if (v == book) {
+                continue;
+            }
+            book = v;
+        }
+        memmove(bus->log[n++], bus->log[i], 2);
+    }
+    bus->log_num = n;
+}
+
+TEST_CASE("esp codec dev register sequence replay test", "[esp_codec_dev]")
+{
+    (void) tas5805m_volume;
+    bus_log_ctrl_t *ref = bus_log_new();
+    replay_table(ref, tas5805m_registers, sizeof(tas5805m_registers) / sizeof(tas5805m_registers[0]));
+    int ref_writes = ref->log_num;
+    drop_reselects(ref);
+    TEST_ASSERT_LESS_THAN(ref_writes, ref->log_num);
+
+    // Generated with AUTO_INC, the control is set up the same way
+    bus_log_ctrl_t *bus = bus_log_new();
+    bus->auto_inc = true;
+    int ret = audio_codec_reg_seq_run(&bus->base, tas5805m_registers_seq, sizeof(tas5805m_registers_seq));
+    TEST_ESP_OK(ret);
+    TEST_ASSERT_EQUAL(ref->log_num, bus->log_num);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(ref->log, bus->log, ref->log_num * 2);
+    // Compiled sequence is smaller and needs far fewer bus transfers
+    TEST_ASSERT_LESS_THAN(sizeof(tas5805m_registers), sizeof(tas5805m_registers_seq));
+    TEST_ASSERT_LESS_THAN(ref->transfers / 4, bus->transfers);
+    printf("tas5805m table %d bytes %d transfers, sequence %d bytes %d transfers\n",
+           (int) sizeof(tas5805m_registers), ref->transfers, (int) sizeof(tas5805m_registers_seq), bus->transfers);
+    free(bus);
+
+    // Generated without AUTO_INC, a control which does not auto-increment writes each register alone
+    bus = bus_log_new();
+    ret = audio_codec_reg_seq_run(&bus->base, tas5805m_registers_seq_single, sizeof(tas5805m_registers_seq_single));
+    TEST_ESP_OK(ret);
+    TEST_ASSERT_EQUAL(ref->log_num, bus->log_num);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(ref->log, bus->log, ref->log_num * 2);
+    TEST_ASSERT_EQUAL(bus->log_num, bus->transfers);
+    printf("tas5805m sequence without auto-increment %d bytes %d transfers\n",
+           (int) sizeof(tas5805m_registers_seq_single), bus->transfers);
+    free(ref);
+    free(bus);
+
+    // Truncated or unterminated sequence is rejected
+    const uint8_t bad_seq[] = {AUDIO_CODEC_SEQ_OP_WRITE | 1, 0x10, 0x01};
+    bus = bus_log_new();
+    TEST_ASSERT_NOT_EQUAL(ESP_CODEC_DEV_OK, audio_codec_reg_seq_run(&bus->base, bad_seq, sizeof(bad_seq)));
+    TEST_ASSERT_EQUAL(0, bus->log_num);
+    const uint8_t open_seq[] = {AUDIO_CODEC_SEQ_OP_BURST | 1, 0x10, 0x01, 0x02};
+    TEST_ASSERT_NOT_EQUAL(ESP_CODEC_DEV_OK, audio_codec_reg_seq_run(&bus->base, open_seq, sizeof(open_seq)));
+    free(bus);
+}
@@ -0,0 +1,332 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+"""
+Compile a codec register table into the bytecode run by `audio_codec_reg_seq_run`.
+
+The input is a C header holding a table of `{offset, value}` pairs in the layout
+used by `tas5805m_reg_cfg.h`, including the `CFG_META_DELAY`, `CFG_META_BURST`
+and `CFG_META_SWITCH` entries. With `--auto-inc`, for devices which increment the
+register address after each data byte, runs of writes to consecutive registers
+become one burst. All other writes, and every write of a device without
+auto-increment, are packed into write groups. Registers given by `--no-burst`
+(page and book select) always stay single writes, so a burst never crosses a
+page switch. With `--page-reg` and `--book-reg` the current page and book are
+tracked through the table and selects of the one already current are dropped.
+The book register only exists on page 0, and a device reset written by the
+table is expected on page 0 of book 0, where it leaves both unchanged.
+
+Opcodes, see `audio_codec_reg_seq.h`:
+    0b00nnnnnn reg val ...     n + 1 register writes
+    0b01nnnnnn reg data ...    burst of n + 1 bytes from reg, auto increment
+    0b10hhhhhh llllllll        delay of (h << 8 | l) ms
+    0xff                       end
+"""
+
+import argparse
+import re
+import sys
+
+OP_WRITE = 0x00
+OP_BURST = 0x40
+OP_DELAY = 0x80
+OP_END = 0xFF
+GROUP_MAX = 64
+DELAY_MAX = 0x3FFF
+
+
+class TableError(Exception):
+    pass
+
+
+def strip_comments(text):
+    text = re.sub(r'/\*.*?\*/', lambda m: '\n' * m.group(0).count('\n'), text, flags=re.S)
+    return re.sub(r'//[^\n]*', '', text)
+
+
+def preprocess(text, defines):
+    """Resolve the simple conditionals found in vendor tables"""
+    out = []
+    stack = []
+    active = True
+    for line in text.split('\n'):
+        s = line.strip()
+        m = re.match(r'#\s*(if|ifdef|ifndef|elif|else|endif)\b(.*)', s)
+        if m is None:
+            if active:
+                out.append(line)
+            continue
+        kind, arg = m.group(1), m.group(2).strip()
+        if kind in ('if', 'ifdef', 'ifndef'):
+            if kind == 'if':
+                cond = eval_cond(arg, defines)
+            elif kind == 'ifdef':
+                cond = arg in defines
+            else:
+                cond = arg not in defines
+            stack.append((active, cond))
+            active = active and cond
+        elif kind == 'elif':
+            if not stack:
+                raise TableError('#elif without #if')
+            parent, taken = stack[-1]
+            cond = not taken and eval_cond(arg, defines)
+            stack[-1] = (parent, taken or cond)
+            active = parent and cond
+        elif kind == 'else':
+            if not stack:
+                raise TableError('#else without #if')
+            parent, taken = stack[-1]
+            active = parent and not taken
+        else:
+            if not stack:
+                raise TableError('#endif without #if')
+            active = stack.pop()[0]
+    return '\n'.join(out)
+
+
+def eval_cond(arg, defines):
+    m = re.fullmatch(r'defined\s*\(?\s*(\w+)\s*\)?', arg)
+    if m:
+        return m.group(1) in defines
+    try:
+        return int(defines.get(arg, arg), 0) != 0
+    except ValueError:
+        raise TableError('unsupported condition: #if %s' % arg)
+
+
+def parse_defines(text):
+    defines = {}
+    for m in re.finditer(r'#\s*define\s+(\w+)\s+\(?\s*(0[xX][0-9a-fA-F]+|\d+)\s*\)?', text):
+        defines[m.group(1)] = int(m.group(2), 0)
+    return defines
+
+
+def parse_table(path, name, cmd_defines):
+    with open(path) as f:
+        text = strip_comments(f.read())
+    consts = parse_defines(text)
+    body = preprocess(text, cmd_defines)
+    m = re.search(r'\b%s\s*\[\s*\]\s*=\s*\{(.*?)\n\s*\}\s*;' % re.escape(name), body, flags=re.S)
+    if m is None:
+        raise TableError('table %s not found in %s' % (name, path))
+    entries = []
+    for a, b in re.findall(r'\{\s*(\w+)\s*,\s*(\w+)\s*\}', m.group(1)):
+        entries.append((resolve(a, consts), resolve(b, consts)))
+    return entries, consts
+
+
+def resolve(token, consts):
+    if token in consts:
+        return consts[token]
+    try:
+        v = int(token, 0)
+    except ValueError:
+        raise TableError('unknown symbol %s' % token)
+    if not 0 <= v <= 0xFF:
+        raise TableError('value out of range: %s' % token)
+    return v
+
+
+def expand(entries, consts):
+    """Table to ops as the runtime interpreter of the table sees them:
+    ('w', reg, [bytes]) for one bus write, ('d', ms) for a delay"""
+    meta_switch = consts.get('CFG_META_SWITCH', 255)
+    meta_delay = consts.get('CFG_META_DELAY', 254)
+    meta_burst = consts.get('CFG_META_BURST', 253)
+    ops = []
+    i = 0
+    while i < len(entries):
+        off, val = entries[i]
+        if off == meta_switch:
+            pass
+        elif off == meta_delay:
+            ops.append(('d', val))
+        elif off == meta_burst:
+            # Data starts at the value of the next entry and runs over following pairs
+            raw = [b for e in entries[i + 1:] for b in e]
+            if len(raw) < val + 1:
+                raise TableError('burst at entry %d runs past the table' % i)
+            ops.append(('w', raw[0], raw[1:1 + val]))
+            i += val // 2 + 1
+        else:
+            ops.append(('w', off, [val]))
+        i += 1
+    return ops
+
+
+def register_stream(ops):
+    """Flatten to (reg, value) writes and delays, a burst writes consecutive registers"""
+    out = []
+    for op in ops:
+        if op[0] == 'd':
+            out.append(('d', op[1]))
+        else:
+            out.extend(('w', op[1] + k, v) for k, v in enumerate(op[2]))
+    return out
+
+
+def drop_reselects(stream, page_reg, book_reg):
+    """Remove page and book selects which select the current page or book"""
+    out = []
+    page = book = None
+    for item in stream:
+        if item[0] == 'w':
+            reg, v = item[1], item[2]
+            if reg == page_reg:
+                if v == page:
+                    continue
+                page = v
+            elif reg == book_reg and page == 0:
+                if v == book:
+                    continue
+                book = v
+        out.append(item)
+    return out
+
+
+def compile_stream(stream, no_burst, min_burst):
+    code = bytearray()
+    group = []
+
+    def flush_group():
+        while group:
+            part = group[:GROUP_MAX]
+            del group[:GROUP_MAX]
+            code.append(OP_WRITE | (len(part) - 1))
+            for reg, v in part:
+                code.extend((reg, v))
+
+    i = 0
+    while i < len(stream):
+        item = stream[i]
+        if item[0] == 'd':
+            flush_group()
+            ms = item[1]
+            while True:
+                step = min(ms, DELAY_MAX)
+                code += bytes((OP_DELAY | (step >> 8), step & 0xFF))
+                ms -= step
+                if ms == 0:
+                    break
+            i += 1
+            continue
+        reg = item[1]
+        run = 1
+        if reg not in no_burst:
+            while (i + run < len(stream) and run < GROUP_MAX and stream[i + run][0] == 'w'
+                   and stream[i + run][1] == reg + run and stream[i + run][1] not in no_burst
+                   and stream[i + run][1] <= 0xFF):
+                run += 1
+        if run >= min_burst:
+            flush_group()
+            code += bytes((OP_BURST | (run - 1), reg))
+            code += bytes(stream[i + k][2] for k in range(run))
+        else:
+            group.extend((stream[i + k][1], stream[i + k][2]) for k in range(run))
+        i += run
+    flush_group()
+    code.append(OP_END)
+    return bytes(code)
+
+
+def decode(code):
+    """Bytecode back to register stream, used to verify the output"""
+    out = []
+    i = 0
+    while True:
+        op = code[i]
+        if op == OP_END:
+            return out, i + 1
+        kind, n = op & 0xC0, (op & 0x3F) + 1
+        if kind == OP_WRITE:
+            for k in range(n):
+                out.append(('w', code[i + 1 + 2 * k], code[i + 2 + 2 * k]))
+            i += 1 + 2 * n
+        elif kind == OP_BURST:
+            reg = code[i + 1]
+            out.extend(('w', reg + k, code[i + 2 + k]) for k in range(n))
+            i += 2 + n
+        elif kind == OP_DELAY:
+            out.append(('d', ((op & 0x3F) << 8) | code[i + 1]))
+            i += 2
+        else:
+            raise TableError('bad opcode 0x%02x at %d' % (op, i))
+
+
+def merge_delays(stream):
+    out = []
+    for item in stream:
+        if item[0] == 'd' and out and out[-1][0] == 'd':
+            out[-1] = ('d', out[-1][1] + item[1])
+        else:
+            out.append(item)
+    return out
+
+
+def emit_header(code, name, source, entries, bursts):
+    guard = '_%s_H_' % name.upper()
+    lines = [
+        '/*',
+        ' * Generated by gen_reg_seq.py from %s, do not edit' % source,
+        ' * %d table entries (%d bytes) compiled to %d bytes, %d bursts' % (len(entries), 2 * len(entries), len(code), bursts),
+        ' */',
+        '#ifndef %s' % guard,
+        '#define %s' % guard,
+        '',
+        '#include <stdint.h>',
+        '',
+        'static const uint8_t %s[] = {' % name,
+    ]
+    for i in range(0, len(code), 16):
+        lines.append('    ' + ', '.join('0x%02x' % b for b in code[i:i + 16]) + ',')
+    lines += ['};', '', '#endif', '']
+    return '\n'.join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('header', help='C header holding the register table')
+    parser.add_argument('table', help='Table variable name, e.g. tas5805m_registers')
+    parser.add_argument('-o', '--output', required=True, help='Generated header')
+    parser.add_argument('-n', '--name', help='Bytecode array name, default <table>_seq')
+    parser.add_argument('--auto-inc', action='store_true', help='Device auto-increments, emit bursts')
+    parser.add_argument('--no-burst', default='', help='Comma separated registers never merged into a burst')
+    parser.add_argument('--page-reg', type=lambda x: int(x, 0), help='Page select register, drop repeated selects')
+    parser.add_argument('--book-reg', type=lambda x: int(x, 0), help='Book select register on page 0, drop repeated selects')
+    parser.add_argument('--min-burst', type=int, default=3, help='Shortest run written as a burst')
+    parser.add_argument('-D', dest='defines', action='append', default=[], help='Macro for #if/#ifdef, NAME or NAME=VALUE')
+    args = parser.parse_args()
+
+    defines = {}
+    for d in args.defines:
+        k, _, v = d.partition('=')
+        defines[k] = v or '1'
+    no_burst = {int(x, 0) for x in args.no_burst.split(',') if x.strip()}
+    try:
+        entries, consts = parse_table(args.header, args.table, defines)
+        ops = expand(entries, consts)
+        # A device without auto-increment takes every register as its own write
+        min_burst = max(args.min_burst, 2) if args.auto_inc else GROUP_MAX + 1
+        stream = drop_reselects(register_stream(ops), args.page_reg, args.book_reg)
+        code = compile_stream(stream, no_burst, min_burst)
+        decoded, size = decode(code)
+        if size != len(code) or merge_delays(decoded) != merge_delays(stream):
+            raise TableError('bytecode does not replay the table')
+    except TableError as e:
+        sys.exit('%s: %s' % (args.header, e))
+    bursts = sum(1 for i in iter_ops(code) if code[i] & 0xC0 == OP_BURST)
+    with open(args.output, 'w') as f:
+        f.write(emit_header(code, args.name or args.table + '_seq', args.header.split('/')[-1], entries, bursts))
+
+
+def iter_ops(code):
+    i = 0
+    while code[i] != OP_END:
+        yield i
+        op = code[i]
+        n = (op & 0x3F) + 1
+        i += {OP_WRITE: 1 + 2 * n, OP_BURST: 2 + n, OP_DELAY: 2}[op & 0xC0]
+
+
+if __name__ == '__main__':
+    main()
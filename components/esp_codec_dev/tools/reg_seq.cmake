@@ -0,0 +1,38 @@
+# Compile a codec register table into bytecode for `audio_codec_reg_seq_run`
+#
+# reg_seq_generate(<target> <header> <table> [AUTO_INC] [NO_BURST <regs>] [PAGE_REG <reg>] [BOOK_REG <reg>]
+#                  [NAME <name>])
+#   Generates `<name>.h` holding `static const uint8_t <name>[]` in the binary dir
+#   and adds it to the private include path of <target>
+#   AUTO_INC: device increments the register address after each data byte, consecutive writes become bursts
+#   NO_BURST: comma separated registers never merged into a burst, e.g. page and book select
+#   PAGE_REG, BOOK_REG: page and book select registers, selects of the current page or book are dropped
+#   NAME: bytecode array name, default `<table>_seq`
+set(REG_SEQ_GEN ${CMAKE_CURRENT_LIST_DIR}/gen_reg_seq.py)
+
+function(reg_seq_generate target header table)
+    cmake_parse_arguments(SEQ "AUTO_INC" "NO_BURST;PAGE_REG;BOOK_REG;NAME" "" ${ARGN})
+    idf_build_get_property(python PYTHON)
+    if(NOT SEQ_NAME)
+        set(SEQ_NAME ${table}_seq)
+    endif()
+    set(output ${CMAKE_CURRENT_BINARY_DIR}/${SEQ_NAME}.h)
+    set(flags --no-burst=${SEQ_NO_BURST} -n ${SEQ_NAME})
+    if(SEQ_AUTO_INC)
+        list(APPEND flags --auto-inc)
+    endif()
+    if(DEFINED SEQ_PAGE_REG)
+        list(APPEND flags --page-reg=${SEQ_PAGE_REG})
+    endif()
+    if(DEFINED SEQ_BOOK_REG)
+        list(APPEND flags --book-reg=${SEQ_BOOK_REG})
+    endif()
+    add_custom_command(OUTPUT ${output}
+                       COMMAND ${python} ${REG_SEQ_GEN} ${header} ${table} -o ${output} ${flags}
+                       DEPENDS ${header} ${REG_SEQ_GEN}
+                       COMMENT "Compiling register table ${table}"
+                       VERBATIM)
+    add_custom_target(${SEQ_NAME}_${target} DEPENDS ${output})
+    add_dependencies(${target} ${SEQ_NAME}_${target})
+    target_include_directories(${target} PRIVATE ${CMAKE_CURRENT_BINARY_DIR})
+endfunction()
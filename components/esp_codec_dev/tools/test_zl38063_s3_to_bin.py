@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+"""
+Host round-trip test for zl38063_s3_to_bin.py, run by `python3 -m unittest` inside tools
+"""
+
+import random
+import unittest
+
+import zl38063_s3_to_bin as conv
+
+
+def s_record(rec_type, addr, data=b''):
+    raw = bytes([len(data) + 5]) + addr.to_bytes(4, 'big') + data
+    return 'S%d%s%02X' % (rec_type, raw.hex().upper(), 0xFF - (sum(raw) & 0xFF))
+
+
+def make_s3(segments, exec_addr, line_bytes=32):
+    lines = ['S0030000FC']
+    for addr, data in segments:
+        for pos in range(0, len(data), line_bytes):
+            lines.append(s_record(3, addr + pos, data[pos:pos + line_bytes]))
+    lines.append(s_record(7, exec_addr))
+    return [line + '\n' for line in lines]
+
+
+class TestS3ToBin(unittest.TestCase):
+
+    def setUp(self):
+        rnd = random.Random(38063)
+        # Segments touch, skip gaps and cross 256 bytes windows
+        self.segments = [
+            (0x20000, bytes(rnd.getrandbits(8) for _ in range(1000))),
+            (0x20000 + 1000, bytes(rnd.getrandbits(8) for _ in range(96))),
+            (0x280F0, bytes(rnd.getrandbits(8) for _ in range(34))),
+            (0x300FE, bytes(rnd.getrandbits(8) for _ in range(2))),
+        ]
+        self.lines = make_s3(self.segments, 0x20010)
+
+    def test_round_trip(self):
+        for max_words in (1, 7, 64, conv.MAX_WORDS):
+            image = conv.convert(self.lines, max_words)
+            memory, exec_addr, prgm_base = conv.parse_image(image)
+            self.assertEqual(exec_addr, 0x20010)
+            self.assertEqual(prgm_base, 0x20000)
+            self.assertEqual(memory, {
+                0x20000: self.segments[0][1] + self.segments[1][1],
+                0x280F0: self.segments[2][1],
+                0x300FE: self.segments[3][1],
+            })
+
+    def test_block_layout(self):
+        image = conv.convert(self.lines)
+        body = image[conv.HEADER.size:]
+        pos = 0
+        while pos < len(body):
+            addr, words, _ = conv.BLOCK.unpack_from(body, pos)
+            self.assertLessEqual(words, conv.MAX_WORDS)
+            self.assertLessEqual(addr % conv.WINDOW_SIZE + words * 2, conv.WINDOW_SIZE)
+            pos += conv.BLOCK.size + ((words * 2 + 3) & ~3)
+            self.assertEqual(pos % 4, 0)
+        # Far fewer SPI bursts than S3 lines
+        block_num = conv.HEADER.unpack_from(image)[3]
+        self.assertLess(block_num * 3, len(self.lines))
+
+    def test_corrupt_image(self):
+        image = bytearray(conv.convert(self.lines))
+        image[conv.HEADER.size + 20] ^= 0x01
+        with self.assertRaises(conv.ImageError):
+            conv.parse_image(bytes(image))
+        with self.assertRaises(conv.ImageError):
+            conv.parse_image(bytes(image[:-4]))
+
+    def test_bad_s3(self):
+        bad_sum = list(self.lines)
+        bad_sum[1] = bad_sum[1][:-3] + '00\n'
+        no_exec = self.lines[:-1]
+        odd = make_s3([(0x20000, b'\x01\x02\x03')], 0x20000)
+        overlap = make_s3([(0x20000, bytes(8)), (0x20004, bytes(8))], 0x20000)
+        for lines in (bad_sum, no_exec, odd, overlap):
+            with self.assertRaises(conv.ImageError):
+                conv.convert(lines)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+"""
+Convert a ZL38063 `*.s3` firmware into the packed image booted by `VprocTwolfHbiBootImage`.
+
+The S3 text is parsed and checked on the host once, the image keeps the data in
+the byte order it goes out on SPI, so the device side only streams blocks.
+Contiguous records are merged into blocks which never cross a 256 bytes window of
+page 255 and hold at most `--max-words` words, one block is one HBI paged write.
+
+Image layout, all header fields little endian, see `vprocTwolf_access.h`:
+    header  magic 'ZLFW', version, flags, block number, execution address,
+            program base address, size of block area, CRC32 of block area
+    block   target address (u32), word number (u16), reserved (u16),
+            data words big endian, padded to 4 bytes
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+IMAGE_MAGIC = 0x57464C5A
+IMAGE_VERSION = 1
+IMAGE_FLAG_PRGM_BASE = 0x0001
+HEADER = struct.Struct('<IHHIIIII')
+BLOCK = struct.Struct('<IHH')
+WINDOW_SIZE = 256
+MAX_WORDS = 126
+
+
+class ImageError(Exception):
+    pass
+
+
+def parse_s3(lines):
+    """S3 text to ({address: data}, execution address, program base or None)"""
+    memory = {}
+    exec_addr = None
+    prgm_base = None
+    for num, line in enumerate(lines, 1):
+        line = line.strip()
+        if not line:
+            continue
+        if len(line) < 4 or line[0] != 'S':
+            raise ImageError('line %d: not a S-record' % num)
+        try:
+            raw = bytes.fromhex(line[2:])
+        except ValueError:
+            raise ImageError('line %d: bad hex digits' % num)
+        if len(raw) < 1 or raw[0] != len(raw) - 1:
+            raise ImageError('line %d: byte count mismatch' % num)
+        if (sum(raw[:-1]) + raw[-1]) & 0xFF != 0xFF:
+            raise ImageError('line %d: checksum mismatch' % num)
+        rec_type = line[1]
+        if rec_type == '3':
+            addr = int.from_bytes(raw[1:5], 'big')
+            data = raw[5:-1]
+            if addr & 1 or len(data) & 1:
+                raise ImageError('line %d: data is not word aligned' % num)
+            if prgm_base is None:
+                prgm_base = addr
+            memory[addr] = data
+        elif rec_type == '7':
+            exec_addr = int.from_bytes(raw[1:5], 'big')
+        elif rec_type in '0456':
+            continue
+        else:
+            raise ImageError('line %d: unsupported record S%s' % (num, rec_type))
+    if exec_addr is None:
+        raise ImageError('no S7 execution address record')
+    return merge_memory(memory), exec_addr, prgm_base
+
+
+def merge_memory(memory):
+    """Join touching segments, reject overlapping ones"""
+    merged = {}
+    end = None
+    start = None
+    for addr in sorted(memory):
+        data = memory[addr]
+        if end is not None and addr < end:
+            raise ImageError('data overlaps at 0x%08x' % addr)
+        if end == addr:
+            merged[start] += data
+        else:
+            start = addr
+            merged[start] = bytearray(data)
+        end = addr + len(data)
+    return {k: bytes(v) for k, v in merged.items()}
+
+
+def split_blocks(memory, max_words):
+    blocks = []
+    for addr in sorted(memory):
+        data = memory[addr]
+        pos = 0
+        while pos < len(data):
+            cur = addr + pos
+            room = WINDOW_SIZE - (cur % WINDOW_SIZE)
+            size = min(len(data) - pos, room, max_words * 2)
+            blocks.append((cur, data[pos:pos + size]))
+            pos += size
+    return blocks
+
+
+def build_image(memory, exec_addr, prgm_base=None, max_words=MAX_WORDS):
+    if not 1 <= max_words <= MAX_WORDS:
+        raise ImageError('words per block must be in 1..%d' % MAX_WORDS)
+    body = bytearray()
+    blocks = split_blocks(memory, max_words)
+    for addr, data in blocks:
+        body += BLOCK.pack(addr, len(data) // 2, 0)
+        body += data
+        body += bytes(-len(data) % 4)
+    flags = IMAGE_FLAG_PRGM_BASE if prgm_base is not None else 0
+    header = HEADER.pack(IMAGE_MAGIC, IMAGE_VERSION, flags, len(blocks), exec_addr, prgm_base or 0, len(body),
+                         zlib.crc32(body) & 0xFFFFFFFF)
+    return header + bytes(body)
+
+
+def parse_image(image):
+    """Image back to ({address: data}, execution address, program base or None)"""
+    if len(image) < HEADER.size:
+        raise ImageError('image too short')
+    magic, version, flags, block_num, exec_addr, prgm_base, size, crc = HEADER.unpack_from(image)
+    if magic != IMAGE_MAGIC or version != IMAGE_VERSION:
+        raise ImageError('not a zl38063 image')
+    body = image[HEADER.size:]
+    if len(body) != size:
+        raise ImageError('image size mismatch')
+    if zlib.crc32(body) & 0xFFFFFFFF != crc:
+        raise ImageError('image CRC mismatch')
+    memory = {}
+    pos = 0
+    for _ in range(block_num):
+        if pos + BLOCK.size > size:
+            raise ImageError('block header at %d runs past the image' % pos)
+        addr, words, _reserved = BLOCK.unpack_from(body, pos)
+        pos += BLOCK.size
+        if words == 0 or words > MAX_WORDS or (addr % WINDOW_SIZE) + words * 2 > WINDOW_SIZE:
+            raise ImageError('bad block at 0x%08x' % addr)
+        data = body[pos:pos + words * 2]
+        if len(data) != words * 2:
+            raise ImageError('block at 0x%08x runs past the image' % addr)
+        memory[addr] = data
+        pos += (words * 2 + 3) & ~3
+    if pos != size:
+        raise ImageError('trailing data after %d blocks' % block_num)
+    return merge_memory(memory), exec_addr, prgm_base if flags & IMAGE_FLAG_PRGM_BASE else None
+
+
+def convert(lines, max_words=MAX_WORDS):
+    memory, exec_addr, prgm_base = parse_s3(lines)
+    image = build_image(memory, exec_addr, prgm_base, max_words)
+    if parse_image(image) != (memory, exec_addr, prgm_base):
+        raise ImageError('image does not replay the S3 records')
+    return image
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('s3', help='Firmware in S3 format')
+    parser.add_argument('-o', '--output', required=True, help='Packed binary image')
+    parser.add_argument('--max-words', type=int, default=MAX_WORDS, help='Words per block, at most %d' % MAX_WORDS)
+    args = parser.parse_args()
+    try:
+        with open(args.s3) as f:
+            image = convert(f, args.max_words)
+    except ImageError as e:
+        sys.exit('%s: %s' % (args.s3, e))
+    with open(args.output, 'wb') as f:
+        f.write(image)
+    block_num = HEADER.unpack_from(image)[3]
+    print('%s: %d blocks, %d bytes' % (args.output, block_num, len(image)))
+
+
+if __name__ == '__main__':
+    main()
@@ -17,6 +17,7 @@
 
 #include "string.h"
 #include "bsp_board.h"
+#include "i2s_capture.h"
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
 #include "driver/i2s_std.h"
 #include "driver/i2s_tdm.h"
@@ -46,6 +47,7 @@ static int s_bits_per_chan = 16;
 
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
 static i2s_chan_handle_t                rx_handle = NULL;        // I2S rx channel handler
+static i2s_chan_handle_t                tx_handle = NULL;        // I2S0 amplifier, only with FUNC_I2S0_EN
 #endif
 
 static esp_err_t bsp_i2s_init(i2s_port_t i2s_num, uint32_t sample_rate, int channel_format, int bits_per_chan)
@@ -55,11 +57,14 @@ static esp_err_t bsp_i2s_init(i2s_port_t i2s_num, uint32_t sample_rate, int chan
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
     i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(i2s_num, I2S_ROLE_MASTER);
 
+    i2s_capture_cfg_t capture_cfg = I2S_CAPTURE_DEFAULT_CONFIG(16000, sizeof(int32_t));
+    ret_val |= i2s_capture_config(&capture_cfg, &chan_cfg);
     ret_val |= i2s_new_channel(&chan_cfg, NULL, &rx_handle);
     i2s_std_config_t std_cfg = I2S_CONFIG_DEFAULT(16000, I2S_SLOT_MODE_MONO, 32);
     std_cfg.slot_cfg.slot_mask = I2S_STD_SLOT_LEFT;
     // std_cfg.clk_cfg.mclk_multiple = EXAMPLE_MCLK_MULTIPLE;   //The default is I2S_MCLK_MULTIPLE_256. If not using 24-bit data width, 256 should be enough
     ret_val |= i2s_channel_init_std_mode(rx_handle, &std_cfg);
+    ret_val |= i2s_capture_attach(rx_handle);
     ret_val |= i2s_channel_enable(rx_handle);
 #else
     // i2s_config_t i2s_config = I2S_CONFIG_DEFAULT(16000, I2S_CHANNEL_FMT_ONLY_LEFT, 32);
@@ -80,6 +85,24 @@ static esp_err_t bsp_i2s_init(i2s_port_t i2s_num, uint32_t sample_rate, int chan
     return ret_val;
 }
 
+static esp_err_t bsp_i2s_play_init(uint32_t sample_rate)
+{
+    esp_err_t ret_val = ESP_OK;
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
+    chan_cfg.auto_clear = true; // Auto clear the legacy data in the DMA buffer
+    ret_val |= i2s_new_channel(&chan_cfg, &tx_handle, NULL);
+    i2s_std_config_t std_cfg = I2S0_CONFIG_DEFAULT(sample_rate, I2S_SLOT_MODE_MONO, 16);
+    ret_val |= i2s_channel_init_std_mode(tx_handle, &std_cfg);
+    ret_val |= i2s_channel_enable(tx_handle);
+#else
+    ret_val = ESP_ERR_NOT_SUPPORTED;
+#endif
+
+    return ret_val;
+}
+
 static esp_err_t bsp_i2s_deinit(i2s_port_t i2s_num)
 {
     esp_err_t ret_val = ESP_OK;
@@ -96,17 +119,9 @@ static esp_err_t bsp_i2s_deinit(i2s_port_t i2s_num)
     return ret_val;
 }
 
-esp_err_t bsp_get_feed_data(bool is_get_raw_channel, int16_t *buffer, int buffer_len)
+void bsp_feed_convert(int16_t *buffer, int buffer_len)
 {
-    esp_err_t ret = ESP_OK;
-    size_t bytes_read;
     int audio_chunksize = buffer_len / (sizeof(int32_t));
-#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
-    ret = i2s_channel_read(rx_handle, buffer, buffer_len, &bytes_read, portMAX_DELAY);
-#else
-    ret = i2s_read(I2S_NUM_1, buffer, buffer_len, &bytes_read, portMAX_DELAY);
-#endif
-
     int32_t *tmp_buff = (int32_t *)buffer;
     for (int i = 0; i < audio_chunksize; i++) {
         // 32:8 are valid bits, 8:0 are the lower 8 bits, all are 0. 
@@ -114,6 +129,18 @@ esp_err_t bsp_get_feed_data(bool is_get_raw_channel, int16_t *buffer, int buffer
         // and 29:13 bits are used to amplify the voice signal.
         tmp_buff[i] = tmp_buff[i] >> 14; 
     }
+}
+
+esp_err_t bsp_get_feed_data(bool is_get_raw_channel, int16_t *buffer, int buffer_len)
+{
+    esp_err_t ret = ESP_OK;
+    size_t bytes_read;
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    ret = i2s_channel_read(rx_handle, buffer, buffer_len, &bytes_read, portMAX_DELAY);
+#else
+    ret = i2s_read(I2S_NUM_1, buffer, buffer_len, &bytes_read, portMAX_DELAY);
+#endif
+    bsp_feed_convert(buffer, buffer_len);
 
     return ret;
 }
@@ -123,9 +150,27 @@ int bsp_get_feed_channel(void)
     return ADC_I2S_CHANNEL;
 }
 
+esp_err_t bsp_audio_play(const int16_t* data, int length, TickType_t ticks_to_wait)
+{
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    size_t bytes_write = 0;
+    if (!tx_handle) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return i2s_channel_write(tx_handle, data, length, &bytes_write, ticks_to_wait);
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
 esp_err_t bsp_board_init(audio_hal_iface_samples_t sample_rate, int channel_format, int bits_per_chan)
 {
     bsp_i2s_init(I2S_NUM_1, 16000, 2, 32);
+    if (FUNC_I2S0_EN) {
+        if (bsp_i2s_play_init(16000) != ESP_OK) {
+            ESP_LOGE(TAG, "I2S0 amplifier init failed");
+        }
+    }
 
     return ESP_OK;
 }
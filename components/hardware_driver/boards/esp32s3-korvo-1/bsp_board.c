@@ -17,6 +17,8 @@
 
 #include "string.h"
 #include "bsp_board.h"
+#include "i2s_capture.h"
+#include "audio_codec_ctrl_cache.h"
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
 #include "driver/i2s_std.h"
 #include "driver/i2s_tdm.h"
@@ -49,11 +51,13 @@ static i2s_chan_handle_t                rx_handle = NULL;        // I2S rx chann
 #endif
 static audio_codec_data_if_t *record_data_if = NULL;
 static audio_codec_ctrl_if_t *record_ctrl_if = NULL;
+static audio_codec_ctrl_if_t *record_i2c_if = NULL;
 static audio_codec_if_t *record_codec_if = NULL;
 static esp_codec_dev_handle_t record_dev = NULL;
 
 static audio_codec_data_if_t *play_data_if = NULL;
 static audio_codec_ctrl_if_t *play_ctrl_if = NULL;
+static audio_codec_ctrl_if_t *play_i2c_if = NULL;
 static audio_codec_gpio_if_t *play_gpio_if = NULL;
 static audio_codec_if_t *play_codec_if = NULL;
 static esp_codec_dev_handle_t play_dev = NULL;
@@ -90,8 +94,9 @@ esp_err_t bsp_codec_adc_init(int sample_rate)
     };
     record_data_if = audio_codec_new_i2s_data(&i2s_cfg);
 
-    audio_codec_i2c_cfg_t i2c_cfg = {.addr = ES7210_CODEC_DEFAULT_ADDR};
-    record_ctrl_if = audio_codec_new_i2c_ctrl(&i2c_cfg);
+    audio_codec_i2c_cfg_t i2c_cfg = {.addr = ES7210_CODEC_DEFAULT_ADDR, .auto_inc = true};
+    record_i2c_if = audio_codec_new_i2c_ctrl(&i2c_cfg);
+    record_ctrl_if = audio_codec_new_codec_cache_ctrl(record_i2c_if, AUDIO_CODEC_CACHE_ES7210);
     // New input codec interface
     es7210_codec_cfg_t es7210_cfg = {
         .ctrl_if = record_ctrl_if,
@@ -135,8 +140,9 @@ esp_err_t bsp_codec_dac_init(int sample_rate, int channel_format, int bits_per_c
     };
     play_data_if = audio_codec_new_i2s_data(&i2s_cfg);
 
-    audio_codec_i2c_cfg_t i2c_cfg = {.addr = ES8311_CODEC_DEFAULT_ADDR};
-    play_ctrl_if = audio_codec_new_i2c_ctrl(&i2c_cfg);
+    audio_codec_i2c_cfg_t i2c_cfg = {.addr = ES8311_CODEC_DEFAULT_ADDR, .auto_inc = true};
+    play_i2c_if = audio_codec_new_i2c_ctrl(&i2c_cfg);
+    play_ctrl_if = audio_codec_new_codec_cache_ctrl(play_i2c_if, AUDIO_CODEC_CACHE_ES8311);
     play_gpio_if = audio_codec_new_gpio();
     // New output codec interface
     es8311_codec_cfg_t es8311_cfg = {
@@ -187,6 +193,10 @@ static esp_err_t bsp_codec_adc_deinit()
         audio_codec_delete_ctrl_if(record_ctrl_if);
         record_ctrl_if = NULL;
     }
+    if (record_i2c_if) {
+        audio_codec_delete_ctrl_if(record_i2c_if);
+        record_i2c_if = NULL;
+    }
     
     // Delete codec data interface
     if (record_data_if) {
@@ -218,6 +228,10 @@ static esp_err_t bsp_codec_dac_deinit()
         audio_codec_delete_ctrl_if(play_ctrl_if);
         play_ctrl_if = NULL;
     }
+    if (play_i2c_if) {
+        audio_codec_delete_ctrl_if(play_i2c_if);
+        play_i2c_if = NULL;
+    }
     
     if (play_gpio_if) {
         audio_codec_delete_gpio_if(play_gpio_if);
@@ -278,9 +292,12 @@ static esp_err_t bsp_i2s_init(i2s_port_t i2s_num, uint32_t sample_rate, int chan
     i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(i2s_num, I2S_ROLE_MASTER);
 
     if (i2s_num == I2S_NUM_1) {
+        i2s_capture_cfg_t capture_cfg = I2S_CAPTURE_DEFAULT_CONFIG(sample_rate, (channel_fmt == I2S_SLOT_MODE_STEREO ? 2 : 1) * bits_per_chan / 8);
+        ret_val |= i2s_capture_config(&capture_cfg, &chan_cfg);
         ret_val |= i2s_new_channel(&chan_cfg, NULL, &rx_handle);
         i2s_std_config_t std_cfg = I2S_CONFIG_DEFAULT(sample_rate, channel_fmt, bits_per_chan);
         ret_val |= i2s_channel_init_std_mode(rx_handle, &std_cfg);
+        ret_val |= i2s_capture_attach(rx_handle);
         ret_val |= i2s_channel_enable(rx_handle);
     } else if (i2s_num == I2S_NUM_0) {
         chan_cfg.auto_clear = true; // Auto clear the legacy data in the DMA buffer
@@ -115,6 +115,14 @@ esp_err_t bsp_get_feed_data(bool is_get_raw_channel, int16_t *buffer, int buffer
 
 int bsp_get_feed_channel(void);
 
+/**
+ * @brief Turn raw capture data into AFE feed samples in place, boards with I2S microphones only
+ * 
+ * @param buffer Raw data as read from the I2S rx channel
+ * @param buffer_len The buffer length in bytes.
+ */
+void bsp_feed_convert(int16_t *buffer, int buffer_len);
+
 /**
  * @brief Set play volume
  * 
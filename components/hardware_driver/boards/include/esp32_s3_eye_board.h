@@ -87,6 +87,23 @@
 
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
 
+#define I2S0_CONFIG_DEFAULT(sample_rate, channel_fmt, bits_per_chan) { \
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(sample_rate), \
+        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(bits_per_chan, channel_fmt), \
+        .gpio_cfg = { \
+            .mclk = GPIO_I2S0_MCLK, \
+            .bclk = GPIO_I2S0_SCLK, \
+            .ws   = GPIO_I2S0_LRCK, \
+            .dout = GPIO_I2S0_DOUT, \
+            .din  = GPIO_I2S0_SDIN, \
+            .invert_flags = { \
+                .mclk_inv = false, \
+                .bclk_inv = false, \
+                .ws_inv   = false, \
+            }, \
+        }, \
+    }
+
 #define I2S_CONFIG_DEFAULT(sample_rate, channel_fmt, bits_per_chan) { \
         .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(sample_rate), \
         .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(bits_per_chan, channel_fmt), \
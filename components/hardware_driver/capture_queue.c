@@ -0,0 +1,68 @@
+#include <string.h>
+#include "capture_queue.h"
+
+void capture_queue_init(capture_queue_t *q, uint32_t dma_buf_num)
+{
+    memset(q, 0, sizeof(*q));
+    q->dma_buf_num = dma_buf_num;
+    q->capacity = dma_buf_num > 2 ? dma_buf_num - 2 : 1;
+    if (q->capacity > CAPTURE_QUEUE_MAX) {
+        q->capacity = CAPTURE_QUEUE_MAX;
+    }
+}
+
+bool capture_queue_push(capture_queue_t *q, void *buf, uint32_t size, int64_t time_us)
+{
+    uint32_t seq = atomic_fetch_add_explicit(&q->completed, 1, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    if (head - tail >= q->capacity) {
+        atomic_fetch_add_explicit(&q->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+    capture_frame_t *f = &q->slots[head % CAPTURE_QUEUE_MAX];
+    f->buf = buf;
+    f->size = size;
+    f->seq = seq;
+    f->time_us = time_us;
+    // publish the slot before the new head
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return true;
+}
+
+void capture_queue_skip(capture_queue_t *q)
+{
+    atomic_fetch_add_explicit(&q->completed, 1, memory_order_relaxed);
+}
+
+const capture_frame_t *capture_queue_front(capture_queue_t *q)
+{
+    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+    if (head == tail) {
+        return NULL;
+    }
+    return &q->slots[tail % CAPTURE_QUEUE_MAX];
+}
+
+bool capture_queue_release(capture_queue_t *q)
+{
+    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    if (atomic_load_explicit(&q->head, memory_order_acquire) == tail) {
+        return true;
+    }
+    // buffer `seq` is rewritten as buffer `seq + dma_buf_num`, DMA starts on it once the one before completed
+    uint32_t seq = q->slots[tail % CAPTURE_QUEUE_MAX].seq;
+    uint32_t completed = atomic_load_explicit(&q->completed, memory_order_acquire);
+    bool intact = completed - seq < q->dma_buf_num;
+    if (!intact) {
+        atomic_fetch_add_explicit(&q->late, 1, memory_order_relaxed);
+    }
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return intact;
+}
+
+uint32_t capture_queue_count(capture_queue_t *q)
+{
+    return atomic_load_explicit(&q->head, memory_order_acquire) - atomic_load_explicit(&q->tail, memory_order_acquire);
+}
@@ -16,17 +16,28 @@
  */
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include "bsp_board.h"
 #include "esp_err.h"
+#include "esp_log.h"
 #include "esp_vfs_fat.h"
 #include "sdmmc_cmd.h"
 #include "esp_board_init.h"
+#include "i2s_capture.h"
+#include "play_ref.h"
 
 static const char *TAG = "hardware";
 
 esp_err_t esp_board_init(audio_hal_iface_samples_t sample_rate, int channel_format, int bits_per_chan)
 {
+#if CONFIG_AUDIO_PLAY_REF
+    esp_err_t ret = play_ref_init(16000, CONFIG_AUDIO_PLAY_REF_MAX_DELAY_MS);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "playback reference init failed");
+        return ret;
+    }
+#endif
     return bsp_board_init(sample_rate, channel_format, bits_per_chan);
 }
 
@@ -40,9 +51,65 @@ esp_err_t esp_sdcard_deinit(char *mount_point)
     return bsp_sdcard_deinit(mount_point);
 }
 
+static void feed_fill_ref(int16_t *buffer, int buffer_len)
+{
+#if CONFIG_AUDIO_PLAY_REF
+    // the last feed channel carries no microphone on these boards, it becomes the reference
+    int channels = bsp_get_feed_channel();
+    play_ref_fill(buffer, channels, buffer_len / (channels * sizeof(int16_t)), 0, channels - 1);
+#endif
+}
+
 esp_err_t esp_get_feed_data(bool is_get_raw_channel, int16_t *buffer, int buffer_len)
 {
-    return bsp_get_feed_data(is_get_raw_channel, buffer, buffer_len);
+#if CONFIG_AUDIO_CAPTURE_CALLBACK
+    // nobody reads the driver queue in callback capture, copy out of the handed over buffer
+    int16_t *frame = NULL;
+    esp_err_t ret = esp_get_feed_frame(&frame, buffer_len, portMAX_DELAY);
+    if (ret == ESP_OK) {
+        memcpy(buffer, frame, buffer_len);
+        esp_release_feed_frame();
+    }
+    return ret;
+#else
+    esp_err_t ret = bsp_get_feed_data(is_get_raw_channel, buffer, buffer_len);
+    if (ret == ESP_OK) {
+        // the feed buffer holds 16 bit samples of every feed channel, one I2S frame per sample time
+        i2s_capture_read_done(buffer_len / (bsp_get_feed_channel() * sizeof(int16_t)));
+        feed_fill_ref(buffer, buffer_len);
+    }
+    return ret;
+#endif
+}
+
+esp_err_t esp_get_feed_frame(int16_t **buffer, int buffer_len, TickType_t ticks_to_wait)
+{
+#if CONFIG_AUDIO_CAPTURE_CALLBACK
+    void *buf = NULL;
+    size_t size = 0;
+    esp_err_t ret = i2s_capture_frame_take(&buf, &size, ticks_to_wait);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (size != buffer_len) {
+        ESP_LOGE(TAG, "DMA buffer of %d bytes, feed chunk of %d", (int)size, buffer_len);
+        i2s_capture_frame_release();
+        return ESP_ERR_INVALID_SIZE;
+    }
+    bsp_feed_convert(buf, buffer_len);
+    feed_fill_ref(buf, buffer_len);
+    *buffer = buf;
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void esp_release_feed_frame(void)
+{
+#if CONFIG_AUDIO_CAPTURE_CALLBACK
+    i2s_capture_frame_release();
+#endif
 }
 
 int esp_get_feed_channel(void)
@@ -52,7 +119,13 @@ int esp_get_feed_channel(void)
 
 esp_err_t esp_audio_play(const int16_t* data, int length, TickType_t ticks_to_wait)
 {
-    return bsp_audio_play(data, length, ticks_to_wait);
+    esp_err_t ret = bsp_audio_play(data, length, ticks_to_wait);
+#if CONFIG_AUDIO_PLAY_REF
+    if (ret == ESP_OK) {
+        play_ref_write(data, length / sizeof(int16_t));
+    }
+#endif
+    return ret;
 }
 
 esp_err_t esp_audio_set_play_vol(int volume)
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "i2s_capture.h"
+#include "capture_queue.h"
+
+#define DMA_DESC_MAX_BYTES  4092
+
+static const char *TAG = "MK39 Capture";
+
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static i2s_capture_stats_t stats;
+static uint32_t frame_bytes;
+static uint32_t sample_rate;
+static int64_t last_dma_us;
+static int64_t last_read_us;
+static uint64_t read_jitter_sum_us;
+
+// callback capture, the rx ISR queues DMA buffers for the task set on the first take
+static bool callback_mode;
+static capture_queue_t frame_queue;
+static TaskHandle_t volatile consumer;
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+esp_err_t i2s_capture_config(const i2s_capture_cfg_t *cfg, i2s_chan_config_t *chan_cfg)
+{
+    if (cfg->sample_rate == 0 || cfg->frame_bytes == 0 || cfg->chunk_frames == 0 || cfg->desc_per_chunk == 0 ||
+        cfg->chunks < 2 ||
+        cfg->chunk_frames % cfg->desc_per_chunk != 0 || (cfg->callback && cfg->desc_per_chunk != 1)) {
+        ESP_LOGE(TAG, "%lu frames do not split into %lu descriptors", (unsigned long)cfg->chunk_frames,
+                 (unsigned long)cfg->desc_per_chunk);
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t desc_frames = cfg->chunk_frames / cfg->desc_per_chunk;
+    if (desc_frames * cfg->frame_bytes > DMA_DESC_MAX_BYTES) {
+        ESP_LOGE(TAG, "descriptor of %lu bytes, at most %d", (unsigned long)(desc_frames * cfg->frame_bytes),
+                 DMA_DESC_MAX_BYTES);
+        return ESP_ERR_INVALID_ARG;
+    }
+    chan_cfg->dma_frame_num = desc_frames;
+    chan_cfg->dma_desc_num = cfg->desc_per_chunk * cfg->chunks;
+    if (cfg->callback && chan_cfg->dma_desc_num > CAPTURE_QUEUE_MAX + 2) {
+        ESP_LOGE(TAG, "callback capture queues at most %d buffers", CAPTURE_QUEUE_MAX);
+        return ESP_ERR_INVALID_ARG;
+    }
+    callback_mode = cfg->callback;
+    capture_queue_init(&frame_queue, chan_cfg->dma_desc_num);
+
+    portENTER_CRITICAL(&stats_lock);
+    frame_bytes = cfg->frame_bytes;
+    sample_rate = cfg->sample_rate;
+    stats.dma_period_us = (uint64_t)desc_frames * 1000000 / cfg->sample_rate;
+    stats.latency_us = (uint64_t)cfg->chunk_frames * cfg->chunks * 1000000 / cfg->sample_rate;
+    portEXIT_CRITICAL(&stats_lock);
+    ESP_LOGI(TAG, "%lu x %lu frame descriptors, %lu us per interrupt, %lu ms buffered%s",
+             (unsigned long)chan_cfg->dma_desc_num, (unsigned long)desc_frames, (unsigned long)stats.dma_period_us,
+             (unsigned long)(stats.latency_us / 1000), callback_mode ? ", callback capture" : "");
+    return ESP_OK;
+}
+
+static bool IRAM_ATTR capture_on_recv(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
+{
+    int64_t now_us = esp_timer_get_time();
+    portENTER_CRITICAL_ISR(&stats_lock);
+    if (last_dma_us != 0) {
+        int64_t dev = now_us - last_dma_us - stats.dma_period_us;
+        uint32_t jitter = dev < 0 ? -dev : dev;
+        if (jitter > stats.dma_jitter_max_us) {
+            stats.dma_jitter_max_us = jitter;
+        }
+    }
+    last_dma_us = now_us;
+    stats.dma_frames++;
+    portEXIT_CRITICAL_ISR(&stats_lock);
+
+    BaseType_t woken = pdFALSE;
+    if (callback_mode) {
+        TaskHandle_t task = consumer;
+        if (task == NULL) {
+            capture_queue_skip(&frame_queue);
+        } else if (capture_queue_push(&frame_queue, event->dma_buf, event->size, now_us)) {
+            vTaskNotifyGiveFromISR(task, &woken);
+        }
+    }
+    return woken == pdTRUE;
+}
+
+static bool IRAM_ATTR capture_on_recv_q_ovf(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
+{
+    // nobody drains the driver queue in callback capture, overruns are counted by frame_queue instead
+    if (callback_mode) {
+        return false;
+    }
+    portENTER_CRITICAL_ISR(&stats_lock);
+    stats.overruns++;
+    portEXIT_CRITICAL_ISR(&stats_lock);
+    return false;
+}
+
+esp_err_t i2s_capture_attach(i2s_chan_handle_t rx_handle)
+{
+    i2s_event_callbacks_t cbs = {
+        .on_recv = capture_on_recv,
+        .on_recv_q_ovf = capture_on_recv_q_ovf,
+    };
+    return i2s_channel_register_event_callback(rx_handle, &cbs, NULL);
+}
+#endif
+
+esp_err_t i2s_capture_frame_take(void **buf, size_t *size, TickType_t ticks_to_wait)
+{
+    if (!callback_mode) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (consumer == NULL) {
+        consumer = xTaskGetCurrentTaskHandle();
+    }
+    // every queued buffer carries exactly one notification, so the task wakes once per buffer
+    if (ulTaskNotifyTake(pdFALSE, ticks_to_wait) == 0) {
+        return ESP_ERR_TIMEOUT;
+    }
+    const capture_frame_t *frame = capture_queue_front(&frame_queue);
+    if (frame == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *buf = frame->buf;
+    *size = frame->size;
+    i2s_capture_read_done(frame->size / frame_bytes);
+    return ESP_OK;
+}
+
+bool i2s_capture_frame_release(void)
+{
+    return capture_queue_release(&frame_queue);
+}
+
+void i2s_capture_read_done(uint32_t frames)
+{
+    int64_t now_us = esp_timer_get_time();
+    portENTER_CRITICAL(&stats_lock);
+    if (last_read_us != 0 && sample_rate != 0) {
+        int64_t gap = now_us - last_read_us;
+        int64_t dev = gap - (int64_t)frames * 1000000 / sample_rate;
+        if (gap > stats.read_gap_max_us) {
+            stats.read_gap_max_us = gap;
+        }
+        read_jitter_sum_us += dev < 0 ? -dev : dev;
+        stats.read_jitter_avg_us = read_jitter_sum_us / stats.reads;
+    }
+    last_read_us = now_us;
+    stats.reads++;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+void i2s_capture_get_stats(i2s_capture_stats_t *out)
+{
+    portENTER_CRITICAL(&stats_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&stats_lock);
+    if (callback_mode) {
+        out->overruns = atomic_load(&frame_queue.dropped);
+        out->late = atomic_load(&frame_queue.late);
+    }
+}
+
+void i2s_capture_reset_stats(void)
+{
+    portENTER_CRITICAL(&stats_lock);
+    stats.dma_frames = 0;
+    stats.overruns = 0;
+    stats.dma_jitter_max_us = 0;
+    stats.reads = 0;
+    stats.read_gap_max_us = 0;
+    stats.read_jitter_avg_us = 0;
+    last_dma_us = 0;
+    last_read_us = 0;
+    read_jitter_sum_us = 0;
+    portEXIT_CRITICAL(&stats_lock);
+    atomic_store(&frame_queue.dropped, 0);
+    atomic_store(&frame_queue.late, 0);
+}
+
+void i2s_capture_print_stats(void)
+{
+    i2s_capture_stats_t s;
+    i2s_capture_get_stats(&s);
+    printf("capture: %lu dma buffers, %lu overruns, %lu late, dma jitter max %lu/%lu us, %lu reads, "
+           "read gap max %lu us, read jitter avg %lu us, %lu ms buffered\n",
+           (unsigned long)s.dma_frames, (unsigned long)s.overruns, (unsigned long)s.late, (unsigned long)s.dma_jitter_max_us,
+           (unsigned long)s.dma_period_us, (unsigned long)s.reads, (unsigned long)s.read_gap_max_us,
+           (unsigned long)s.read_jitter_avg_us, (unsigned long)(s.latency_us / 1000));
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAPTURE_QUEUE_MAX   (16)
+
+/**
+ * @brief A filled DMA buffer, owned by the consumer until released
+ */
+typedef struct {
+    void     *buf;          /*!< DMA buffer, valid until the DMA ring wraps around to it */
+    uint32_t  size;         /*!< Bytes */
+    uint32_t  seq;          /*!< Count of DMA buffers completed before this one, gaps mean drops */
+    int64_t   time_us;      /*!< Completion time */
+} capture_frame_t;
+
+/**
+ * @brief Single producer, single consumer queue handing DMA buffers from the rx ISR to the feed task
+ *
+ * Only pointers move, the ISR never copies audio. A buffer stays in the DMA ring while queued,
+ * so the consumer must release it before DMA comes back to it, `capture_queue_release` reports
+ * when it did not.
+ */
+typedef struct {
+    capture_frame_t  slots[CAPTURE_QUEUE_MAX];
+    atomic_uint      head;          /*!< Pushed frames, written by the producer */
+    atomic_uint      tail;          /*!< Released frames, written by the consumer */
+    atomic_uint      completed;     /*!< DMA buffers completed, pushed or dropped */
+    atomic_uint      dropped;       /*!< Buffers not queued because the consumer fell behind */
+    atomic_uint      late;          /*!< Buffers DMA started to rewrite before they were released */
+    uint32_t         capacity;
+    uint32_t         dma_buf_num;
+} capture_queue_t;
+
+/**
+ * @brief Reset the queue for a DMA ring of `dma_buf_num` buffers
+ *
+ * At most `dma_buf_num - 2` frames are queued: one buffer is being filled by DMA and the next
+ * one must be free when it finishes.
+ */
+void capture_queue_init(capture_queue_t *q, uint32_t dma_buf_num);
+
+/**
+ * @brief Producer side, called from the DMA completion ISR
+ *
+ * @return false when the queue is full and the buffer was dropped
+ */
+bool capture_queue_push(capture_queue_t *q, void *buf, uint32_t size, int64_t time_us);
+
+/**
+ * @brief Count a completed buffer without queuing it, while no consumer is attached
+ */
+void capture_queue_skip(capture_queue_t *q);
+
+/**
+ * @brief Consumer side, oldest queued frame or NULL when empty
+ */
+const capture_frame_t *capture_queue_front(capture_queue_t *q);
+
+/**
+ * @brief Consumer side, hand the front frame back to the DMA ring
+ *
+ * @return false when DMA had already started to overwrite the frame, its data may be torn
+ */
+bool capture_queue_release(capture_queue_t *q);
+
+/**
+ * @brief Queued frames, from either side
+ */
+uint32_t capture_queue_count(capture_queue_t *q);
+
+#ifdef __cplusplus
+}
+#endif
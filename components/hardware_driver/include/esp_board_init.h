@@ -79,6 +79,28 @@ esp_err_t esp_audio_play(const int16_t* data, int length, TickType_t ticks_to_wa
  */
 esp_err_t esp_get_feed_data(bool is_get_raw_channel, int16_t *buffer, int buffer_len);
 
+/**
+ * @brief Get the next record chunk without copying it, callback capture only.
+ * 
+ * The chunk is the DMA buffer itself, converted in place. Hand it back with
+ * esp_release_feed_frame before asking for the next one.
+ * 
+ * @param buffer Receives the chunk.
+ * @param buffer_len The chunk length, must match the DMA buffer.
+ * @param ticks_to_wait Time to wait for the chunk.
+ * @return
+ *    - ESP_OK                  Success
+ *    - ESP_ERR_TIMEOUT         No chunk in time
+ *    - ESP_ERR_INVALID_SIZE    DMA buffer does not hold one chunk
+ *    - ESP_ERR_NOT_SUPPORTED   Callback capture not enabled
+ */
+esp_err_t esp_get_feed_frame(int16_t **buffer, int buffer_len, TickType_t ticks_to_wait);
+
+/**
+ * @brief Return the chunk of esp_get_feed_frame to the capture DMA.
+ */
+void esp_release_feed_frame(void);
+
 int esp_get_feed_channel(void);
 
 /**
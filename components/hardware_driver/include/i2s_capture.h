@@ -0,0 +1,115 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "esp_idf_version.h"
+#include "freertos/FreeRTOS.h"
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include "driver/i2s_common.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief DMA geometry of the capture channel, in I2S frames (one sample of every slot)
+ *
+ * Buffered audio, and with it the worst case capture latency, is `chunk_frames * chunks`.
+ * More descriptors per chunk shorten the interrupt period without adding latency.
+ * Callback capture hands whole DMA buffers to the reader, so it needs one descriptor per chunk.
+ */
+typedef struct {
+    uint32_t sample_rate;       /*!< Hz */
+    uint32_t frame_bytes;       /*!< Bytes of one I2S frame, slots * slot width / 8 */
+    uint32_t chunk_frames;      /*!< I2S frames in one AFE feed chunk */
+    uint32_t desc_per_chunk;    /*!< DMA descriptors one chunk is split into */
+    uint32_t chunks;            /*!< Chunks the DMA ring holds before overrunning */
+    bool     callback;          /*!< Hand DMA buffers from the rx ISR to `i2s_capture_frame_take` */
+} i2s_capture_cfg_t;
+
+#if CONFIG_AUDIO_CAPTURE_CALLBACK
+#define I2S_CAPTURE_CALLBACK        true
+#define I2S_CAPTURE_DESC_PER_CHUNK  (1)
+#else
+#define I2S_CAPTURE_CALLBACK        false
+#define I2S_CAPTURE_DESC_PER_CHUNK  CONFIG_AUDIO_CAPTURE_DMA_DESC_PER_CHUNK
+#endif
+
+#define I2S_CAPTURE_DEFAULT_CONFIG(rate, bytes) {                   \
+    .sample_rate = (rate),                                          \
+    .frame_bytes = (bytes),                                         \
+    .chunk_frames = CONFIG_AUDIO_CAPTURE_CHUNK_FRAMES,               \
+    .desc_per_chunk = I2S_CAPTURE_DESC_PER_CHUNK,                   \
+    .chunks = CONFIG_AUDIO_CAPTURE_DMA_CHUNKS,                      \
+    .callback = I2S_CAPTURE_CALLBACK,                               \
+}
+
+/**
+ * @brief Capture health since boot or the last `i2s_capture_reset_stats`
+ */
+typedef struct {
+    uint32_t dma_frames;        /*!< Filled DMA buffers, `on_recv` events */
+    uint32_t overruns;          /*!< DMA buffers dropped because the reader fell behind */
+    uint32_t late;              /*!< Callback capture only, buffers DMA rewrote before the reader released them */
+    uint32_t dma_period_us;     /*!< Nominal time to fill one DMA buffer */
+    uint32_t dma_jitter_max_us; /*!< Largest deviation of the DMA interrupt period from nominal */
+    uint32_t reads;             /*!< Chunks handed to the AFE */
+    uint32_t read_gap_max_us;   /*!< Longest time between two reads */
+    uint32_t read_jitter_avg_us; /*!< Mean deviation of the read period from the audio it carried */
+    uint32_t latency_us;        /*!< Audio the DMA ring holds, the most a reader can lag without overruns */
+} i2s_capture_stats_t;
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+/**
+ * @brief Size the DMA descriptors of a channel config to the feed chunk
+ *
+ * @return
+ *    - ESP_OK                  Success
+ *    - ESP_ERR_INVALID_ARG     Chunk does not split evenly or a descriptor exceeds 4092 bytes
+ */
+esp_err_t i2s_capture_config(const i2s_capture_cfg_t *cfg, i2s_chan_config_t *chan_cfg);
+
+/**
+ * @brief Register the overrun and jitter callbacks on the rx channel, call before `i2s_channel_enable`
+ */
+esp_err_t i2s_capture_attach(i2s_chan_handle_t rx_handle);
+#endif
+
+/**
+ * @brief Wait for the next DMA buffer in callback capture, the caller may modify it in place
+ *
+ * The calling task becomes the consumer, buffers completed before the first call are not queued.
+ * The task is woken once per buffer. Release the buffer before taking the next one.
+ *
+ * @return
+ *    - ESP_OK                  Success
+ *    - ESP_ERR_TIMEOUT         No buffer within `ticks_to_wait`
+ *    - ESP_ERR_INVALID_STATE   Capture is not in callback mode
+ */
+esp_err_t i2s_capture_frame_take(void **buf, size_t *size, TickType_t ticks_to_wait);
+
+/**
+ * @brief Return the buffer of `i2s_capture_frame_take` to the DMA ring
+ *
+ * @return false when DMA had already started to overwrite it
+ */
+bool i2s_capture_frame_release(void);
+
+/**
+ * @brief Account one read of `frames` I2S frames, called after every feed read
+ */
+void i2s_capture_read_done(uint32_t frames);
+
+void i2s_capture_get_stats(i2s_capture_stats_t *stats);
+
+void i2s_capture_reset_stats(void);
+
+void i2s_capture_print_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PLAY_REF_RING_SAMPLES   (8192)      /*!< Reference history, 512 ms at 16 kHz, power of two */
+
+/**
+ * @brief Reference path health
+ */
+typedef struct {
+    uint32_t played;        /*!< Reference samples tapped from playback */
+    uint32_t dropped;       /*!< Samples not stored because capture stopped reading */
+    uint32_t restarts;      /*!< Playback started after being idle, the reference was re-anchored */
+    int32_t  delay;         /*!< Echo delay in samples, -1 until the first estimate */
+    uint32_t delay_updates; /*!< Times the estimate changed */
+    uint32_t confidence;    /*!< Normalized correlation of the current estimate, in percent */
+} play_ref_stats_t;
+
+/**
+ * @brief Software playback reference for boards without a hardware loopback
+ *
+ * Every sample handed to playback is stored on the capture sample timeline. When a capture
+ * chunk is read, the reference for the same instant, delayed by the estimated echo path, is
+ * written into its reference slot, so AEC sees the same layout as on a codec with loopback.
+ * The delay is estimated by cross-correlating the microphone with the reference while
+ * something is playing.
+ *
+ * @param sample_rate Capture and playback rate in Hz, both must match
+ * @param max_delay_ms Longest echo delay searched, playback and capture buffering included
+ * @return
+ *    - ESP_OK                  Success
+ *    - ESP_ERR_INVALID_ARG     Delay does not fit the reference history
+ */
+esp_err_t play_ref_init(uint32_t sample_rate, uint32_t max_delay_ms);
+
+/**
+ * @brief Tap mono PCM on its way to the speaker, called from the playback task
+ */
+void play_ref_write(const int16_t *pcm, int samples);
+
+/**
+ * @brief Fill the reference channel of one interleaved capture chunk, called from the feed task
+ *
+ * @param frame Interleaved capture chunk
+ * @param channels Channels in `frame`
+ * @param samples Samples per channel
+ * @param mic_ch Channel used for delay estimation
+ * @param ref_ch Channel overwritten with the aligned reference
+ */
+void play_ref_fill(int16_t *frame, int channels, int samples, int mic_ch, int ref_ch);
+
+void play_ref_get_stats(play_ref_stats_t *stats);
+
+void play_ref_print_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdatomic.h>
+#include "play_ref.h"
+
+#define RING_MASK           (PLAY_REF_RING_SAMPLES - 1)
+#define DECIM               (4)         // correlation runs on 4x decimated signals
+#define MAX_CHUNK           (1024)      // longest capture chunk the estimator handles
+#define MAX_LAGS            (PLAY_REF_RING_SAMPLES / 4 / DECIM)
+#define CORR_DECAY          (0.8f)      // about five chunks of memory
+#define MIN_CONFIDENCE      (0.25f)
+#define MIN_REF_LEVEL       (64.0f)     // mean decimated reference amplitude worth correlating
+
+static int16_t ring[PLAY_REF_RING_SAMPLES];
+static atomic_uint wr_pos;      // next reference sample, on the capture timeline
+static atomic_uint cap_pos;     // first sample of the next capture chunk
+static atomic_uint chunk;       // samples in the last capture chunk
+static uint32_t max_lag;        // samples
+static atomic_int delay = -1;
+
+// estimator state, feed task only
+static float mic_dec[MAX_CHUNK / DECIM];
+static float ref_dec[MAX_LAGS + MAX_CHUNK / DECIM];
+static float corr[MAX_LAGS + 1];
+static float ref_energy[MAX_LAGS + 1];
+static float mic_energy;
+static int candidate = -1;
+
+static play_ref_stats_t stats = { .delay = -1 };
+
+esp_err_t play_ref_init(uint32_t sample_rate, uint32_t max_delay_ms)
+{
+    uint32_t lag = sample_rate * max_delay_ms / 1000 / DECIM * DECIM;
+    if (lag == 0 || lag / DECIM > MAX_LAGS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    max_lag = lag;
+    memset(ring, 0, sizeof(ring));
+    memset(corr, 0, sizeof(corr));
+    memset(ref_energy, 0, sizeof(ref_energy));
+    mic_energy = 0;
+    candidate = -1;
+    atomic_store(&wr_pos, 0);
+    atomic_store(&cap_pos, 0);
+    atomic_store(&delay, -1);
+    memset(&stats, 0, sizeof(stats));
+    stats.delay = -1;
+    return ESP_OK;
+}
+
+void play_ref_write(const int16_t *pcm, int samples)
+{
+    uint32_t cap = atomic_load_explicit(&cap_pos, memory_order_acquire);
+    uint32_t wr = atomic_load_explicit(&wr_pos, memory_order_relaxed);
+    if ((int32_t)(wr - cap) < 0) {
+        // playback was idle, restart the reference at the current capture position with silence before it
+        uint32_t gap = cap - wr < PLAY_REF_RING_SAMPLES ? cap - wr : PLAY_REF_RING_SAMPLES;
+        for (uint32_t i = 0; i < gap; i++) {
+            ring[(cap - gap + i) & RING_MASK] = 0;
+        }
+        wr = cap;
+        stats.restarts++;
+    }
+    // keep the history the reader and the estimator still need
+    uint32_t headroom = PLAY_REF_RING_SAMPLES - max_lag - 2 * atomic_load(&chunk);
+    if (wr - cap + samples > headroom) {
+        stats.dropped += samples;
+        return;
+    }
+    for (int i = 0; i < samples; i++) {
+        ring[(wr + i) & RING_MASK] = pcm[i];
+    }
+    atomic_store_explicit(&wr_pos, wr + samples, memory_order_release);
+    stats.played += samples;
+}
+
+static inline int16_t ref_at(uint32_t pos, uint32_t wr)
+{
+    return (int32_t)(wr - pos) > 0 ? ring[pos & RING_MASK] : 0;
+}
+
+// cross-correlate the microphone with the reference over [0, max_lag], lock on a peak seen twice
+static void estimate(const int16_t *frame, int channels, int samples, int mic_ch, uint32_t cap, uint32_t wr)
+{
+    int n = samples / DECIM;
+    int lags = max_lag / DECIM;
+    uint32_t start = cap - max_lag;
+    float level = 0;
+    for (int k = 0; k < lags + n; k++) {
+        int32_t sum = 0;
+        for (int j = 0; j < DECIM; j++) {
+            sum += ref_at(start + k * DECIM + j, wr);
+        }
+        ref_dec[k] = sum / (float)DECIM;
+        level += fabsf(ref_dec[k]);
+    }
+    if (level / (lags + n) < MIN_REF_LEVEL) {
+        return;
+    }
+    float me = 0;
+    for (int k = 0; k < n; k++) {
+        int32_t sum = 0;
+        for (int j = 0; j < DECIM; j++) {
+            sum += frame[(k * DECIM + j) * channels + mic_ch];
+        }
+        mic_dec[k] = sum / (float)DECIM;
+        me += mic_dec[k] * mic_dec[k];
+    }
+    mic_energy = mic_energy * CORR_DECAY + me;
+
+    // lag l pairs mic_dec[k] with ref_dec[k + lags - l], the reference energy window slides along
+    float re = 0;
+    for (int k = 0; k < n; k++) {
+        re += ref_dec[k + lags] * ref_dec[k + lags];
+    }
+    int best = 0;
+    float best_abs = 0;
+    for (int l = 0; l <= lags; l++) {
+        const float *r = &ref_dec[lags - l];
+        float c = 0;
+        for (int k = 0; k < n; k++) {
+            c += mic_dec[k] * r[k];
+        }
+        corr[l] = corr[l] * CORR_DECAY + c;
+        ref_energy[l] = ref_energy[l] * CORR_DECAY + re;
+        if (fabsf(corr[l]) > best_abs) {
+            best_abs = fabsf(corr[l]);
+            best = l;
+        }
+        if (l < lags) {
+            re += r[-1] * r[-1] - r[n - 1] * r[n - 1];
+        }
+    }
+    float norm = sqrtf(mic_energy * ref_energy[best]);
+    float confidence = norm > 0 ? best_abs / norm : 0;
+    if (confidence < MIN_CONFIDENCE) {
+        return;
+    }
+    if (candidate >= 0 && abs(best - candidate) <= 1) {
+        int32_t d = best * DECIM;
+        if (d != atomic_load(&delay)) {
+            atomic_store(&delay, d);
+            stats.delay_updates++;
+        }
+        stats.confidence = confidence * 100;
+    }
+    candidate = best;
+}
+
+void play_ref_fill(int16_t *frame, int channels, int samples, int mic_ch, int ref_ch)
+{
+    uint32_t cap = atomic_load_explicit(&cap_pos, memory_order_relaxed);
+    uint32_t wr = atomic_load_explicit(&wr_pos, memory_order_acquire);
+    atomic_store(&chunk, samples);
+    // anything played within the search window can still echo into this chunk
+    if (max_lag && samples <= MAX_CHUNK && (int32_t)(wr - (cap - max_lag)) > 0) {
+        estimate(frame, channels, samples, mic_ch, cap, wr);
+    }
+    int32_t d = atomic_load(&delay);
+    uint32_t pos = cap - (d < 0 ? 0 : d);
+    for (int i = 0; i < samples; i++) {
+        frame[i * channels + ref_ch] = ref_at(pos + i, wr);
+    }
+    atomic_store_explicit(&cap_pos, cap + samples, memory_order_release);
+}
+
+void play_ref_get_stats(play_ref_stats_t *out)
+{
+    *out = stats;
+    out->delay = atomic_load(&delay);
+}
+
+void play_ref_print_stats(void)
+{
+    play_ref_stats_t s;
+    play_ref_get_stats(&s);
+    printf("playback reference: %lu samples, %lu dropped, %lu restarts, delay %ld samples (%lu%%, %lu updates)\n",
+           (unsigned long)s.played, (unsigned long)s.dropped, (unsigned long)s.restarts, (long)s.delay,
+           (unsigned long)s.confidence, (unsigned long)s.delay_updates);
+}
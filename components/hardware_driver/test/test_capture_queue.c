@@ -0,0 +1,156 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "capture_queue.h"
+
+#define SIM_DMA_BUF_NUM  (6)
+#define SIM_DMA_BUF_SIZE (64)
+
+/*
+ * DMA ring as the I2S driver runs it: buffers fill in ring order, DMA moves on to the next
+ * buffer the moment one completes and the rx ISR sees each completion once
+ */
+typedef struct {
+    uint8_t          buf[SIM_DMA_BUF_NUM][SIM_DMA_BUF_SIZE];
+    uint32_t         completed;
+    capture_queue_t  queue;
+} sim_dma_t;
+
+static uint8_t sim_pattern(uint32_t seq, int i)
+{
+    return (uint8_t) (seq * 7 + i);
+}
+
+static void sim_init(sim_dma_t *dma)
+{
+    memset(dma, 0, sizeof(*dma));
+    capture_queue_init(&dma->queue, SIM_DMA_BUF_NUM);
+}
+
+// DMA finishes buffer `completed`, starts writing the next one and raises on_recv
+static bool sim_complete(sim_dma_t *dma, bool consumer_attached)
+{
+    uint32_t seq = dma->completed++;
+    uint8_t *done = dma->buf[seq % SIM_DMA_BUF_NUM];
+    for (int i = 0; i < SIM_DMA_BUF_SIZE; i++) {
+        done[i] = sim_pattern(seq, i);
+    }
+    // first samples of the next buffer land right away
+    dma->buf[dma->completed % SIM_DMA_BUF_NUM][0] ^= 0xFF;
+    if (!consumer_attached) {
+        capture_queue_skip(&dma->queue);
+        return false;
+    }
+    return capture_queue_push(&dma->queue, done, SIM_DMA_BUF_SIZE, seq * 1000);
+}
+
+static bool sim_frame_intact(const capture_frame_t *f)
+{
+    const uint8_t *data = f->buf;
+    for (int i = 0; i < SIM_DMA_BUF_SIZE; i++) {
+        if (data[i] != sim_pattern(f->seq, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("capture queue hands buffers over in order", "[capture]")
+{
+    sim_dma_t *dma = calloc(1, sizeof(sim_dma_t));
+    TEST_ASSERT_NOT_NULL(dma);
+    sim_init(dma);
+    TEST_ASSERT_NULL(capture_queue_front(&dma->queue));
+
+    // consumer keeps up, two buffers in flight at a time
+    uint32_t expect = 0;
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(sim_complete(dma, true));
+        if (i % 2 == 0) {
+            continue;
+        }
+        const capture_frame_t *f;
+        while ((f = capture_queue_front(&dma->queue)) != NULL) {
+            TEST_ASSERT_EQUAL(expect, f->seq);
+            TEST_ASSERT_EQUAL_PTR(dma->buf[expect % SIM_DMA_BUF_NUM], f->buf);
+            TEST_ASSERT_EQUAL(SIM_DMA_BUF_SIZE, f->size);
+            TEST_ASSERT_TRUE(sim_frame_intact(f));
+            TEST_ASSERT_TRUE(capture_queue_release(&dma->queue));
+            expect++;
+        }
+    }
+    TEST_ASSERT_EQUAL(100, expect);
+    TEST_ASSERT_EQUAL(0, dma->queue.dropped);
+    TEST_ASSERT_EQUAL(0, dma->queue.late);
+    free(dma);
+}
+
+TEST_CASE("capture queue drops newest buffers on overflow", "[capture]")
+{
+    sim_dma_t *dma = calloc(1, sizeof(sim_dma_t));
+    TEST_ASSERT_NOT_NULL(dma);
+    sim_init(dma);
+
+    // completions before the consumer attaches are only counted
+    sim_complete(dma, false);
+    sim_complete(dma, false);
+    TEST_ASSERT_EQUAL(0, capture_queue_count(&dma->queue));
+
+    // stalled consumer, the ring keeps one buffer for DMA and one spare
+    for (int i = 0; i < SIM_DMA_BUF_NUM - 2; i++) {
+        TEST_ASSERT_TRUE(sim_complete(dma, true));
+    }
+    TEST_ASSERT_FALSE(sim_complete(dma, true));
+    TEST_ASSERT_EQUAL(SIM_DMA_BUF_NUM - 2, capture_queue_count(&dma->queue));
+    TEST_ASSERT_EQUAL(1, dma->queue.dropped);
+
+    // queued buffers are still whole and in order, the drop shows as a sequence gap
+    for (uint32_t seq = 2; seq < SIM_DMA_BUF_NUM; seq++) {
+        const capture_frame_t *f = capture_queue_front(&dma->queue);
+        TEST_ASSERT_NOT_NULL(f);
+        TEST_ASSERT_EQUAL(seq, f->seq);
+        TEST_ASSERT_TRUE(sim_frame_intact(f));
+        TEST_ASSERT_TRUE(capture_queue_release(&dma->queue));
+    }
+    TEST_ASSERT_TRUE(sim_complete(dma, true));
+    TEST_ASSERT_EQUAL(SIM_DMA_BUF_NUM + 1, capture_queue_front(&dma->queue)->seq);
+    free(dma);
+}
+
+TEST_CASE("capture queue reports buffers rewritten before release", "[capture]")
+{
+    sim_dma_t *dma = calloc(1, sizeof(sim_dma_t));
+    TEST_ASSERT_NOT_NULL(dma);
+    sim_init(dma);
+
+    // random consumer speed, release must report exactly the buffers DMA got back to
+    srand(5168);
+    uint32_t late = 0;
+    for (int i = 0; i < 2000; i++) {
+        sim_complete(dma, true);
+        int work = rand() % 8;
+        while (work-- > 0) {
+            const capture_frame_t *f = capture_queue_front(&dma->queue);
+            if (f == NULL) {
+                break;
+            }
+            bool intact = sim_frame_intact(f);
+            late += !intact;
+            TEST_ASSERT_EQUAL(intact, capture_queue_release(&dma->queue));
+        }
+        // consumer busy for a few buffer periods now and then
+        if (rand() % 50 == 0) {
+            for (int j = 0; j < SIM_DMA_BUF_NUM; j++) {
+                sim_complete(dma, true);
+            }
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(0, late);
+    TEST_ASSERT_EQUAL(late, dma->queue.late);
+    TEST_ASSERT_EQUAL(dma->completed, dma->queue.completed);
+    free(dma);
+}
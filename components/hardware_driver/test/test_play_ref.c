@@ -0,0 +1,109 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "play_ref.h"
+
+#define SIM_RATE        (16000)
+#define SIM_CHUNK       (512)
+#define SIM_PLAY_BLOCK  (256)
+#define SIM_CHUNKS      (60)
+#define SIM_LEN         (SIM_CHUNK * SIM_CHUNKS)
+
+/*
+ * Playback and capture clocked together as on one I2S peripheral: two playback blocks are
+ * written per capture chunk, the microphone hears them `echo_delay` samples later
+ */
+typedef struct {
+    int16_t  played[SIM_LEN];
+    int16_t  frame[SIM_CHUNK * 2];
+    uint32_t rnd;
+} sim_echo_t;
+
+static int16_t sim_noise(sim_echo_t *sim, int amplitude)
+{
+    sim->rnd = sim->rnd * 1103515245 + 12345;
+    return (int16_t) ((int32_t) ((sim->rnd >> 16) % (2 * amplitude + 1)) - amplitude);
+}
+
+// run the capture side from chunk `from` to `to`, playing only while `play` is set
+static void sim_run(sim_echo_t *sim, int from, int to, bool play, int echo_delay)
+{
+    for (int c = from; c < to; c++) {
+        uint32_t pos = c * SIM_CHUNK;
+        if (play) {
+            for (int b = 0; b < SIM_CHUNK / SIM_PLAY_BLOCK; b++) {
+                int16_t *block = &sim->played[pos + b * SIM_PLAY_BLOCK];
+                for (int i = 0; i < SIM_PLAY_BLOCK; i++) {
+                    block[i] = sim_noise(sim, 8000);
+                }
+                play_ref_write(block, SIM_PLAY_BLOCK);
+            }
+        }
+        for (int i = 0; i < SIM_CHUNK; i++) {
+            int p = pos + i - echo_delay;
+            int16_t echo = p >= 0 ? sim->played[p] / 2 : 0;
+            sim->frame[i * 2] = echo + sim_noise(sim, 200);
+            sim->frame[i * 2 + 1] = -1;
+        }
+        play_ref_fill(sim->frame, 2, SIM_CHUNK, 0, 1);
+    }
+}
+
+TEST_CASE("playback reference locks on the echo delay", "[play_ref]")
+{
+    sim_echo_t *sim = calloc(1, sizeof(sim_echo_t));
+    TEST_ASSERT_NOT_NULL(sim);
+    sim->rnd = 5168;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, play_ref_init(SIM_RATE, 2000));
+    TEST_ESP_OK(play_ref_init(SIM_RATE, 120));
+
+    // silence before playback leaves the reference slot at zero and the delay unknown
+    sim_run(sim, 0, 4, false, 0);
+    play_ref_stats_t stats;
+    play_ref_get_stats(&stats);
+    TEST_ASSERT_EQUAL(-1, stats.delay);
+    for (int i = 0; i < SIM_CHUNK; i++) {
+        TEST_ASSERT_EQUAL(0, sim->frame[i * 2 + 1]);
+    }
+
+    const int echo_delay = 1000;
+    sim_run(sim, 4, 30, true, echo_delay);
+    play_ref_get_stats(&stats);
+    TEST_ASSERT_INT_WITHIN(4, echo_delay, stats.delay);
+    TEST_ASSERT_EQUAL(1, stats.restarts);
+    TEST_ASSERT_EQUAL(0, stats.dropped);
+
+    // the reference slot carries what the microphone is hearing now
+    uint32_t pos = 29 * SIM_CHUNK;
+    for (int i = 0; i < SIM_CHUNK; i++) {
+        TEST_ASSERT_EQUAL(sim->played[pos + i - stats.delay], sim->frame[i * 2 + 1]);
+    }
+    free(sim);
+}
+
+TEST_CASE("playback reference re-anchors after idle playback", "[play_ref]")
+{
+    sim_echo_t *sim = calloc(1, sizeof(sim_echo_t));
+    TEST_ASSERT_NOT_NULL(sim);
+    sim->rnd = 39;
+    TEST_ESP_OK(play_ref_init(SIM_RATE, 120));
+
+    sim_run(sim, 0, 20, true, 600);
+    play_ref_stats_t stats;
+    play_ref_get_stats(&stats);
+    TEST_ASSERT_INT_WITHIN(4, 600, stats.delay);
+
+    // a pause longer than the reference history, then playback resumes with a longer path
+    sim_run(sim, 20, 40, false, 600);
+    sim_run(sim, 40, SIM_CHUNKS, true, 1400);
+    play_ref_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.restarts);
+    TEST_ASSERT_INT_WITHIN(4, 1400, stats.delay);
+    TEST_ASSERT_GREATER_OR_EQUAL(2, stats.delay_updates);
+    TEST_ASSERT_GREATER_OR_EQUAL(25, stats.confidence);
+    free(sim);
+}
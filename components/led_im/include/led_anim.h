@@ -0,0 +1,105 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LED_ANIM_LAYERS     (4)
+#define LED_ANIM_MAX_KEYS   (8)
+
+/**
+ * @brief What an effect lights, its colour comes from the keyframes
+ */
+typedef enum {
+    LED_SHAPE_SOLID = 0,    /*!< Every pixel of the range, fades and pulses */
+    LED_SHAPE_CHASE,        /*!< One pixel running through the range once per period */
+    LED_SHAPE_WIPE,         /*!< Pixels of the range lit one after another over the period */
+    LED_SHAPE_EYE,          /*!< No pixels, drives the eye GPIO, on at half brightness or more */
+} led_shape_t;
+
+typedef enum {
+    LED_BLEND_REPLACE = 0,  /*!< Lit pixels cover the layers below */
+    LED_BLEND_ADD,          /*!< Saturating sum */
+    LED_BLEND_MAX,          /*!< Brightest channel wins */
+} led_blend_t;
+
+#define LED_FX_STEP     (1 << 0)    /*!< Jump between keyframes instead of interpolating */
+#define LED_FX_HOLD     (1 << 1)    /*!< Keep showing the last frame once all loops are done */
+
+/**
+ * @brief Colour of an effect `t_ms` into its period, GRB like the strip
+ */
+typedef struct {
+    uint16_t t_ms;
+    uint8_t  g;
+    uint8_t  r;
+    uint8_t  b;
+} led_key_t;
+
+/**
+ * @brief One effect, copied when played so it can be built on the stack
+ *
+ * Keyframes are sorted by time, the colour before the first one is the first colour and after
+ * the last one the last colour.
+ */
+typedef struct {
+    uint8_t   shape;        /*!< led_shape_t */
+    uint8_t   blend;        /*!< led_blend_t */
+    uint8_t   flags;        /*!< LED_FX_* */
+    uint8_t   key_num;
+    uint16_t  first;        /*!< First pixel */
+    uint16_t  count;        /*!< Pixels, 0 for the rest of the strip */
+    uint16_t  period_ms;    /*!< Length of one loop */
+    uint16_t  loops;        /*!< 0 repeats until stopped */
+    led_key_t keys[LED_ANIM_MAX_KEYS];
+} led_fx_t;
+
+typedef struct {
+    led_fx_t fx;
+    uint32_t start_ms;
+    bool     active;
+} led_layer_t;
+
+/**
+ * @brief Effects composed bottom layer first into one frame per render tick
+ */
+typedef struct {
+    led_layer_t layers[LED_ANIM_LAYERS];
+    int         eye;        /*!< Eye level of the last render, -1 when no eye effect ran */
+} led_anim_t;
+
+void led_anim_init(led_anim_t *anim);
+
+/**
+ * @brief Play `fx` on `layer` from `start_ms` on, replacing what the layer played
+ *
+ * The layer shows nothing until `start_ms`, so effects can be queued after each other.
+ */
+void led_anim_play(led_anim_t *anim, int layer, const led_fx_t *fx, uint32_t start_ms);
+
+void led_anim_stop(led_anim_t *anim, int layer);
+
+bool led_anim_busy(const led_anim_t *anim);
+
+/**
+ * @brief Compose all layers at `now_ms` into `pixels`
+ *
+ * @return true when a pixel changed
+ */
+bool led_anim_render(led_anim_t *anim, uint8_t *pixels, size_t pixel_num, uint32_t now_ms);
+
+/**
+ * @brief Keyframe colour at `t_ms` into the period, 8.8 fixed point interpolation
+ */
+void led_anim_color(const led_fx_t *fx, uint32_t t_ms, uint8_t grb[3]);
+
+#ifdef __cplusplus
+}
+#endif
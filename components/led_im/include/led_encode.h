@@ -0,0 +1,49 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief RMT symbols of `bytes` of GRB data, one per bit plus the reset code
+ */
+#define LED_ENCODE_SYMBOLS(bytes)   ((bytes) * 8 + 1)
+
+/**
+ * @brief WS2812 symbols of every nibble, in the layout of `rmt_symbol_word_t`
+ *
+ * A nibble turns into four symbols at once, so a frame is encoded with two 16 byte copies
+ * per byte instead of a branch per bit.
+ */
+typedef struct {
+    uint32_t nibble[16][4];
+    uint32_t reset;
+} led_encode_lut_t;
+
+/**
+ * @brief One RMT symbol word, `level0` for `duration0` ticks then `level1` for `duration1` ticks
+ */
+uint32_t led_encode_symbol(int level0, uint32_t duration0, int level1, uint32_t duration1);
+
+/**
+ * @brief Build the table for WS2812 timing at `resolution_hz` RMT ticks per second
+ */
+void led_encode_init(led_encode_lut_t *lut, uint32_t resolution_hz);
+
+/**
+ * @brief Encode a whole frame, MSB first, and end it with the reset code
+ *
+ * @param symbols Room for `LED_ENCODE_SYMBOLS(bytes)` words
+ * @return Symbols written
+ */
+size_t led_encode_frame(const led_encode_lut_t *lut, const uint8_t *grb, size_t bytes, uint32_t *symbols);
+
+#ifdef __cplusplus
+}
+#endif
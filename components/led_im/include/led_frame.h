@@ -0,0 +1,111 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LED_FRAME_BYTES_PER_PIXEL   (3)     /*!< GRB */
+
+/**
+ * @brief Start sending a frame, must not wait for it to go out
+ *
+ * `pixels` stays untouched until the sink calls `led_frame_done`.
+ */
+typedef esp_err_t (*led_frame_submit_t)(void *ctx, const uint8_t *pixels, size_t bytes);
+
+/**
+ * @brief Draw the next frame into `pixels`, which holds the previous frame
+ *
+ * @return true when the frame changed and has to be sent
+ */
+typedef bool (*led_frame_render_t)(void *ctx, uint8_t *pixels, size_t pixel_num, uint32_t tick);
+
+typedef struct {
+    uint32_t ticks;         /*!< Render ticks */
+    uint32_t frames;        /*!< Frames handed to the sink */
+    uint32_t busy;          /*!< Ticks a changed frame waited because the last one was still going out,
+                                 it is sent by `led_frame_flush` once the sink is done */
+    uint32_t errors;        /*!< Frames the sink refused */
+} led_frame_stats_t;
+
+/**
+ * @brief Front and back framebuffer of one strip
+ *
+ * Rendering always goes to the back buffer. On a tick with a changed back buffer and nothing
+ * in flight, the buffers swap and the new front buffer is submitted, so the sink never reads
+ * a buffer that is being drawn and no caller waits for a transmission. A frame that waited
+ * for the sink goes out from `led_frame_flush` as soon as the sink reports done, so strips
+ * which take longer than a tick on the wire still run at wire speed.
+ */
+typedef struct {
+    uint8_t            *buf[2];
+    size_t              pixel_num;
+    uint8_t             front;
+    bool                dirty;
+    atomic_uint         inflight;   /*!< Frames submitted and not yet reported done by the sink */
+    led_frame_submit_t  submit;
+    void               *submit_ctx;
+    uint32_t            tick;
+    led_frame_stats_t   stats;
+} led_frame_t;
+
+/**
+ * @return
+ *    - ESP_OK                  Success
+ *    - ESP_ERR_INVALID_ARG     No pixels or no sink
+ *    - ESP_ERR_NO_MEM          Framebuffers could not be allocated
+ */
+esp_err_t led_frame_init(led_frame_t *frame, size_t pixel_num, led_frame_submit_t submit, void *submit_ctx);
+
+void led_frame_deinit(led_frame_t *frame);
+
+/**
+ * @brief Buffer to draw into outside of a render callback, call `led_frame_mark_dirty` after
+ */
+uint8_t *led_frame_back(led_frame_t *frame);
+
+void led_frame_mark_dirty(led_frame_t *frame);
+
+/**
+ * @brief Copy this strip's segment of a larger canvas into the back buffer
+ *
+ * @return true when it differed, the strip is then sent on the next tick
+ */
+bool led_frame_sync(led_frame_t *frame, const uint8_t *pixels);
+
+/**
+ * @brief One render tick: let `render` update the back buffer, then submit it if the sink is free
+ *
+ * @param render May be NULL to only flush changes made through `led_frame_back`
+ * @return true when a frame was submitted
+ */
+bool led_frame_tick(led_frame_t *frame, led_frame_render_t render, void *render_ctx);
+
+/**
+ * @brief Submit the back buffer if it changed and the sink is free
+ *
+ * Call from the drawing task when woken by the sink's done report.
+ *
+ * @return true when a frame was submitted
+ */
+bool led_frame_flush(led_frame_t *frame);
+
+/**
+ * @brief Sink side, the submitted frame went out, safe to call from the transmit done ISR
+ */
+void led_frame_done(led_frame_t *frame);
+
+void led_frame_get_stats(led_frame_t *frame, led_frame_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,47 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LED_GAMMA_SCALE_FULL    (256)   /*!< Brightness scale of 1.0 */
+#define LED_GAMMA_CHANNEL_MA    (20)    /*!< WS2812 current of one colour at full duty */
+
+/**
+ * @brief Perceptual byte to linear duty, gamma 2.2 in 8.8 fixed point, 255 maps to 255.0
+ */
+extern const uint16_t led_gamma_lut[256];
+
+/**
+ * @brief Linear duty of a frame, in 8.8 fixed point channel units
+ */
+uint32_t led_gamma_sum(const uint8_t *pixels, size_t bytes);
+
+/**
+ * @brief Brightness scale that keeps a frame of linear duty `sum` within `budget_ma`
+ *
+ * @return LED_GAMMA_SCALE_FULL or less
+ */
+uint16_t led_gamma_scale(uint32_t sum, uint32_t budget_ma);
+
+/**
+ * @brief Gamma correct, scale and temporally dither one frame for the strip
+ *
+ * The 8 fractional bits left after scaling are carried per channel in `residual` to the next
+ * frame, so a channel between two output levels alternates between them and averages out right.
+ *
+ * @param residual One byte per channel, kept between frames, zeroed at start
+ * @return true when some channel has a fraction, the strip has to be refreshed to dither
+ */
+bool led_gamma_apply(const uint8_t *in, uint8_t *out, uint8_t *residual, size_t bytes, uint16_t scale);
+
+#ifdef __cplusplus
+}
+#endif
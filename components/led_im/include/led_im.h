@@ -5,38 +5,36 @@
  */
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
-#include "driver/rmt_encoder.h"
+#include "led_frame.h"
 
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief Set up the strip and start the render task, the calls below only start effects and return
+ */
 void led_set();
 void led_reset();
 void led_color(uint8_t g, uint8_t r, uint8_t b);
-void led_process(void *arg);
+void led_fade(uint8_t g, uint8_t r, uint8_t b, uint16_t fade_ms);
+void led_pulse(uint8_t g, uint8_t r, uint8_t b, uint16_t period_ms);
+void led_process(void);
 void led_eye_control(uint8_t level);
+void led_get_stats(int strip, led_frame_stats_t *stats);
 
 /**
- * @brief Type of led strip encoder configuration
+ * @brief While armed, an effect started without a delay is drawn and sent right away instead of on the next tick
  */
-typedef struct {
-    uint32_t resolution; /*!< Encoder resolution, in Hz */
-} led_strip_encoder_config_t;
+void led_arm(bool arm);
 
 /**
- * @brief Create RMT encoder for encoding LED strip pixels into RMT symbols
- *
- * @param[in] config Encoder configuration
- * @param[out] ret_encoder Returned encoder handle
- * @return
- *      - ESP_ERR_INVALID_ARG for any invalid arguments
- *      - ESP_ERR_NO_MEM out of memory when creating led strip encoder
- *      - ESP_OK if creating encoder successfully
+ * @brief Effect start to first frame latency, with and without arming
  */
-esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder);
+void led_print_latency(void);
 
 #ifdef __cplusplus
 }
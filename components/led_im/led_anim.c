@@ -0,0 +1,167 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include "led_anim.h"
+
+// a layer at the current instant, worked out once per render
+typedef struct {
+    uint8_t  grb[3];
+    uint8_t  blend;
+    uint32_t lo;
+    uint32_t hi;
+} layer_span_t;
+
+void led_anim_init(led_anim_t *anim)
+{
+    memset(anim, 0, sizeof(*anim));
+    anim->eye = -1;
+}
+
+void led_anim_play(led_anim_t *anim, int layer, const led_fx_t *fx, uint32_t start_ms)
+{
+    if (layer < 0 || layer >= LED_ANIM_LAYERS) {
+        return;
+    }
+    led_layer_t *l = &anim->layers[layer];
+    l->fx = *fx;
+    if (l->fx.key_num > LED_ANIM_MAX_KEYS) {
+        l->fx.key_num = LED_ANIM_MAX_KEYS;
+    }
+    if (l->fx.period_ms == 0) {
+        l->fx.period_ms = 1;
+    }
+    l->start_ms = start_ms;
+    l->active = l->fx.key_num > 0;
+}
+
+void led_anim_stop(led_anim_t *anim, int layer)
+{
+    if (layer >= 0 && layer < LED_ANIM_LAYERS) {
+        anim->layers[layer].active = false;
+    }
+}
+
+bool led_anim_busy(const led_anim_t *anim)
+{
+    for (int i = 0; i < LED_ANIM_LAYERS; i++) {
+        if (anim->layers[i].active) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void led_anim_color(const led_fx_t *fx, uint32_t t_ms, uint8_t grb[3])
+{
+    const led_key_t *k = fx->keys;
+    int n = fx->key_num;
+    int i = 0;
+    while (i + 1 < n && k[i + 1].t_ms <= t_ms) {
+        i++;
+    }
+    const led_key_t *a = &k[i];
+    if (i + 1 == n || t_ms <= a->t_ms || (fx->flags & LED_FX_STEP)) {
+        grb[0] = a->g;
+        grb[1] = a->r;
+        grb[2] = a->b;
+        return;
+    }
+    const led_key_t *b = &k[i + 1];
+    uint32_t frac = ((t_ms - a->t_ms) << 8) / (b->t_ms - a->t_ms);
+    grb[0] = (a->g * (256 - frac) + b->g * frac) >> 8;
+    grb[1] = (a->r * (256 - frac) + b->r * frac) >> 8;
+    grb[2] = (a->b * (256 - frac) + b->b * frac) >> 8;
+}
+
+// time into the current loop, false once a layer without LED_FX_HOLD has finished
+static bool layer_time(led_layer_t *l, uint32_t now_ms, uint32_t *t_ms)
+{
+    uint32_t t = now_ms - l->start_ms;
+    uint32_t period = l->fx.period_ms;
+    if (l->fx.loops && t / period >= l->fx.loops) {
+        if (!(l->fx.flags & LED_FX_HOLD)) {
+            l->active = false;
+            return false;
+        }
+        *t_ms = period;
+        return true;
+    }
+    *t_ms = t % period;
+    return true;
+}
+
+static inline uint8_t blend(uint8_t below, uint8_t c, uint8_t mode)
+{
+    switch (mode) {
+    case LED_BLEND_ADD:
+        return below + c > 255 ? 255 : below + c;
+    case LED_BLEND_MAX:
+        return below > c ? below : c;
+    default:
+        return c;
+    }
+}
+
+bool led_anim_render(led_anim_t *anim, uint8_t *pixels, size_t pixel_num, uint32_t now_ms)
+{
+    layer_span_t spans[LED_ANIM_LAYERS];
+    int span_num = 0;
+    int eye = -1;
+    for (int i = 0; i < LED_ANIM_LAYERS; i++) {
+        led_layer_t *l = &anim->layers[i];
+        uint32_t t;
+        // layers queued for later compare as negative time
+        if (!l->active || (int32_t)(now_ms - l->start_ms) < 0 || !layer_time(l, now_ms, &t)) {
+            continue;
+        }
+        layer_span_t *s = &spans[span_num];
+        led_anim_color(&l->fx, t, s->grb);
+        if (l->fx.shape == LED_SHAPE_EYE) {
+            uint8_t level = s->grb[0] | s->grb[1] | s->grb[2];
+            eye = level >= 128;
+            continue;
+        }
+        uint32_t lo = l->fx.first < pixel_num ? l->fx.first : pixel_num;
+        uint32_t n = l->fx.count ? l->fx.count : pixel_num - lo;
+        if (n > pixel_num - lo) {
+            n = pixel_num - lo;
+        }
+        uint32_t period = l->fx.period_ms;
+        s->blend = l->fx.blend;
+        s->lo = lo;
+        s->hi = lo + n;
+        if (l->fx.shape == LED_SHAPE_CHASE) {
+            uint32_t pos = t * n / period;
+            s->lo = lo + (pos < n ? pos : n - 1);
+            s->hi = s->lo + 1;
+        } else if (l->fx.shape == LED_SHAPE_WIPE) {
+            s->hi = lo + t * n / period;
+        }
+        if (s->hi > s->lo) {
+            span_num++;
+        }
+    }
+    anim->eye = eye;
+
+    bool changed = false;
+    for (uint32_t p = 0; p < pixel_num; p++) {
+        uint8_t out[3] = { 0, 0, 0 };
+        for (int i = 0; i < span_num; i++) {
+            const layer_span_t *s = &spans[i];
+            if (p >= s->lo && p < s->hi) {
+                out[0] = blend(out[0], s->grb[0], s->blend);
+                out[1] = blend(out[1], s->grb[1], s->blend);
+                out[2] = blend(out[2], s->grb[2], s->blend);
+            }
+        }
+        uint8_t *px = &pixels[p * 3];
+        if (px[0] != out[0] || px[1] != out[1] || px[2] != out[2]) {
+            px[0] = out[0];
+            px[1] = out[1];
+            px[2] = out[2];
+            changed = true;
+        }
+    }
+    return changed;
+}
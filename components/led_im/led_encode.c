@@ -0,0 +1,39 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include "led_encode.h"
+
+uint32_t led_encode_symbol(int level0, uint32_t duration0, int level1, uint32_t duration1)
+{
+    return (duration0 & 0x7FFF) | (uint32_t)(level0 ? 1 : 0) << 15 |
+           (duration1 & 0x7FFF) << 16 | (uint32_t)(level1 ? 1 : 0) << 31;
+}
+
+void led_encode_init(led_encode_lut_t *lut, uint32_t resolution_hz)
+{
+    // same timing as rmt_new_led_strip_encoder: T0H 0.3us T0L 0.9us, T1H 0.9us T1L 0.3us, 50us reset
+    uint32_t short_ticks = 3ULL * resolution_hz / 10000000;
+    uint32_t long_ticks = 9ULL * resolution_hz / 10000000;
+    uint32_t bit0 = led_encode_symbol(1, short_ticks, 0, long_ticks);
+    uint32_t bit1 = led_encode_symbol(1, long_ticks, 0, short_ticks);
+    for (int n = 0; n < 16; n++) {
+        for (int i = 0; i < 4; i++) {
+            lut->nibble[n][i] = (n & (0x8 >> i)) ? bit1 : bit0;
+        }
+    }
+    uint32_t reset_ticks = resolution_hz / 1000000 * 50 / 2;
+    lut->reset = led_encode_symbol(0, reset_ticks, 0, reset_ticks);
+}
+
+size_t led_encode_frame(const led_encode_lut_t *lut, const uint8_t *grb, size_t bytes, uint32_t *symbols)
+{
+    uint32_t *out = symbols;
+    for (size_t i = 0; i < bytes; i++) {
+        memcpy(out, lut->nibble[grb[i] >> 4], sizeof(lut->nibble[0]));
+        memcpy(out + 4, lut->nibble[grb[i] & 0xF], sizeof(lut->nibble[0]));
+        out += 8;
+    }
+    *out++ = lut->reset;
+    return out - symbols;
+}
@@ -0,0 +1,103 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "led_frame.h"
+
+esp_err_t led_frame_init(led_frame_t *frame, size_t pixel_num, led_frame_submit_t submit, void *submit_ctx)
+{
+    if (pixel_num == 0 || submit == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(frame, 0, sizeof(*frame));
+    size_t bytes = pixel_num * LED_FRAME_BYTES_PER_PIXEL;
+    frame->buf[0] = calloc(1, bytes);
+    frame->buf[1] = calloc(1, bytes);
+    if (frame->buf[0] == NULL || frame->buf[1] == NULL) {
+        led_frame_deinit(frame);
+        return ESP_ERR_NO_MEM;
+    }
+    frame->pixel_num = pixel_num;
+    frame->submit = submit;
+    frame->submit_ctx = submit_ctx;
+    atomic_init(&frame->inflight, 0);
+    return ESP_OK;
+}
+
+void led_frame_deinit(led_frame_t *frame)
+{
+    free(frame->buf[0]);
+    free(frame->buf[1]);
+    frame->buf[0] = NULL;
+    frame->buf[1] = NULL;
+}
+
+uint8_t *led_frame_back(led_frame_t *frame)
+{
+    return frame->buf[frame->front ^ 1];
+}
+
+void led_frame_mark_dirty(led_frame_t *frame)
+{
+    frame->dirty = true;
+}
+
+bool led_frame_sync(led_frame_t *frame, const uint8_t *pixels)
+{
+    uint8_t *back = led_frame_back(frame);
+    size_t bytes = frame->pixel_num * LED_FRAME_BYTES_PER_PIXEL;
+    if (memcmp(back, pixels, bytes) == 0) {
+        return false;
+    }
+    memcpy(back, pixels, bytes);
+    frame->dirty = true;
+    return true;
+}
+
+bool led_frame_flush(led_frame_t *frame)
+{
+    // the front buffer belongs to the sink until it reports done, keep drawing on the back one
+    if (!frame->dirty || atomic_load_explicit(&frame->inflight, memory_order_acquire) != 0) {
+        return false;
+    }
+    uint8_t *back = led_frame_back(frame);
+    size_t bytes = frame->pixel_num * LED_FRAME_BYTES_PER_PIXEL;
+    frame->front ^= 1;
+    atomic_store_explicit(&frame->inflight, 1, memory_order_relaxed);
+    if (frame->submit(frame->submit_ctx, back, bytes) != ESP_OK) {
+        atomic_store_explicit(&frame->inflight, 0, memory_order_relaxed);
+        frame->front ^= 1;
+        frame->stats.errors++;
+        return false;
+    }
+    frame->dirty = false;
+    frame->stats.frames++;
+    // the next frame starts from the one just sent
+    memcpy(led_frame_back(frame), back, bytes);
+    return true;
+}
+
+bool led_frame_tick(led_frame_t *frame, led_frame_render_t render, void *render_ctx)
+{
+    frame->stats.ticks++;
+    if (render && render(render_ctx, led_frame_back(frame), frame->pixel_num, frame->tick)) {
+        frame->dirty = true;
+    }
+    frame->tick++;
+    if (frame->dirty && atomic_load_explicit(&frame->inflight, memory_order_acquire) != 0) {
+        frame->stats.busy++;
+        return false;
+    }
+    return led_frame_flush(frame);
+}
+
+void led_frame_done(led_frame_t *frame)
+{
+    atomic_store_explicit(&frame->inflight, 0, memory_order_release);
+}
+
+void led_frame_get_stats(led_frame_t *frame, led_frame_stats_t *stats)
+{
+    *stats = frame->stats;
+}
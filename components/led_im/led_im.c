@@ -5,212 +5,366 @@
  */
 
 #include "esp_check.h"
+#include "esp_log.h"
 #include "led_im.h"
-#include "driver/gpio.h"
-#include "driver/rmt_tx.h"
+#include "led_frame.h"
+#include "led_anim.h"
+#include "led_encode.h"
+#include "led_gamma.h"
+#include "act_hal.h"
+#include "act_lat.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+#include <stdlib.h>
 #include <string.h>
 
 static const char *TAG = "MK39 LED Control";
 
-#define RMT_LED_STRIP_RESOLUTION_HZ 10000000 // 10MHz resolution, 1 tick = 0.1us (led strip needs a high resolution)
-#define RMT_LED_STRIP_GPIO_NUM      21
-
-#define EXAMPLE_LED_NUMBERS         16
 #define EXAMPLE_CHASE_SPEED_MS      10
 
-static uint8_t led_strip_pixels[EXAMPLE_LED_NUMBERS * 3];
-
 uint32_t red = 0;
 uint32_t green = 0;
 uint32_t blue = 0;
 uint16_t hue = 0;
 uint16_t start_rgb = 0;
 
-rmt_channel_handle_t led_chan = NULL;
-rmt_tx_channel_config_t tx_chan_config;
-rmt_encoder_handle_t led_encoder = NULL;
-led_strip_encoder_config_t encoder_config;
-rmt_transmit_config_t tx_config;
+#define LED_EYE_GPIO        38
+#define LED_CHASE_ROUNDS    5
+#define LED_STEP_MS         EXAMPLE_CHASE_SPEED_MS
+#define LED_REACTOR_PIXELS  CONFIG_LED_STRIP0_PIXELS
+#define LED_SWEEP_MS        (LED_REACTOR_PIXELS * LED_STEP_MS)   // one reactor pixel per tick
+#define LED_NOTIFY_PLAY     (1 << 0)    // an effect started while armed, draw it now
+#define LED_NOTIFY_DONE     (1 << 1)    // a strip finished sending, a waiting frame can go out
+
+typedef struct {
+    int gpio_num;
+    uint16_t pixel_num;
+} led_strip_cfg_t;
+
+// strips in canvas order, strip 0 is the chest reactor
+static const led_strip_cfg_t strip_cfg[] = {
+    { CONFIG_LED_STRIP0_GPIO, CONFIG_LED_STRIP0_PIXELS },
+#if CONFIG_LED_STRIP_NUM >= 2
+    { CONFIG_LED_STRIP1_GPIO, CONFIG_LED_STRIP1_PIXELS },
+#endif
+#if CONFIG_LED_STRIP_NUM >= 3
+    { CONFIG_LED_STRIP2_GPIO, CONFIG_LED_STRIP2_PIXELS },
+#endif
+#if CONFIG_LED_STRIP_NUM >= 4
+    { CONFIG_LED_STRIP3_GPIO, CONFIG_LED_STRIP3_PIXELS },
+#endif
+};
+
+#define LED_STRIP_NUM       (sizeof(strip_cfg) / sizeof(strip_cfg[0]))
 
 typedef struct {
-    rmt_encoder_t base;
-    rmt_encoder_t *bytes_encoder;
-    rmt_encoder_t *copy_encoder;
-    int state;
-    rmt_symbol_word_t reset_code;
-} rmt_led_strip_encoder_t;
-
-static size_t rmt_encode_led_strip(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
+    int id;                         // strip number in the actuator HAL
+    uint8_t *color;                 // gamma corrected, scaled and dithered frame that is sent
+    uint8_t *residual;              // dither fractions carried to the next frame
+    bool dither;                    // the last frame had fractions, keep refreshing
+    uint16_t first;                 // first pixel in the canvas
+    led_frame_t frame;
+} led_strip_t;
+
+// layers, bottom first
+enum {
+    LED_LAYER_BASE = 0,     // reactor and suit colour
+    LED_LAYER_CHASE,        // wake chase
+    LED_LAYER_EYE,          // eye blink
+};
+
+// effects are started by any task and rendered by the led task only
+static act_hal_t *hal;
+static led_anim_t anim;
+static uint32_t anim_now_ms;
+static uint8_t base_grb[3];
+static SemaphoreHandle_t anim_lock;
+static led_strip_t strips[LED_STRIP_NUM];
+static led_encode_lut_t encode_lut;
+static uint8_t *canvas;             // every strip back to back
+static size_t canvas_pixels;
+static uint16_t color_scale = LED_GAMMA_SCALE_FULL;   // brightness cap of the current budget
+static TaskHandle_t render_task;
+static bool armed;                  // an effect started now is drawn right away instead of on the next tick
+static int64_t play_us;             // oldest effect start not drawn yet, 0 when none
+static bool play_armed;
+static act_lat_t latency[2];        // effect start to its first frame handed to the strips, disarmed and armed
+
+static void led_play(int layer, const led_fx_t *fx, uint32_t delay_ms)
 {
-    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
-    rmt_encoder_handle_t bytes_encoder = led_encoder->bytes_encoder;
-    rmt_encoder_handle_t copy_encoder = led_encoder->copy_encoder;
-    rmt_encode_state_t session_state = RMT_ENCODING_RESET;
-    rmt_encode_state_t state = RMT_ENCODING_RESET;
-    size_t encoded_symbols = 0;
-    switch (led_encoder->state) {
-    case 0: // send RGB data
-        encoded_symbols += bytes_encoder->encode(bytes_encoder, channel, primary_data, data_size, &session_state);
-        if (session_state & RMT_ENCODING_COMPLETE) {
-            led_encoder->state = 1; // switch to next state when current encoding session finished
-        }
-        if (session_state & RMT_ENCODING_MEM_FULL) {
-            state |= RMT_ENCODING_MEM_FULL;
-            goto out; // yield if there's no free space for encoding artifacts
-        }
-    // fall-through
-    case 1: // send reset code
-        encoded_symbols += copy_encoder->encode(copy_encoder, channel, &led_encoder->reset_code,
-                                                sizeof(led_encoder->reset_code), &session_state);
-        if (session_state & RMT_ENCODING_COMPLETE) {
-            led_encoder->state = RMT_ENCODING_RESET; // back to the initial encoding session
-            state |= RMT_ENCODING_COMPLETE;
-        }
-        if (session_state & RMT_ENCODING_MEM_FULL) {
-            state |= RMT_ENCODING_MEM_FULL;
-            goto out; // yield if there's no free space for encoding artifacts
-        }
+    if (anim_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(anim_lock, portMAX_DELAY);
+    led_anim_play(&anim, layer, fx, anim_now_ms + delay_ms);
+    if (delay_ms == 0 && play_us == 0) {
+        play_us = act_now_us(hal);
+        play_armed = armed;
+    }
+    bool wake = armed && delay_ms == 0;
+    xSemaphoreGive(anim_lock);
+    if (wake) {
+        xTaskNotify(render_task, LED_NOTIFY_PLAY, eSetBits);
     }
-out:
-    *ret_state = state;
-    return encoded_symbols;
 }
 
-static esp_err_t rmt_del_led_strip_encoder(rmt_encoder_t *encoder)
+// wipe every strip to a colour in the time the reactor takes at one pixel per tick, and keep it
+static void led_base_wipe(uint8_t g, uint8_t r, uint8_t b, uint32_t delay_ms)
 {
-    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
-    rmt_del_encoder(led_encoder->bytes_encoder);
-    rmt_del_encoder(led_encoder->copy_encoder);
-    free(led_encoder);
-    return ESP_OK;
+    led_fx_t fx = {
+        .shape = LED_SHAPE_WIPE,
+        .flags = LED_FX_HOLD,
+        .period_ms = LED_SWEEP_MS,
+        .loops = 1,
+        .key_num = 1,
+        .keys = { { 0, g, r, b } },
+    };
+    led_play(LED_LAYER_BASE, &fx, delay_ms);
+    base_grb[0] = g;
+    base_grb[1] = r;
+    base_grb[2] = b;
 }
 
-static esp_err_t rmt_led_strip_encoder_reset(rmt_encoder_t *encoder)
+static esp_err_t led_strip_submit(void *ctx, const uint8_t *pixels, size_t bytes)
 {
-    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
-    rmt_encoder_reset(led_encoder->bytes_encoder);
-    rmt_encoder_reset(led_encoder->copy_encoder);
-    led_encoder->state = RMT_ENCODING_RESET;
-    return ESP_OK;
+    led_strip_t *strip = ctx;
+    strip->dither = led_gamma_apply(pixels, strip->color, strip->residual, bytes, color_scale);
+    // queued behind nothing, the frame engine keeps one transaction in flight
+    return act_strip_send(hal, strip->id, strip->color, bytes);
 }
 
-esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+// the whole frame is encoded in one pass by the led task, the ISR only copies symbols
+static size_t led_strip_encode(void *ctx, const uint8_t *grb, size_t bytes, uint32_t *symbols)
 {
-    esp_err_t ret = ESP_OK;
-    rmt_led_strip_encoder_t *led_encoder = NULL;
-    ESP_GOTO_ON_FALSE(config && ret_encoder, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
-    led_encoder = rmt_alloc_encoder_mem(sizeof(rmt_led_strip_encoder_t));
-    ESP_GOTO_ON_FALSE(led_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for led strip encoder");
-    led_encoder->base.encode = rmt_encode_led_strip;
-    led_encoder->base.del = rmt_del_led_strip_encoder;
-    led_encoder->base.reset = rmt_led_strip_encoder_reset;
-    // different led strip might have its own timing requirements, following parameter is for WS2812
-    rmt_bytes_encoder_config_t bytes_encoder_config = {
-        .bit0 = {
-            .level0 = 1,
-            .duration0 = 0.3 * config->resolution / 1000000, // T0H=0.3us
-            .level1 = 0,
-            .duration1 = 0.9 * config->resolution / 1000000, // T0L=0.9us
-        },
-        .bit1 = {
-            .level0 = 1,
-            .duration0 = 0.9 * config->resolution / 1000000, // T1H=0.9us
-            .level1 = 0,
-            .duration1 = 0.3 * config->resolution / 1000000, // T1L=0.3us
-        },
-        .flags.msb_first = 1 // WS2812 transfer bit order: G7...G0R7...R0B7...B0
-    };
-    ESP_GOTO_ON_ERROR(rmt_new_bytes_encoder(&bytes_encoder_config, &led_encoder->bytes_encoder), err, TAG, "create bytes encoder failed");
-    rmt_copy_encoder_config_t copy_encoder_config = {};
-    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &led_encoder->copy_encoder), err, TAG, "create copy encoder failed");
-
-    uint32_t reset_ticks = config->resolution / 1000000 * 50 / 2; // reset code duration defaults to 50us
-    led_encoder->reset_code = (rmt_symbol_word_t) {
-        .level0 = 0,
-        .duration0 = reset_ticks,
-        .level1 = 0,
-        .duration1 = reset_ticks,
-    };
-    *ret_encoder = &led_encoder->base;
-    return ESP_OK;
-err:
-    if (led_encoder) {
-        if (led_encoder->bytes_encoder) {
-            rmt_del_encoder(led_encoder->bytes_encoder);
+    return led_encode_frame(&encode_lut, grb, bytes, symbols);
+}
+
+static void led_strip_done(void *ctx)
+{
+    led_frame_done(ctx);
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(render_task, LED_NOTIFY_DONE, eSetBits, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void led_render_task(void *arg)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+    int eye_level = -1;
+    uint32_t tick = 0;
+    for (;;) {
+        xSemaphoreTake(anim_lock, portMAX_DELAY);
+        anim_now_ms = tick * LED_STEP_MS;
+        bool changed = led_anim_render(&anim, canvas, canvas_pixels, anim_now_ms);
+        int eye = anim.eye;
+        int64_t requested_us = play_us;
+        bool requested_armed = play_armed;
+        play_us = 0;
+        xSemaphoreGive(anim_lock);
+        if (eye >= 0 && eye != eye_level) {
+            act_dout_write(hal, LED_EYE_GPIO, eye);
         }
-        if (led_encoder->copy_encoder) {
-            rmt_del_encoder(led_encoder->copy_encoder);
+        eye_level = eye;
+        // all strips share one supply, scale them together when the frame would draw too much
+        bool rescaled = false;
+        if (changed) {
+            uint16_t scale = led_gamma_scale(led_gamma_sum(canvas, canvas_pixels * LED_FRAME_BYTES_PER_PIXEL),
+                                             CONFIG_LED_CURRENT_BUDGET_MA);
+            rescaled = scale != color_scale;
+            color_scale = scale;
+        }
+        for (int i = 0; i < LED_STRIP_NUM; i++) {
+            // strips whose segment did not change are neither encoded nor sent, unless they dither
+            if (changed) {
+                led_frame_sync(&strips[i].frame, &canvas[strips[i].first * LED_FRAME_BYTES_PER_PIXEL]);
+            }
+            if (rescaled || strips[i].dither) {
+                led_frame_mark_dirty(&strips[i].frame);
+            }
+            led_frame_tick(&strips[i].frame, NULL, NULL);
+        }
+        if (requested_us) {
+            int64_t now_us = act_now_us(hal);
+            xSemaphoreTake(anim_lock, portMAX_DELAY);
+            act_lat_add(&latency[requested_armed], now_us - requested_us);
+            xSemaphoreGive(anim_lock);
+        }
+        // an effect started while armed wakes the task early, it is drawn at the time of this
+        // tick so it starts from its first key, and the fixed rate carries on from last_wake
+        TickType_t next_wake = last_wake + pdMS_TO_TICKS(LED_STEP_MS);
+        for (;;) {
+            int32_t wait = (int32_t)(next_wake - xTaskGetTickCount());
+            uint32_t events = 0;
+            if (xTaskNotifyWait(0, UINT32_MAX, &events, wait > 0 ? wait : 0) == pdFALSE) {
+                last_wake = next_wake;
+                tick++;
+                break;
+            }
+            // strips slower than a tick send the frame that waited as soon as the wire is free
+            if (events & LED_NOTIFY_DONE) {
+                for (int i = 0; i < LED_STRIP_NUM; i++) {
+                    led_frame_flush(&strips[i].frame);
+                }
+            }
+            if (events & LED_NOTIFY_PLAY) {
+                break;
+            }
         }
-        free(led_encoder);
     }
-    return ret;
 }
 
-void led_set(){
-    tx_chan_config.clk_src = RMT_CLK_SRC_DEFAULT; // select source clock
-    tx_chan_config.gpio_num = RMT_LED_STRIP_GPIO_NUM;
-    tx_chan_config.mem_block_symbols = 256; // increase the block size can make the LED less flickering
-    tx_chan_config.resolution_hz = RMT_LED_STRIP_RESOLUTION_HZ;
-    tx_chan_config.trans_queue_depth = 4; // set the number of transactions that can be pending in the background
-    ESP_ERROR_CHECK(rmt_new_tx_channel(&tx_chan_config, &led_chan));
+static esp_err_t led_strip_init(led_strip_t *strip, int id, const led_strip_cfg_t *cfg, uint16_t first, act_strip_cfg_t *hal_cfg)
+{
+    strip->id = id;
+    strip->first = first;
+    strip->color = malloc(cfg->pixel_num * LED_FRAME_BYTES_PER_PIXEL);
+    strip->residual = calloc(cfg->pixel_num, LED_FRAME_BYTES_PER_PIXEL);
+    ESP_RETURN_ON_FALSE(strip->color && strip->residual, ESP_ERR_NO_MEM, TAG, "no memory for colour buffers");
+    ESP_RETURN_ON_ERROR(led_frame_init(&strip->frame, cfg->pixel_num, led_strip_submit, strip), TAG, "no memory for frames");
+    *hal_cfg = (act_strip_cfg_t) {
+        .gpio_num = cfg->gpio_num,
+        .pixel_num = cfg->pixel_num,
+        .encode = led_strip_encode,
+        .symbol_num = LED_ENCODE_SYMBOLS(cfg->pixel_num * LED_FRAME_BYTES_PER_PIXEL),
+        .done = led_strip_done,
+        .done_ctx = &strip->frame,
+    };
+    return ESP_OK;
+}
 
-    encoder_config.resolution = RMT_LED_STRIP_RESOLUTION_HZ;
-    ESP_ERROR_CHECK(rmt_new_led_strip_encoder(&encoder_config, &led_encoder));
+void led_set(){
+    led_encode_init(&encode_lut, ACT_STRIP_RESOLUTION_HZ);
+    hal = act_hal_default();
 
-    ESP_ERROR_CHECK(rmt_enable(led_chan));
+    act_strip_cfg_t hal_cfg[LED_STRIP_NUM];
+    uint16_t first = 0;
+    for (int i = 0; i < LED_STRIP_NUM; i++) {
+        ESP_ERROR_CHECK(led_strip_init(&strips[i], i, &strip_cfg[i], first, &hal_cfg[i]));
+        first += strip_cfg[i].pixel_num;
+    }
+    canvas_pixels = first;
+    canvas = calloc(canvas_pixels, LED_FRAME_BYTES_PER_PIXEL);
+    ESP_ERROR_CHECK(canvas ? ESP_OK : ESP_ERR_NO_MEM);
+    bool dma = false;
+#if CONFIG_LED_STRIP_DMA
+    dma = true;
+#endif
+    ESP_ERROR_CHECK(act_strip_init(hal, hal_cfg, LED_STRIP_NUM, dma));
 
-    tx_config.loop_count = 0; // no transfer loop
+    ESP_ERROR_CHECK(act_dout_init(hal, LED_EYE_GPIO));
+    led_anim_init(&anim);
+    anim_lock = xSemaphoreCreateMutex();
+    // one persistent task renders every effect at a fixed rate
+    xTaskCreatePinnedToCore(&led_render_task, "led", 3 * 1024, NULL, 5, &render_task, 1);
 }
 
 void led_reset(){
-        //use memset instead of loop for setting pixels
-        memset(led_strip_pixels, 0, sizeof(led_strip_pixels)); 
-        ESP_ERROR_CHECK(rmt_transmit(led_chan, led_encoder, led_strip_pixels, sizeof(led_strip_pixels), &tx_config));
-        ESP_ERROR_CHECK(rmt_tx_wait_all_done(led_chan, portMAX_DELAY));
-        vTaskDelay(pdMS_TO_TICKS(EXAMPLE_CHASE_SPEED_MS));
-        memset(led_strip_pixels, 0, sizeof(led_strip_pixels));
+    if (anim_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(anim_lock, portMAX_DELAY);
+    for (int i = 0; i < LED_ANIM_LAYERS; i++) {
+        led_anim_stop(&anim, i);
+    }
+    xSemaphoreGive(anim_lock);
+    memset(base_grb, 0, sizeof(base_grb));
 }
 
 void led_color(uint8_t g, uint8_t r, uint8_t b){
-    //RGB Color
-    led_reset();
-    for (int j = 0; j < 48; j += 1) {
-        led_strip_pixels[j] = g;
-        led_strip_pixels[j+1] = r;
-        led_strip_pixels[j+2] = b;
-        j+=2;
-        ESP_ERROR_CHECK(rmt_transmit(led_chan, led_encoder, led_strip_pixels, sizeof(led_strip_pixels), &tx_config));
-        ESP_ERROR_CHECK(rmt_tx_wait_all_done(led_chan, portMAX_DELAY));
-        vTaskDelay(pdMS_TO_TICKS(EXAMPLE_CHASE_SPEED_MS));
+    //RGB Color, wiped in one pixel per tick
+    led_base_wipe(g, r, b, 0);
+}
+
+void led_fade(uint8_t g, uint8_t r, uint8_t b, uint16_t fade_ms){
+    led_fx_t fx = {
+        .shape = LED_SHAPE_SOLID,
+        .flags = LED_FX_HOLD,
+        .period_ms = fade_ms,
+        .loops = 1,
+        .key_num = 2,
+        .keys = { { 0, base_grb[0], base_grb[1], base_grb[2] }, { fade_ms, g, r, b } },
+    };
+    led_play(LED_LAYER_BASE, &fx, 0);
+    base_grb[0] = g;
+    base_grb[1] = r;
+    base_grb[2] = b;
+}
+
+void led_pulse(uint8_t g, uint8_t r, uint8_t b, uint16_t period_ms){
+    // breathes over the reactor colour until replaced
+    led_fx_t fx = {
+        .shape = LED_SHAPE_SOLID,
+        .blend = LED_BLEND_MAX,
+        .period_ms = period_ms,
+        .key_num = 3,
+        .keys = { { 0, 0, 0, 0 }, { period_ms / 2, g, r, b }, { period_ms, 0, 0, 0 } },
+    };
+    led_play(LED_LAYER_CHASE, &fx, 0);
+}
+
+void led_process(void){
+    //chest reactor chase with flashing eye leds, then a red wipe
+    static const led_fx_t chase = {
+        .shape = LED_SHAPE_CHASE,
+        .count = LED_REACTOR_PIXELS,
+        .period_ms = LED_SWEEP_MS,
+        .loops = LED_CHASE_ROUNDS,
+        .key_num = 1,
+        .keys = { { 0, 0, 255, 0 } },
+    };
+    static const led_fx_t blink = {
+        .shape = LED_SHAPE_EYE,
+        .flags = LED_FX_STEP,
+        .period_ms = LED_CHASE_ROUNDS * LED_SWEEP_MS,
+        .loops = 1,
+        .key_num = 5,
+        // toggles as each chase round ends
+        .keys = {
+            { 0, 0, 0, 0 },
+            { 2 * LED_SWEEP_MS - LED_STEP_MS, 255, 255, 255 },
+            { 3 * LED_SWEEP_MS - LED_STEP_MS, 0, 0, 0 },
+            { 4 * LED_SWEEP_MS - LED_STEP_MS, 255, 255, 255 },
+            { 5 * LED_SWEEP_MS - LED_STEP_MS, 0, 0, 0 },
+        },
+    };
+    // the reactor stays dark until the wipe queued behind the chase starts
+    led_play(LED_LAYER_CHASE, &chase, 0);
+    led_play(LED_LAYER_EYE, &blink, 0);
+    led_base_wipe(0, 100, 0, LED_CHASE_ROUNDS * LED_SWEEP_MS);
+}
+
+void led_arm(bool arm){
+    if (anim_lock == NULL) {
+        return;
     }
+    xSemaphoreTake(anim_lock, portMAX_DELAY);
+    armed = arm;
+    xSemaphoreGive(anim_lock);
 }
 
-void led_process(void *arg){
-    led_reset();
-    gpio_set_direction(38, GPIO_MODE_OUTPUT);
-    for (int i = 0; i < 5; i++) {
-        for (int j = 1; j < 48; j += 3) {
-            // Build RGB pixels
-            led_strip_pixels[j] = 255;
-            // Flush RGB values to LEDs
-            ESP_ERROR_CHECK(rmt_transmit(led_chan, led_encoder, led_strip_pixels, sizeof(led_strip_pixels), &tx_config));
-            ESP_ERROR_CHECK(rmt_tx_wait_all_done(led_chan, portMAX_DELAY));
-            vTaskDelay(pdMS_TO_TICKS(EXAMPLE_CHASE_SPEED_MS));
-            memset(led_strip_pixels, 0, sizeof(led_strip_pixels));     
-        }
-        //flash eye leds
-        gpio_set_level(38, (i%2));
+void led_print_latency(void){
+    if (anim_lock == NULL) {
+        return;
+    }
+    act_lat_t lat[2];
+    xSemaphoreTake(anim_lock, portMAX_DELAY);
+    memcpy(lat, latency, sizeof(lat));
+    xSemaphoreGive(anim_lock);
+    act_lat_print(&lat[0], "led");
+    act_lat_print(&lat[1], "led armed");
+}
+
+void led_get_stats(int strip, led_frame_stats_t *stats){
+    if (strip >= 0 && strip < LED_STRIP_NUM) {
+        led_frame_get_stats(&strips[strip].frame, stats);
     }
-    led_color(0, 100 , 0);
-    vTaskDelete(NULL);
 }
 
 void led_eye_control(uint8_t level){
-    //clear GPIO state in case of reboot or other operation
-    gpio_reset_pin(38);
-    gpio_set_direction(38, GPIO_MODE_OUTPUT);
+    act_hal_t *eye_hal = act_hal_default();
+    act_dout_init(eye_hal, LED_EYE_GPIO);
     //toggle on/off
-    gpio_set_level(38, level);
+    act_dout_write(eye_hal, LED_EYE_GPIO, level);
 }
\ No newline at end of file
@@ -0,0 +1,105 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "led_anim.h"
+
+#define STRIP_PIXELS    (16)
+
+static uint8_t strip[STRIP_PIXELS * 3];
+
+static const uint8_t *pixel(int i)
+{
+    return &strip[i * 3];
+}
+
+TEST_CASE("led anim interpolates keyframes in fixed point", "[led_anim]")
+{
+    led_fx_t fade = {
+        .shape = LED_SHAPE_SOLID,
+        .period_ms = 200,
+        .loops = 1,
+        .key_num = 3,
+        .keys = { { 0, 0, 0, 0 }, { 100, 200, 100, 50 }, { 200, 0, 0, 0 } },
+    };
+    uint8_t grb[3];
+    led_anim_color(&fade, 50, grb);
+    TEST_ASSERT_EQUAL(100, grb[0]);
+    TEST_ASSERT_EQUAL(50, grb[1]);
+    TEST_ASSERT_EQUAL(25, grb[2]);
+    led_anim_color(&fade, 150, grb);
+    TEST_ASSERT_EQUAL(100, grb[0]);
+    led_anim_color(&fade, 500, grb);
+    TEST_ASSERT_EQUAL(0, grb[0]);
+
+    fade.flags = LED_FX_STEP;
+    led_anim_color(&fade, 199, grb);
+    TEST_ASSERT_EQUAL(200, grb[0]);
+}
+
+TEST_CASE("led anim composes layers and ends or holds effects", "[led_anim]")
+{
+    led_anim_t anim;
+    led_anim_init(&anim);
+    memset(strip, 0, sizeof(strip));
+
+    led_fx_t base = {
+        .shape = LED_SHAPE_WIPE,
+        .flags = LED_FX_HOLD,
+        .period_ms = 160,
+        .loops = 1,
+        .key_num = 1,
+        .keys = { { 0, 0, 0, 100 } },
+    };
+    led_fx_t chase = {
+        .shape = LED_SHAPE_CHASE,
+        .blend = LED_BLEND_ADD,
+        .period_ms = 160,
+        .loops = 2,
+        .key_num = 1,
+        .keys = { { 0, 0, 255, 200 } },
+    };
+    led_fx_t blink = {
+        .shape = LED_SHAPE_EYE,
+        .flags = LED_FX_STEP,
+        .period_ms = 100,
+        .loops = 1,
+        .key_num = 2,
+        .keys = { { 0, 255, 255, 255 }, { 50, 0, 0, 0 } },
+    };
+    // the wipe is queued behind a 100 ms pause
+    led_anim_play(&anim, 0, &base, 100);
+    led_anim_play(&anim, 1, &chase, 0);
+    led_anim_play(&anim, 2, &blink, 0);
+
+    TEST_ASSERT_TRUE(led_anim_render(&anim, strip, STRIP_PIXELS, 30));
+    TEST_ASSERT_EQUAL(255, pixel(3)[1]);
+    TEST_ASSERT_EQUAL(0, pixel(0)[1]);
+    TEST_ASSERT_EQUAL(1, anim.eye);
+    TEST_ASSERT_FALSE(led_anim_render(&anim, strip, STRIP_PIXELS, 35));
+
+    // wipe has lit 10 pixels, the chase adds to the one under it and saturates
+    led_anim_render(&anim, strip, STRIP_PIXELS, 200);
+    TEST_ASSERT_EQUAL(100, pixel(9)[2]);
+    TEST_ASSERT_EQUAL(0, pixel(10)[2]);
+    TEST_ASSERT_EQUAL(255, pixel(4)[2]);
+    TEST_ASSERT_EQUAL(255, pixel(4)[1]);
+    TEST_ASSERT_EQUAL(-1, anim.eye);
+
+    // chase ran its two loops, the wipe holds its last frame
+    TEST_ASSERT_TRUE(led_anim_busy(&anim));
+    led_anim_render(&anim, strip, STRIP_PIXELS, 1000);
+    for (int i = 0; i < STRIP_PIXELS; i++) {
+        TEST_ASSERT_EQUAL(0, pixel(i)[1]);
+        TEST_ASSERT_EQUAL(100, pixel(i)[2]);
+    }
+    TEST_ASSERT_FALSE(anim.layers[1].active);
+    TEST_ASSERT_FALSE(led_anim_render(&anim, strip, STRIP_PIXELS, 2000));
+
+    led_anim_stop(&anim, 0);
+    TEST_ASSERT_FALSE(led_anim_busy(&anim));
+    TEST_ASSERT_TRUE(led_anim_render(&anim, strip, STRIP_PIXELS, 2010));
+    TEST_ASSERT_EQUAL(0, pixel(15)[2]);
+}
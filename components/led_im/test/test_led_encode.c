@@ -0,0 +1,125 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "unity.h"
+#include "led_anim.h"
+#include "led_encode.h"
+#include "led_frame.h"
+
+#define RESOLUTION_HZ   (10000000)
+#define BENCH_STRIPS    (4)
+#define BENCH_PIXELS    (80)        // per strip, 320 in total
+#define BENCH_FRAMES    (200)
+#define BENCH_TICK_US   (10000)     // render tick of led_im
+#define BENCH_BUDGET_US (BENCH_TICK_US / 2)
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static led_encode_lut_t bench_lut;
+
+// what led_im does on submit, minus rmt_transmit
+static esp_err_t bench_submit(void *ctx, const uint8_t *pixels, size_t bytes)
+{
+    led_encode_frame(&bench_lut, pixels, bytes, ctx);
+    return ESP_OK;
+}
+
+TEST_CASE("led encode matches the bitwise WS2812 encoding", "[led_encode]")
+{
+    led_encode_lut_t lut;
+    led_encode_init(&lut, RESOLUTION_HZ);
+    uint32_t bit0 = led_encode_symbol(1, 3, 0, 9);
+    uint32_t bit1 = led_encode_symbol(1, 9, 0, 3);
+    TEST_ASSERT_EQUAL(0x00098003, bit0);
+    TEST_ASSERT_EQUAL(lut.reset, led_encode_symbol(0, 250, 0, 250));
+
+    uint8_t grb[6] = { 0x00, 0xFF, 0xA5, 0x5A, 0x01, 0x80 };
+    uint32_t symbols[LED_ENCODE_SYMBOLS(sizeof(grb))];
+    TEST_ASSERT_EQUAL(LED_ENCODE_SYMBOLS(sizeof(grb)), led_encode_frame(&lut, grb, sizeof(grb), symbols));
+    for (int i = 0; i < sizeof(grb); i++) {
+        for (int b = 0; b < 8; b++) {
+            uint32_t expected = (grb[i] & (0x80 >> b)) ? bit1 : bit0;
+            TEST_ASSERT_EQUAL(expected, symbols[i * 8 + b]);
+        }
+    }
+    TEST_ASSERT_EQUAL(lut.reset, symbols[sizeof(grb) * 8]);
+}
+
+TEST_CASE("led encode benchmark, render and encode 320 pixels on 4 strips", "[led_encode][bench]")
+{
+    led_frame_t strips[BENCH_STRIPS];
+    uint32_t *symbols[BENCH_STRIPS];
+    led_encode_init(&bench_lut, RESOLUTION_HZ);
+    for (int i = 0; i < BENCH_STRIPS; i++) {
+        symbols[i] = malloc(LED_ENCODE_SYMBOLS(BENCH_PIXELS * 3) * sizeof(uint32_t));
+        TEST_ASSERT_NOT_NULL(symbols[i]);
+        TEST_ESP_OK(led_frame_init(&strips[i], BENCH_PIXELS, bench_submit, symbols[i]));
+    }
+    uint8_t *canvas = calloc(BENCH_STRIPS * BENCH_PIXELS, 3);
+    TEST_ASSERT_NOT_NULL(canvas);
+
+    // a fade on every pixel with a chase over the first strip, the other strips only change when the fade steps
+    led_anim_t anim;
+    led_anim_init(&anim);
+    led_fx_t fade = {
+        .shape = LED_SHAPE_SOLID,
+        .period_ms = BENCH_FRAMES * 10,
+        .key_num = 2,
+        .keys = { { 0, 0, 0, 0 }, { BENCH_FRAMES * 10, 255, 128, 64 } },
+    };
+    led_fx_t chase = {
+        .shape = LED_SHAPE_CHASE,
+        .blend = LED_BLEND_MAX,
+        .count = BENCH_PIXELS,
+        .period_ms = BENCH_PIXELS * 10,
+        .key_num = 1,
+        .keys = { { 0, 0, 255, 0 } },
+    };
+    led_anim_play(&anim, 0, &fade, 0);
+    led_anim_play(&anim, 1, &chase, 0);
+
+    int64_t render_us = 0;
+    int64_t encode_us = 0;
+    int sent = 0;
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        int64_t t0 = now_us();
+        bool changed = led_anim_render(&anim, canvas, BENCH_STRIPS * BENCH_PIXELS, f * 10);
+        int64_t t1 = now_us();
+        for (int i = 0; i < BENCH_STRIPS; i++) {
+            if (changed) {
+                led_frame_sync(&strips[i], &canvas[i * BENCH_PIXELS * 3]);
+            }
+            sent += led_frame_tick(&strips[i], NULL, NULL);
+            led_frame_done(&strips[i]);
+        }
+        int64_t t2 = now_us();
+        render_us += t1 - t0;
+        encode_us += t2 - t1;
+    }
+    int64_t frame_us = (render_us + encode_us) / BENCH_FRAMES;
+    printf("led bench: %d pixels, render %lld us, sync and encode %lld us per frame, %lld of %d us tick, "
+           "%d strip frames sent\n", BENCH_STRIPS * BENCH_PIXELS, (long long)(render_us / BENCH_FRAMES),
+           (long long)(encode_us / BENCH_FRAMES), (long long)frame_us, BENCH_TICK_US, sent);
+    // the chase strip changes every frame, the fade moves by less than a step on some frames and
+    // those strips are skipped
+    TEST_ASSERT_TRUE(sent >= BENCH_FRAMES);
+    TEST_ASSERT_TRUE(sent < BENCH_STRIPS * BENCH_FRAMES);
+    // the led task renders, syncs and encodes every strip once per tick; half a tick is several
+    // times the table encoder's cost, a per-bit encoder or re-encoding unchanged strips exceeds it
+    TEST_ASSERT_TRUE(frame_us < BENCH_BUDGET_US);
+
+    for (int i = 0; i < BENCH_STRIPS; i++) {
+        led_frame_deinit(&strips[i]);
+        free(symbols[i]);
+    }
+    free(canvas);
+}
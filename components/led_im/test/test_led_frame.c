@@ -0,0 +1,157 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "led_frame.h"
+
+#define MOCK_PIXELS     (16)
+#define MOCK_BYTES      (MOCK_PIXELS * LED_FRAME_BYTES_PER_PIXEL)
+
+/*
+ * RMT channel as the frame engine sees it: rmt_transmit queues a buffer and returns, the strip
+ * latches it some ticks later and on_trans_done reports it
+ */
+typedef struct {
+    led_frame_t     *frame;
+    const uint8_t   *pending;       // buffer the mock RMT is still reading
+    uint8_t          shown[MOCK_BYTES];
+    int              submitted;
+    int              refuse;        // submissions to reject with ESP_FAIL
+} mock_rmt_t;
+
+static esp_err_t mock_submit(void *ctx, const uint8_t *pixels, size_t bytes)
+{
+    mock_rmt_t *rmt = ctx;
+    TEST_ASSERT_EQUAL(MOCK_BYTES, bytes);
+    TEST_ASSERT_NULL(rmt->pending);
+    if (rmt->refuse > 0) {
+        rmt->refuse--;
+        return ESP_FAIL;
+    }
+    rmt->pending = pixels;
+    rmt->submitted++;
+    return ESP_OK;
+}
+
+// the transaction finishes, the strip shows what was in the buffer at that moment
+static void mock_finish(mock_rmt_t *rmt)
+{
+    TEST_ASSERT_NOT_NULL(rmt->pending);
+    memcpy(rmt->shown, rmt->pending, MOCK_BYTES);
+    rmt->pending = NULL;
+    led_frame_done(rmt->frame);
+}
+
+// one lit pixel per tick, like the reactor chase
+static bool render_chase(void *ctx, uint8_t *pixels, size_t pixel_num, uint32_t tick)
+{
+    memset(pixels, 0, pixel_num * LED_FRAME_BYTES_PER_PIXEL);
+    pixels[(tick % pixel_num) * LED_FRAME_BYTES_PER_PIXEL + 1] = 255;
+    return true;
+}
+
+static bool render_idle(void *ctx, uint8_t *pixels, size_t pixel_num, uint32_t tick)
+{
+    return false;
+}
+
+static void mock_init(mock_rmt_t *rmt, led_frame_t *frame)
+{
+    memset(rmt, 0, sizeof(*rmt));
+    rmt->frame = frame;
+    TEST_ESP_OK(led_frame_init(frame, MOCK_PIXELS, mock_submit, rmt));
+}
+
+TEST_CASE("led frame submits without waiting and never draws into the sent buffer", "[led_frame]")
+{
+    led_frame_t frame;
+    mock_rmt_t rmt;
+    mock_init(&rmt, &frame);
+
+    TEST_ASSERT_TRUE(led_frame_tick(&frame, render_chase, NULL));
+    TEST_ASSERT_EQUAL(1, rmt.submitted);
+    const uint8_t *sent = rmt.pending;
+    uint8_t copy[MOCK_BYTES];
+    memcpy(copy, sent, MOCK_BYTES);
+
+    // the strip is slow, ticks keep rendering into the back buffer and wait for the sink
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_FALSE(led_frame_tick(&frame, render_chase, NULL));
+        TEST_ASSERT_TRUE(led_frame_back(&frame) != sent);
+    }
+    TEST_ASSERT_EQUAL(0, memcmp(copy, sent, MOCK_BYTES));
+    mock_finish(&rmt);
+    TEST_ASSERT_EQUAL(255, rmt.shown[1]);
+
+    // the newest frame goes out on the next tick, intermediate ones are skipped
+    TEST_ASSERT_TRUE(led_frame_tick(&frame, render_chase, NULL));
+    mock_finish(&rmt);
+    TEST_ASSERT_EQUAL(255, rmt.shown[4 * LED_FRAME_BYTES_PER_PIXEL + 1]);
+    TEST_ASSERT_EQUAL(0, rmt.shown[1]);
+
+    led_frame_stats_t stats;
+    led_frame_get_stats(&frame, &stats);
+    TEST_ASSERT_EQUAL(5, stats.ticks);
+    TEST_ASSERT_EQUAL(2, stats.frames);
+    TEST_ASSERT_EQUAL(3, stats.busy);
+    led_frame_deinit(&frame);
+}
+
+TEST_CASE("led frame flush sends the frame that waited once the sink is done", "[led_frame]")
+{
+    led_frame_t frame;
+    mock_rmt_t rmt;
+    mock_init(&rmt, &frame);
+
+    // nothing changed, nothing to flush
+    TEST_ASSERT_FALSE(led_frame_flush(&frame));
+    TEST_ASSERT_TRUE(led_frame_tick(&frame, render_chase, NULL));
+    TEST_ASSERT_FALSE(led_frame_tick(&frame, render_chase, NULL));
+    TEST_ASSERT_FALSE(led_frame_flush(&frame));
+
+    // done between two ticks, the waiting frame goes out without a tick
+    mock_finish(&rmt);
+    TEST_ASSERT_TRUE(led_frame_flush(&frame));
+    TEST_ASSERT_FALSE(led_frame_flush(&frame));
+    mock_finish(&rmt);
+    TEST_ASSERT_EQUAL(255, rmt.shown[1 * LED_FRAME_BYTES_PER_PIXEL + 1]);
+    TEST_ASSERT_FALSE(led_frame_flush(&frame));
+
+    led_frame_stats_t stats;
+    led_frame_get_stats(&frame, &stats);
+    TEST_ASSERT_EQUAL(2, stats.ticks);
+    TEST_ASSERT_EQUAL(2, stats.frames);
+    TEST_ASSERT_EQUAL(1, stats.busy);
+    led_frame_deinit(&frame);
+}
+
+TEST_CASE("led frame only sends changed frames and retries refused ones", "[led_frame]")
+{
+    led_frame_t frame;
+    mock_rmt_t rmt;
+    mock_init(&rmt, &frame);
+
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_FALSE(led_frame_tick(&frame, render_idle, NULL));
+    }
+    TEST_ASSERT_EQUAL(0, rmt.submitted);
+
+    // drawn outside a render callback, the next frame starts from the one sent
+    led_frame_back(&frame)[0] = 10;
+    led_frame_mark_dirty(&frame);
+    rmt.refuse = 1;
+    TEST_ASSERT_FALSE(led_frame_tick(&frame, NULL, NULL));
+    TEST_ASSERT_TRUE(led_frame_tick(&frame, NULL, NULL));
+    mock_finish(&rmt);
+    TEST_ASSERT_EQUAL(10, rmt.shown[0]);
+    TEST_ASSERT_EQUAL(10, led_frame_back(&frame)[0]);
+    TEST_ASSERT_FALSE(led_frame_tick(&frame, NULL, NULL));
+
+    led_frame_stats_t stats;
+    led_frame_get_stats(&frame, &stats);
+    TEST_ASSERT_EQUAL(1, stats.frames);
+    TEST_ASSERT_EQUAL(1, stats.errors);
+    led_frame_deinit(&frame);
+}
@@ -0,0 +1,93 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "unity.h"
+#include "led_gamma.h"
+
+#define BENCH_BYTES     (320 * 3)
+#define BENCH_FRAMES    (200)
+#define BENCH_TICK_US   (10000)     // render tick of led_im
+#define BENCH_BUDGET_US (BENCH_TICK_US / 10)
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+TEST_CASE("led gamma table is monotonic and spans the full range", "[led_gamma]")
+{
+    TEST_ASSERT_EQUAL(0, led_gamma_lut[0]);
+    TEST_ASSERT_EQUAL(255 << 8, led_gamma_lut[255]);
+    for (int i = 1; i < 256; i++) {
+        TEST_ASSERT_TRUE(led_gamma_lut[i] >= led_gamma_lut[i - 1]);
+    }
+    // mid grey is about a fifth of full duty at gamma 2.2
+    TEST_ASSERT_INT_WITHIN(2, 55, led_gamma_lut[128] >> 8);
+}
+
+TEST_CASE("led gamma caps brightness to the current budget", "[led_gamma]")
+{
+    static uint8_t frame[BENCH_BYTES];
+    memset(frame, 255, sizeof(frame));
+    uint32_t sum = led_gamma_sum(frame, sizeof(frame));
+    // 960 channels at 20 mA is 19.2 A
+    TEST_ASSERT_EQUAL(LED_GAMMA_SCALE_FULL, led_gamma_scale(sum, 20000));
+    TEST_ASSERT_INT_WITHIN(1, LED_GAMMA_SCALE_FULL / 2, led_gamma_scale(sum, 9600));
+    TEST_ASSERT_INT_WITHIN(1, 13, led_gamma_scale(sum, 1000));
+    TEST_ASSERT_EQUAL(LED_GAMMA_SCALE_FULL, led_gamma_scale(0, 100));
+}
+
+TEST_CASE("led gamma dithers fractions to the right average", "[led_gamma]")
+{
+    uint8_t in[3] = { 50, 128, 255 };
+    uint8_t out[3];
+    uint8_t residual[3] = { 0 };
+    uint32_t total[3] = { 0 };
+    for (int f = 0; f < 256; f++) {
+        TEST_ASSERT_TRUE(led_gamma_apply(in, out, residual, sizeof(in), LED_GAMMA_SCALE_FULL / 2));
+        for (int c = 0; c < 3; c++) {
+            total[c] += out[c];
+        }
+    }
+    // over 256 frames the output adds up to the exact 8.8 value, within the fraction left over
+    for (int c = 0; c < 3; c++) {
+        uint32_t exact = (led_gamma_lut[in[c]] * (LED_GAMMA_SCALE_FULL / 2)) >> 8;
+        TEST_ASSERT_INT_WITHIN(1, exact, total[c]);
+    }
+
+    uint8_t black[3] = { 0 };
+    TEST_ASSERT_FALSE(led_gamma_apply(black, out, residual, sizeof(black), LED_GAMMA_SCALE_FULL));
+}
+
+TEST_CASE("led gamma benchmark, 320 pixels per frame", "[led_gamma][bench]")
+{
+    uint8_t *in = malloc(BENCH_BYTES);
+    uint8_t *out = malloc(BENCH_BYTES);
+    uint8_t *residual = calloc(1, BENCH_BYTES);
+    TEST_ASSERT_TRUE(in && out && residual);
+    for (int i = 0; i < BENCH_BYTES; i++) {
+        in[i] = i * 7;
+    }
+    int64_t start = now_us();
+    uint32_t check = 0;
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        uint16_t scale = led_gamma_scale(led_gamma_sum(in, BENCH_BYTES), 1000);
+        led_gamma_apply(in, out, residual, BENCH_BYTES, scale);
+        check += out[f % BENCH_BYTES];
+    }
+    int64_t per_frame = (now_us() - start) / BENCH_FRAMES;
+    printf("led gamma bench: %d bytes, %lld of %d us tick per frame (%lu)\n", BENCH_BYTES, (long long)per_frame,
+           BENCH_TICK_US, (unsigned long)check);
+    // gamma, scale and dither run on the submit path of every strip frame; a tenth of the tick for
+    // 320 pixels is about 3 us per pixel, loose for the table lookups but not for per-pixel float math
+    TEST_ASSERT_TRUE(per_frame < BENCH_BUDGET_US);
+    free(in);
+    free(out);
+    free(residual);
+}
@@ -0,0 +1,118 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "led_frame.h"
+#include "led_encode.h"
+#include "act_sim.h"
+
+#define SIM_TICK_US     (10000)
+#define SIM_TICKS       (100)
+
+static const uint16_t sim_pixels[] = { 60, 400 };
+#define SIM_STRIPS      ((int)(sizeof(sim_pixels) / sizeof(sim_pixels[0])))
+
+static led_encode_lut_t sim_lut;
+
+typedef struct {
+    act_hal_t  *hal;
+    int         id;
+    led_frame_t frame;
+} sim_strip_t;
+
+static esp_err_t sim_submit(void *ctx, const uint8_t *pixels, size_t bytes)
+{
+    sim_strip_t *strip = ctx;
+    return act_strip_send(strip->hal, strip->id, pixels, bytes);
+}
+
+static size_t sim_encode(void *ctx, const uint8_t *grb, size_t bytes, uint32_t *symbols)
+{
+    return led_encode_frame(&sim_lut, grb, bytes, symbols);
+}
+
+// the led task is woken by the done ISR and sends the frame that waited right away
+static void sim_done(void *ctx)
+{
+    led_frame_done(ctx);
+    led_frame_flush(ctx);
+}
+
+// a different frame every tick
+static bool sim_render(void *ctx, uint8_t *pixels, size_t pixel_num, uint32_t tick)
+{
+    memset(pixels, tick & 0xff, pixel_num * LED_FRAME_BYTES_PER_PIXEL);
+    return true;
+}
+
+TEST_CASE("led frames through simulated strips at wire speed", "[led_sim]")
+{
+    act_sim_t sim;
+    TEST_ASSERT_EQUAL(ESP_OK, act_sim_init(&sim, 512));
+    led_encode_init(&sim_lut, ACT_STRIP_RESOLUTION_HZ);
+    static sim_strip_t strips[SIM_STRIPS];
+    act_strip_cfg_t cfg[SIM_STRIPS];
+    for (int i = 0; i < SIM_STRIPS; i++) {
+        strips[i].hal = &sim.hal;
+        strips[i].id = i;
+        TEST_ASSERT_EQUAL(ESP_OK, led_frame_init(&strips[i].frame, sim_pixels[i], sim_submit, &strips[i]));
+        cfg[i] = (act_strip_cfg_t) {
+            .gpio_num = 8 + i,
+            .pixel_num = sim_pixels[i],
+            .encode = sim_encode,
+            .symbol_num = LED_ENCODE_SYMBOLS(sim_pixels[i] * LED_FRAME_BYTES_PER_PIXEL),
+            .done = sim_done,
+            .done_ctx = &strips[i].frame,
+        };
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, act_strip_init(&sim.hal, cfg, SIM_STRIPS, true));
+
+    for (int t = 0; t < SIM_TICKS; t++) {
+        for (int i = 0; i < SIM_STRIPS; i++) {
+            led_frame_tick(&strips[i].frame, sim_render, NULL);
+        }
+        act_sim_advance(&sim, SIM_TICK_US);
+    }
+
+    // the reactor is out well within a tick, the long strip takes longer than one and
+    // keeps the wire busy with the newest frame instead of waiting for the next tick
+    led_frame_stats_t stats[SIM_STRIPS];
+    for (int i = 0; i < SIM_STRIPS; i++) {
+        led_frame_get_stats(&strips[i].frame, &stats[i]);
+        printf("led sim: strip %d, %d pixels, %u frames, %u busy, %d us on the wire\n", i, sim_pixels[i],
+               (unsigned)stats[i].frames, (unsigned)stats[i].busy,
+               (int)act_sim_strip_time_us(sim_pixels[i] * LED_FRAME_BYTES_PER_PIXEL));
+        TEST_ASSERT_EQUAL(SIM_TICKS, stats[i].ticks);
+        TEST_ASSERT_EQUAL(0, stats[i].errors);
+    }
+    TEST_ASSERT_TRUE(act_sim_strip_time_us(sim_pixels[1] * LED_FRAME_BYTES_PER_PIXEL) > SIM_TICK_US);
+    TEST_ASSERT_EQUAL(SIM_TICKS, stats[0].frames);
+    TEST_ASSERT_EQUAL(0, stats[0].busy);
+    TEST_ASSERT_TRUE(stats[1].frames * 1000000LL >= 60LL * SIM_TICKS * SIM_TICK_US);
+
+    // frames leave on the tick or the moment the last one is out, done is reported once they are on the wire
+    TEST_ASSERT_EQUAL(0, sim.dropped);
+    int64_t sent_us[SIM_STRIPS] = { -1, -1 };
+    int64_t done_us[SIM_STRIPS] = { -1, -1 };
+    for (size_t i = 0; i < sim.event_num; i++) {
+        const act_event_t *e = &sim.events[i];
+        if (e->kind == ACT_EVENT_STRIP) {
+            TEST_ASSERT_TRUE(e->t_us % SIM_TICK_US == 0 || e->t_us == done_us[e->id]);
+            sent_us[e->id] = e->t_us;
+        } else {
+            TEST_ASSERT_EQUAL(ACT_EVENT_STRIP_DONE, e->kind);
+            TEST_ASSERT_EQUAL(sent_us[e->id] + act_sim_strip_time_us(sim_pixels[e->id] * LED_FRAME_BYTES_PER_PIXEL), e->t_us);
+            done_us[e->id] = e->t_us;
+        }
+    }
+    // the strip shows the front buffer, the back one is drawn on
+    const led_frame_t *frame = &strips[1].frame;
+    TEST_ASSERT_EQUAL_MEMORY(frame->buf[frame->front], sim.strips[1].frame, sim_pixels[1] * LED_FRAME_BYTES_PER_PIXEL);
+
+    for (int i = 0; i < SIM_STRIPS; i++) {
+        led_frame_deinit(&strips[i].frame);
+    }
+    act_sim_deinit(&sim);
+}
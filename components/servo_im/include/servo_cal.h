@@ -0,0 +1,80 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "servo_motion.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SERVO_CAL_MAX_DEG   (180)                   /*!< Joint angles run from 0 to this */
+#define SERVO_CAL_LUT_SIZE  (SERVO_CAL_MAX_DEG + 1) /*!< One duty per whole degree */
+#define SERVO_CAL_VERSION   (1)
+
+/**
+ * @brief Calibration of one channel, stored as is in NVS, so only append fields and bump the version
+ *
+ * The joint angle given to the motion engine is clamped to the soft limits, mirrored when the
+ * servo is mounted the other way round, trimmed by the offset and then mapped linearly onto the
+ * pulse range of the servo.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  version;       /*!< SERVO_CAL_VERSION */
+    uint8_t  invert;        /*!< Servo turns the other way for the same joint angle */
+    uint16_t min_us;        /*!< Pulse width at servo angle 0 */
+    uint16_t max_us;        /*!< Pulse width at servo angle `range_deg` */
+    uint16_t range_deg;     /*!< Travel between `min_us` and `max_us` */
+    int16_t  offset;        /*!< Added to the joint angle, tenths of a degree, trims a horn off by a spline */
+    uint16_t limit_lo;      /*!< Lowest joint angle the mechanics allow, tenths of a degree */
+    uint16_t limit_hi;      /*!< Highest joint angle the mechanics allow, tenths of a degree */
+} servo_cal_t;
+
+#define SERVO_CAL_DEFAULT() {                           \
+    .version = SERVO_CAL_VERSION,                       \
+    .invert = 0,                                        \
+    .min_us = 500,                                      \
+    .max_us = 2500,                                     \
+    .range_deg = 180,                                   \
+    .offset = 0,                                        \
+    .limit_lo = 0,                                      \
+    .limit_hi = SERVO_CAL_MAX_DEG * SERVO_ANGLE_SCALE,  \
+}
+
+/**
+ * @brief LEDC duty for every whole degree of joint angle, limits included
+ */
+typedef struct {
+    uint16_t duty[SERVO_CAL_LUT_SIZE];
+} servo_cal_lut_t;
+
+/**
+ * @return false when the record is from another version or its ranges make no sense
+ */
+bool servo_cal_valid(const servo_cal_t *cal);
+
+/**
+ * @brief Work out the table for a PWM of `period_us` with `duty_bits` of resolution, integer only
+ */
+void servo_cal_build(const servo_cal_t *cal, uint32_t period_us, uint32_t duty_bits, servo_cal_lut_t *lut);
+
+/**
+ * @brief Duty for a joint angle in tenths of a degree, interpolated between whole degrees
+ */
+static inline uint32_t servo_cal_duty(const servo_cal_lut_t *lut, uint16_t angle)
+{
+    if (angle >= SERVO_CAL_MAX_DEG * SERVO_ANGLE_SCALE) {
+        return lut->duty[SERVO_CAL_MAX_DEG];
+    }
+    uint32_t deg = angle / SERVO_ANGLE_SCALE;
+    int32_t frac = angle % SERVO_ANGLE_SCALE;
+    int32_t d0 = lut->duty[deg];
+    return d0 + ((int32_t)lut->duty[deg + 1] - d0) * frac / SERVO_ANGLE_SCALE;
+}
+
+#ifdef __cplusplus
+}
+#endif
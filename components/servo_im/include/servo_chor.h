@@ -0,0 +1,78 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "servo_motion.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SERVO_CHOR_MAGIC    (0x4353)    /*!< "SC" as little endian bytes */
+
+/**
+ * @brief Sequence data, 16 bit words so it can stay in flash as a const array or a partition
+ *
+ * The header is followed by one block per track, a track header and its keys:
+ *
+ *     SERVO_CHOR(2),
+ *     SERVO_CHOR_TRACK(0, SERVO_PROFILE_SCURVE, 2), SERVO_CHOR_KEY(300, 90), SERVO_CHOR_KEY(800, 0),
+ *     SERVO_CHOR_TRACK(1, SERVO_PROFILE_SCURVE, 1), SERVO_CHOR_KEY(800, 180),
+ *
+ * A key is the angle a channel reaches `t_ms` after the start, moving there from the previous
+ * key with the track's profile. The first segment starts at 0 from wherever the servo is.
+ */
+#define SERVO_CHOR(track_num)                       SERVO_CHOR_MAGIC, (track_num)
+#define SERVO_CHOR_TRACK(channel, profile, key_num) ((channel) | (profile) << 8), (key_num)
+#define SERVO_CHOR_KEY(t_ms, degrees)               (t_ms), ((degrees) * SERVO_ANGLE_SCALE)
+
+typedef struct {
+    const uint16_t *keys;       /*!< t_ms, angle pairs inside the sequence data */
+    uint8_t         channel;
+    uint8_t         profile;    /*!< servo_profile_t */
+    uint8_t         key_num;
+    uint8_t         next;       /*!< Next key to hand to the motion engine */
+} servo_chor_track_t;
+
+/**
+ * @brief One sequence playing on a motion engine, points into the sequence data
+ */
+typedef struct {
+    servo_chor_track_t tracks[SERVO_MOTION_CHANNELS];
+    uint8_t            track_num;
+    uint32_t           mask;        /*!< Channels with a track */
+    uint32_t           length_ms;   /*!< Time of the last key */
+    uint32_t           start_ms;
+    bool               playing;
+} servo_chor_t;
+
+/**
+ * @brief Check `data` and point `chor` at it, `data` has to outlive the playback
+ *
+ * @return false on a bad magic, a track past the end of the data, a channel out of range or
+ *         used twice, an unknown profile, or keys out of order
+ */
+bool servo_chor_load(servo_chor_t *chor, const uint16_t *data, size_t words);
+
+/**
+ * @brief Start every track at `now_ms`, the first segments go to `motion` right away
+ */
+void servo_chor_start(servo_chor_t *chor, servo_motion_t *motion, uint32_t now_ms);
+
+/**
+ * @brief Hand every segment that has started by `now_ms` to `motion`, call before `servo_motion_tick`
+ *
+ * Segments are timed from the sequence start, not from the tick that hands them over, so all
+ * tracks stay in step however late the tick runs.
+ *
+ * @return true while a track has keys left or a channel of the sequence is still moving
+ */
+bool servo_chor_step(servo_chor_t *chor, servo_motion_t *motion, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,8 +1,40 @@
 #ifndef SERVO_IM_H
 #define SERVO_IM_H
 
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "servo_motion.h"
+#include "servo_chor.h"
+#include "servo_cal.h"
+
+// bits of servo_wait, one per channel set when its move is done
+#define SERVO_EVENT_DONE(ch)    (1 << (ch))
+// all moves done, the PWM signal is cut unless the servos are armed
+#define SERVO_EVENT_IDLE        (1 << SERVO_MOTION_CHANNELS)
+// the sequence started by servo_play is done
+#define SERVO_EVENT_CHOR        (1 << (SERVO_MOTION_CHANNELS + 1))
+
 void sr_servo_init(void);
+
+// start moving a servo to angle (degrees) over duration_ms and return right away,
+// a move while one is running retargets from the current position
+esp_err_t servo_move(uint8_t channel, uint16_t angle, uint32_t duration_ms, servo_profile_t profile);
+// start a sequence built with the SERVO_CHOR macros and return right away, the data stays in use
+// while it plays so it has to be static, a const array is read straight from flash
+esp_err_t servo_play(const uint16_t *data, size_t words);
+// save the calibration of a channel to NVS and use it from the next tick on
+esp_err_t servo_calibrate(uint8_t channel, const servo_cal_t *cal);
+// keep the PWM signal running with every servo holding its position, so a command that may
+// follow is latched at the next period instead of after a timer start, disarming cuts the
+// signal once nothing moves
+esp_err_t servo_arm(bool arm);
+// request to new duty latency, with and without arming
+void servo_print_latency(void);
+// wait until all bits in events are set, ESP_ERR_TIMEOUT otherwise
+esp_err_t servo_wait(uint32_t events, TickType_t timeout);
+
 void helmet_close(void);
 void helmet_open(void);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,82 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SERVO_MOTION_CHANNELS   (8)     /*!< LEDC channels of one speed mode */
+#define SERVO_ANGLE_SCALE       (10)    /*!< Angles are in tenths of a degree */
+
+typedef enum {
+    SERVO_PROFILE_TRAPEZOID = 0,    /*!< Constant acceleration over the first and last quarter, constant speed between */
+    SERVO_PROFILE_SCURVE,           /*!< Smootherstep, acceleration also starts and ends at zero */
+} servo_profile_t;
+
+/**
+ * @brief Set the outputs of the channels in `mask` to `angles[channel]`, tenths of a degree
+ *
+ * Called once per tick with every channel that changed, so they can be latched together.
+ */
+typedef void (*servo_motion_write_t)(void *ctx, uint32_t mask, const uint16_t *angles);
+
+typedef struct {
+    uint16_t from;
+    uint16_t to;
+    uint16_t angle;         /*!< Last written angle */
+    uint8_t  profile;       /*!< servo_profile_t */
+    bool     known;         /*!< `angle` was written at least once */
+    bool     moving;
+    uint32_t start_ms;
+    uint32_t duration_ms;
+} servo_track_t;
+
+/**
+ * @brief Trajectories of all channels, advanced by `servo_motion_tick`
+ *
+ * Keeps no time of its own and does not lock, the caller serialises moves and ticks.
+ */
+typedef struct {
+    servo_track_t        tracks[SERVO_MOTION_CHANNELS];
+    servo_motion_write_t write;
+    void                *write_ctx;
+} servo_motion_t;
+
+void servo_motion_init(servo_motion_t *motion, servo_motion_write_t write, void *write_ctx);
+
+/**
+ * @brief Move `channel` to `angle` over `duration_ms` from `now_ms` on
+ *
+ * A move replaces the running one and starts where the channel is now, so retargeting never
+ * jumps. A move that starts after the running one has ended starts from that one's target, so
+ * moves can be chained without waiting for a tick in between. The first move of a channel
+ * jumps, its position before is unknown.
+ */
+void servo_motion_move(servo_motion_t *motion, uint8_t channel, uint16_t angle, uint32_t duration_ms,
+                       servo_profile_t profile, uint32_t now_ms);
+
+/**
+ * @brief Write the position of every moving channel at `now_ms`
+ *
+ * @return Mask of the channels that reached their target on this tick
+ */
+uint32_t servo_motion_tick(servo_motion_t *motion, uint32_t now_ms);
+
+/**
+ * @return Mask of the channels still moving
+ */
+uint32_t servo_motion_busy(const servo_motion_t *motion);
+
+/**
+ * @brief Share of the distance covered at time `t` into a move, both as 0..65536 of the whole
+ */
+uint32_t servo_motion_profile(servo_profile_t profile, uint32_t t);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,35 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "servo_cal.h"
+
+#define JOINT_MAX   (SERVO_CAL_MAX_DEG * SERVO_ANGLE_SCALE)
+
+static int32_t clamp(int32_t v, int32_t lo, int32_t hi)
+{
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+bool servo_cal_valid(const servo_cal_t *cal)
+{
+    return cal->version == SERVO_CAL_VERSION && cal->invert <= 1 &&
+           cal->min_us < cal->max_us && cal->range_deg > 0 && cal->range_deg <= 360 &&
+           cal->limit_lo <= cal->limit_hi && cal->limit_hi <= JOINT_MAX &&
+           cal->offset >= -JOINT_MAX && cal->offset <= JOINT_MAX;
+}
+
+void servo_cal_build(const servo_cal_t *cal, uint32_t period_us, uint32_t duty_bits, servo_cal_lut_t *lut)
+{
+    int64_t range = cal->range_deg * SERVO_ANGLE_SCALE;
+    uint64_t den = (uint64_t)period_us * range;
+    for (int deg = 0; deg < SERVO_CAL_LUT_SIZE; deg++) {
+        int32_t a = clamp(deg * SERVO_ANGLE_SCALE, cal->limit_lo, cal->limit_hi);
+        if (cal->invert) {
+            a = JOINT_MAX - a;
+        }
+        int64_t s = clamp(a + cal->offset, 0, range);
+        // pulse width times the range, so the division happens once and rounds
+        uint64_t width = (uint64_t)cal->min_us * range + (uint64_t)(cal->max_us - cal->min_us) * s;
+        lut->duty[deg] = ((width << duty_bits) + den / 2) / den;
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include "servo_chor.h"
+
+bool servo_chor_load(servo_chor_t *chor, const uint16_t *data, size_t words)
+{
+    memset(chor, 0, sizeof(*chor));
+    if (words < 2 || data[0] != SERVO_CHOR_MAGIC || data[1] > SERVO_MOTION_CHANNELS) {
+        return false;
+    }
+    size_t pos = 2;
+    for (int i = 0; i < data[1]; i++) {
+        if (pos + 2 > words) {
+            return false;
+        }
+        servo_chor_track_t *track = &chor->tracks[i];
+        track->channel = data[pos] & 0xFF;
+        track->profile = data[pos] >> 8;
+        track->key_num = data[pos + 1] > 0xFF ? 0 : data[pos + 1];
+        track->keys = &data[pos + 2];
+        pos += 2 + 2 * (size_t)data[pos + 1];
+        if (pos > words || track->key_num == 0 || track->channel >= SERVO_MOTION_CHANNELS ||
+                (chor->mask & (1 << track->channel)) || track->profile > SERVO_PROFILE_SCURVE) {
+            return false;
+        }
+        for (int k = 1; k < track->key_num; k++) {
+            if (track->keys[2 * k] <= track->keys[2 * (k - 1)]) {
+                return false;
+            }
+        }
+        uint32_t last_ms = track->keys[2 * (track->key_num - 1)];
+        if (last_ms > chor->length_ms) {
+            chor->length_ms = last_ms;
+        }
+        chor->mask |= 1 << track->channel;
+    }
+    chor->track_num = data[1];
+    return true;
+}
+
+void servo_chor_start(servo_chor_t *chor, servo_motion_t *motion, uint32_t now_ms)
+{
+    for (int i = 0; i < chor->track_num; i++) {
+        chor->tracks[i].next = 0;
+    }
+    chor->start_ms = now_ms;
+    chor->playing = chor->track_num > 0;
+    servo_chor_step(chor, motion, now_ms);
+}
+
+bool servo_chor_step(servo_chor_t *chor, servo_motion_t *motion, uint32_t now_ms)
+{
+    if (!chor->playing) {
+        return false;
+    }
+    uint32_t t = now_ms - chor->start_ms;
+    bool pending = false;
+    for (int i = 0; i < chor->track_num; i++) {
+        servo_chor_track_t *track = &chor->tracks[i];
+        while (track->next < track->key_num) {
+            uint32_t from_ms = track->next ? track->keys[2 * (track->next - 1)] : 0;
+            if (t < from_ms) {
+                pending = true;
+                break;
+            }
+            const uint16_t *key = &track->keys[2 * track->next];
+            servo_motion_move(motion, track->channel, key[1], key[0] - from_ms, track->profile,
+                              chor->start_ms + from_ms);
+            track->next++;
+        }
+    }
+    chor->playing = pending || (servo_motion_busy(motion) & chor->mask);
+    return chor->playing;
+}
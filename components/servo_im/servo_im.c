@@ -4,89 +4,340 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <stdio.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
 #include "esp_log.h"
-#include "driver/gpio.h"
-#include "driver/ledc.h"
 #include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_check.h"
+#include "nvs.h"
+#include "act_hal.h"
+#include "act_lat.h"
 
 // specific includes for iron man suit control
-#include "iot_servo.h"
+#include "servo_im.h"
+#include "servo_motion.h"
+#include "servo_chor.h"
+#include "servo_cal.h"
 
 static const char *TAG = "MK39 Servo Control";
 
 #define SERVO1_PULSE_GPIO             4        // GPIO connects to the PWM signal line
 #define SERVO2_PULSE_GPIO             5        // GPIO connects to the PWM signal line
 
-// Configure the servos
-servo_config_t servo_helmet_cfg = {
-    .max_angle = 180,
-    .min_width_us = 500,
-    .max_width_us = 2500,
-    .freq = 50,
-    .timer_number = LEDC_TIMER_0,
-    .channels = {
-        .servo_pin = {
-            SERVO1_PULSE_GPIO,
-            SERVO2_PULSE_GPIO,
-        },
-        .ch = {
-            LEDC_CHANNEL_0,
-            LEDC_CHANNEL_1,
-        },
+#define SERVO_TICK_MS                 20       // one 50 Hz PWM period, the servo cannot see faster updates
+#define SERVO_SETTLE_MS               100      // keep driving the target this long before the signal is cut
+
+#define SERVO_FREQ_HZ                 50
+#define SERVO_PERIOD_US               (1000000 / SERVO_FREQ_HZ)
+#define SERVO_DUTY_BITS               14       // about 0.1 degree per step over a 2 ms pulse range
+#define SERVO_CAL_NAMESPACE           "servo_cal"
+
+static const int servo_gpio[] = {
+    SERVO1_PULSE_GPIO,
+    SERVO2_PULSE_GPIO,
+};
+#define SERVO_CHANNEL_NUM             ((int)(sizeof(servo_gpio) / sizeof(servo_gpio[0])))
+
+// used for a channel without a calibration record in NVS
+static const servo_cal_t servo_cal_default[SERVO_CHANNEL_NUM] = {
+    SERVO_CAL_DEFAULT(),
+    // motors are mounted in opposite orientations
+    // one clockwise and the other counterclockwise for the same angle
+    {
+        .version = SERVO_CAL_VERSION,
+        .invert = 1,
+        .min_us = 500,
+        .max_us = 2500,
+        .range_deg = 180,
+        .offset = 0,
+        .limit_lo = 0,
+        .limit_hi = SERVO_CAL_MAX_DEG * SERVO_ANGLE_SCALE,
     },
-    .channel_number = 2,
 };
 
+static servo_cal_lut_t servo_lut[SERVO_CHANNEL_NUM];
+
+// both helmet servos take the same joint angle, the calibration of servo 2 mirrors it
+static const uint16_t helmet_open_chor[] = {
+    SERVO_CHOR(2),
+    SERVO_CHOR_TRACK(0, SERVO_PROFILE_SCURVE, 1), SERVO_CHOR_KEY(500, 0),
+    SERVO_CHOR_TRACK(1, SERVO_PROFILE_SCURVE, 1), SERVO_CHOR_KEY(500, 0),
+};
+
+static const uint16_t helmet_close_chor[] = {
+    SERVO_CHOR(2),
+    SERVO_CHOR_TRACK(0, SERVO_PROFILE_TRAPEZOID, 1), SERVO_CHOR_KEY(300, 150),
+    SERVO_CHOR_TRACK(1, SERVO_PROFILE_TRAPEZOID, 1), SERVO_CHOR_KEY(300, 150),
+};
+
+static act_hal_t *hal;
+static servo_motion_t motion;
+static servo_chor_t chor;
+static SemaphoreHandle_t motion_lock = NULL;
+static EventGroupHandle_t motion_events = NULL;
+static esp_timer_handle_t motion_timer = NULL;
+static bool motion_running = false;
+static uint32_t idle_since_ms = 0;
+static bool pwm_on = false;
+static int64_t pwm_on_us = 0;           // start of the first period, the timer restarts when enabled
+static bool armed = false;
+static act_lat_t latency[2];            // request to new duty latched, disarmed and armed
+
+static uint32_t servo_now_ms(void)
+{
+    return (uint32_t)(act_now_us(hal) / 1000);
+}
+
+static void servo_write(void *ctx, uint32_t mask, const uint16_t *angles)
+{
+    uint32_t duty[SERVO_CHANNEL_NUM];
+    for (int ch = 0; ch < SERVO_CHANNEL_NUM; ch++) {
+        duty[ch] = (mask & (1 << ch)) ? servo_cal_duty(&servo_lut[ch], angles[ch]) : 0;
+    }
+    // one batch, so the changed channels start their new pulse in the same period
+    act_pwm_write(hal, mask, duty);
+}
+
+static void servo_cal_load(void)
+{
+    nvs_handle_t nvs;
+    bool opened = nvs_open(SERVO_CAL_NAMESPACE, NVS_READONLY, &nvs) == ESP_OK;
+    for (int ch = 0; ch < SERVO_CHANNEL_NUM; ch++) {
+        servo_cal_t cal = servo_cal_default[ch];
+        if (opened) {
+            char key[8];
+            servo_cal_t stored;
+            size_t size = sizeof(stored);
+            snprintf(key, sizeof(key), "ch%d", ch);
+            if (nvs_get_blob(nvs, key, &stored, &size) == ESP_OK && size == sizeof(stored) && servo_cal_valid(&stored)) {
+                cal = stored;
+                ESP_LOGI(TAG, "Servo %d calibration from NVS", ch);
+            }
+        }
+        servo_cal_build(&cal, 1000000 / SERVO_FREQ_HZ, SERVO_DUTY_BITS, &servo_lut[ch]);
+    }
+    if (opened) {
+        nvs_close(nvs);
+    }
+}
+
+// call with motion_lock held
+static void servo_pwm_enable(bool on)
+{
+    if (on != pwm_on) {
+        act_pwm_enable(hal, on);
+        pwm_on = on;
+        pwm_on_us = act_now_us(hal);
+    }
+}
+
+// call with motion_lock held
+static void servo_motion_run(void)
+{
+    servo_pwm_enable(true);
+    if (!motion_running) {
+        esp_timer_start_periodic(motion_timer, SERVO_TICK_MS * 1000);
+        motion_running = true;
+    }
+}
+
+// call with motion_lock held, after the first duty of a request went out
+static void servo_latency_add(int64_t request_us, bool was_armed)
+{
+    // a duty written now is latched at the next period the timer starts
+    int64_t now_us = act_now_us(hal);
+    int64_t latch_us = pwm_on_us + ((now_us - pwm_on_us) / SERVO_PERIOD_US + 1) * SERVO_PERIOD_US;
+    act_lat_add(&latency[was_armed], latch_us - request_us);
+}
+
+// call with motion_lock held
+static void servo_motion_step(uint32_t now)
+{
+    if (chor.playing && !servo_chor_step(&chor, &motion, now)) {
+        xEventGroupSetBits(motion_events, SERVO_EVENT_CHOR);
+    }
+    uint32_t done = servo_motion_tick(&motion, now);
+    if (done) {
+        idle_since_ms = now;
+        xEventGroupSetBits(motion_events, done);
+    }
+}
+
+static void servo_motion_cb(void *arg)
+{
+    uint32_t now = servo_now_ms();
+    xSemaphoreTake(motion_lock, portMAX_DELAY);
+    servo_motion_step(now);
+    // servos will be disabled after each motion to
+    // avoid overheating due to misalignment in printed parts
+    if (servo_motion_busy(&motion) == 0 && !chor.playing && now - idle_since_ms >= SERVO_SETTLE_MS) {
+        esp_timer_stop(motion_timer);
+        // an armed servo keeps holding its position for the command that may follow
+        if (!armed) {
+            servo_pwm_enable(false);
+        }
+        motion_running = false;
+        xEventGroupSetBits(motion_events, SERVO_EVENT_IDLE);
+    }
+    xSemaphoreGive(motion_lock);
+}
+
 void sr_servo_init(void)
 {
     ESP_LOGI(TAG, "Servo Setup");
 
+    servo_cal_load();
+
     //Initialize the servos
-    iot_servo_init(LEDC_LOW_SPEED_MODE, &servo_helmet_cfg);
+    hal = act_hal_default();
+    ESP_ERROR_CHECK(act_pwm_init(hal, servo_gpio, SERVO_CHANNEL_NUM, SERVO_FREQ_HZ, SERVO_DUTY_BITS));
+    // no signal until the first move
+    act_pwm_enable(hal, false);
+
+    servo_motion_init(&motion, servo_write, NULL);
+    motion_lock = xSemaphoreCreateMutex();
+    motion_events = xEventGroupCreate();
+    const esp_timer_create_args_t timer_args = {
+        .callback = servo_motion_cb,
+        .name = "servo",
+    };
+    if (motion_lock == NULL || motion_events == NULL || esp_timer_create(&timer_args, &motion_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Servo motion engine failed to start");
+        return;
+    }
+    xEventGroupSetBits(motion_events, SERVO_EVENT_IDLE);
 }
 
-void helmet_open(void)
+esp_err_t servo_move(uint8_t channel, uint16_t angle, uint32_t duration_ms, servo_profile_t profile)
 {
-    // servos will be disabled after each motion to 
-    // avoid overheating due to misalignment in printed parts
-    // initialize on each action
-    
-    ledc_timer_resume(LEDC_LOW_SPEED_MODE, LEDC_TIMER_0);
+    ESP_RETURN_ON_FALSE(motion_timer, ESP_ERR_INVALID_STATE, TAG, "servos not initialized");
+    ESP_RETURN_ON_FALSE(channel < SERVO_CHANNEL_NUM && angle <= SERVO_CAL_MAX_DEG,
+                        ESP_ERR_INVALID_ARG, TAG, "no servo %d or angle %d out of range", channel, angle);
+    int64_t request_us = act_now_us(hal);
+    uint32_t now = (uint32_t)(request_us / 1000);
+    xSemaphoreTake(motion_lock, portMAX_DELAY);
+    bool was_armed = armed;
+    xEventGroupClearBits(motion_events, SERVO_EVENT_DONE(channel) | SERVO_EVENT_IDLE);
+    servo_motion_run();
+    servo_motion_move(&motion, channel, angle * SERVO_ANGLE_SCALE, duration_ms, profile, now);
+    // the first step goes out now instead of on the next timer tick
+    servo_motion_step(now);
+    servo_latency_add(request_us, was_armed);
+    xSemaphoreGive(motion_lock);
+    return ESP_OK;
+}
 
-    ESP_LOGI(TAG, "Open Sequence");
+esp_err_t servo_play(const uint16_t *data, size_t words)
+{
+    ESP_RETURN_ON_FALSE(motion_timer, ESP_ERR_INVALID_STATE, TAG, "servos not initialized");
+    servo_chor_t next;
+    ESP_RETURN_ON_FALSE(servo_chor_load(&next, data, words) && (next.mask >> SERVO_CHANNEL_NUM) == 0,
+                        ESP_ERR_INVALID_ARG, TAG, "bad servo sequence");
+    for (int i = 0; i < next.track_num; i++) {
+        for (int k = 0; k < next.tracks[i].key_num; k++) {
+            ESP_RETURN_ON_FALSE(next.tracks[i].keys[2 * k + 1] <= SERVO_CAL_MAX_DEG * SERVO_ANGLE_SCALE,
+                                ESP_ERR_INVALID_ARG, TAG, "servo sequence angle out of range");
+        }
+    }
+    int64_t request_us = act_now_us(hal);
+    uint32_t now = (uint32_t)(request_us / 1000);
+    xSemaphoreTake(motion_lock, portMAX_DELAY);
+    bool was_armed = armed;
+    xEventGroupClearBits(motion_events, next.mask | SERVO_EVENT_CHOR | SERVO_EVENT_IDLE);
+    servo_motion_run();
+    // a sequence still playing is dropped, its channels carry on from where they are
+    chor = next;
+    servo_chor_start(&chor, &motion, now);
+    servo_motion_step(now);
+    servo_latency_add(request_us, was_armed);
+    xSemaphoreGive(motion_lock);
+    return ESP_OK;
+}
 
-    // no smoothing function will be needed for this application
-    // direct servo angle write
-    iot_servo_write_angle(LEDC_LOW_SPEED_MODE, 0, 0);
-    // motors are mounted in opposite orientations
-    // one clockwise and the other counterclockwise for the same angle
-    iot_servo_write_angle(LEDC_LOW_SPEED_MODE, 1, 180);
-    // delay while waiting for action to complete
-    vTaskDelay(500 /  portTICK_PERIOD_MS);
-    // to avoid excessive strain on motors, kill the signal
-    ledc_timer_pause(LEDC_LOW_SPEED_MODE, LEDC_TIMER_0);
+esp_err_t servo_calibrate(uint8_t channel, const servo_cal_t *cal)
+{
+    ESP_RETURN_ON_FALSE(motion_lock, ESP_ERR_INVALID_STATE, TAG, "servos not initialized");
+    ESP_RETURN_ON_FALSE(channel < SERVO_CHANNEL_NUM && servo_cal_valid(cal), ESP_ERR_INVALID_ARG, TAG, "bad servo calibration");
+    nvs_handle_t nvs;
+    ESP_RETURN_ON_ERROR(nvs_open(SERVO_CAL_NAMESPACE, NVS_READWRITE, &nvs), TAG, "servo calibration not saved");
+    char key[8];
+    snprintf(key, sizeof(key), "ch%d", channel);
+    esp_err_t ret = nvs_set_blob(nvs, key, cal, sizeof(*cal));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    ESP_RETURN_ON_ERROR(ret, TAG, "servo calibration not saved");
+
+    servo_cal_lut_t lut;
+    servo_cal_build(cal, 1000000 / SERVO_FREQ_HZ, SERVO_DUTY_BITS, &lut);
+    // the next tick writes with the new table
+    xSemaphoreTake(motion_lock, portMAX_DELAY);
+    servo_lut[channel] = lut;
+    xSemaphoreGive(motion_lock);
+    return ESP_OK;
 }
 
-void helmet_close(void)
+esp_err_t servo_arm(bool arm)
 {
-    // servos will be disabled after each motion to 
-    // avoid overheating due to misalignment in printed parts
-    // initialize on each action
-    ledc_timer_resume(LEDC_LOW_SPEED_MODE, LEDC_TIMER_0);
+    ESP_RETURN_ON_FALSE(motion_lock, ESP_ERR_INVALID_STATE, TAG, "servos not initialized");
+    xSemaphoreTake(motion_lock, portMAX_DELAY);
+    armed = arm;
+    if (arm && !pwm_on) {
+        // the signal runs before the command, every servo with a known position holds it
+        servo_pwm_enable(true);
+        uint32_t mask = 0;
+        uint16_t angles[SERVO_MOTION_CHANNELS];
+        for (int ch = 0; ch < SERVO_CHANNEL_NUM; ch++) {
+            if (motion.tracks[ch].known) {
+                angles[ch] = motion.tracks[ch].angle;
+                mask |= 1 << ch;
+            }
+        }
+        if (mask) {
+            servo_write(NULL, mask, angles);
+        }
+    } else if (!arm && !motion_running) {
+        // a move still running cuts the signal once it settles
+        servo_pwm_enable(false);
+    }
+    xSemaphoreGive(motion_lock);
+    return ESP_OK;
+}
 
-    ESP_LOGI(TAG, "Close Sequence");
+void servo_print_latency(void)
+{
+    if (motion_lock == NULL) {
+        return;
+    }
+    act_lat_t lat[2];
+    xSemaphoreTake(motion_lock, portMAX_DELAY);
+    memcpy(lat, latency, sizeof(lat));
+    xSemaphoreGive(motion_lock);
+    act_lat_print(&lat[0], "servo");
+    act_lat_print(&lat[1], "servo armed");
+}
 
-    // no smoothing function will be needed for this application
-    // direct servo angle write
-    iot_servo_write_angle(LEDC_LOW_SPEED_MODE, 0, 150);
-    // motors are mounted in opposite orientations
-    // one clockwise and the other counterclockwise for the same angle
-    iot_servo_write_angle(LEDC_LOW_SPEED_MODE, 1, 30);
-    // delay while waiting for action to complete
-    vTaskDelay(300 /  portTICK_PERIOD_MS);
-    // to avoid excessive strain on motors, kill the signal
+esp_err_t servo_wait(uint32_t events, TickType_t timeout)
+{
+    ESP_RETURN_ON_FALSE(motion_events, ESP_ERR_INVALID_STATE, TAG, "servos not initialized");
+    EventBits_t bits = xEventGroupWaitBits(motion_events, events, pdFALSE, pdTRUE, timeout);
+    return (bits & events) == events ? ESP_OK : ESP_ERR_TIMEOUT;
+}
 
-    ledc_timer_pause(LEDC_LOW_SPEED_MODE, LEDC_TIMER_0);
-}
\ No newline at end of file
+void helmet_open(void)
+{
+    ESP_LOGI(TAG, "Open Sequence");
+    servo_play(helmet_open_chor, sizeof(helmet_open_chor) / sizeof(helmet_open_chor[0]));
+}
+
+void helmet_close(void)
+{
+    ESP_LOGI(TAG, "Close Sequence");
+    servo_play(helmet_close_chor, sizeof(helmet_close_chor) / sizeof(helmet_close_chor[0]));
+}
@@ -0,0 +1,103 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include "servo_motion.h"
+
+#define ONE     (65536)
+
+void servo_motion_init(servo_motion_t *motion, servo_motion_write_t write, void *write_ctx)
+{
+    memset(motion, 0, sizeof(*motion));
+    motion->write = write;
+    motion->write_ctx = write_ctx;
+}
+
+uint32_t servo_motion_profile(servo_profile_t profile, uint32_t t)
+{
+    if (t >= ONE) {
+        return ONE;
+    }
+    uint64_t u = t;
+    if (profile == SERVO_PROFILE_SCURVE) {
+        // u^3 (10 + u (6u - 15)), both factors at 24 fractional bits so the steps never go backwards
+        int64_t poly = ((int64_t)10 << 32) + (int64_t)u * (6 * (int64_t)u - 15 * ONE);
+        uint64_t u3 = (u * u * u) >> 24;
+        return (u3 * (uint64_t)(poly >> 8)) >> 32;
+    }
+    // a quarter of the time to reach 4/3 of the average speed, the same to stop again
+    if (u < ONE / 4) {
+        return 8 * u * u / (3ULL * ONE);
+    }
+    if (u > ONE - ONE / 4) {
+        uint64_t r = ONE - u;
+        return ONE - 8 * r * r / (3ULL * ONE);
+    }
+    return 4 * (u - ONE / 8) / 3;
+}
+
+void servo_motion_move(servo_motion_t *motion, uint8_t channel, uint16_t angle, uint32_t duration_ms,
+                       servo_profile_t profile, uint32_t now_ms)
+{
+    if (channel >= SERVO_MOTION_CHANNELS) {
+        return;
+    }
+    servo_track_t *track = &motion->tracks[channel];
+    // the running move may have ended without a tick to write its target yet
+    bool chained = track->moving && now_ms - track->start_ms >= track->duration_ms;
+    if (chained) {
+        track->from = track->to;
+    } else {
+        track->from = track->known ? track->angle : angle;
+    }
+    track->to = angle;
+    track->profile = profile;
+    track->start_ms = now_ms;
+    track->duration_ms = (track->known || chained) ? duration_ms : 0;
+    track->moving = true;
+}
+
+uint32_t servo_motion_tick(servo_motion_t *motion, uint32_t now_ms)
+{
+    uint32_t done = 0;
+    uint32_t changed = 0;
+    uint16_t angles[SERVO_MOTION_CHANNELS];
+    for (int ch = 0; ch < SERVO_MOTION_CHANNELS; ch++) {
+        servo_track_t *track = &motion->tracks[ch];
+        if (!track->moving) {
+            continue;
+        }
+        uint32_t elapsed = now_ms - track->start_ms;
+        uint16_t angle = track->to;
+        if (elapsed < track->duration_ms) {
+            uint32_t t = ((uint64_t)elapsed << 16) / track->duration_ms;
+            int32_t span = (int32_t)track->to - track->from;
+            angle = track->from + (int32_t)(((int64_t)span * servo_motion_profile(track->profile, t)) >> 16);
+        } else {
+            track->moving = false;
+            done |= 1 << ch;
+        }
+        // the servo sees one pulse per period, only changed widths are worth a duty update
+        if (angle != track->angle || !track->known) {
+            track->angle = angle;
+            track->known = true;
+            angles[ch] = angle;
+            changed |= 1 << ch;
+        }
+    }
+    if (changed) {
+        motion->write(motion->write_ctx, changed, angles);
+    }
+    return done;
+}
+
+uint32_t servo_motion_busy(const servo_motion_t *motion)
+{
+    uint32_t busy = 0;
+    for (int ch = 0; ch < SERVO_MOTION_CHANNELS; ch++) {
+        if (motion->tracks[ch].moving) {
+            busy |= 1 << ch;
+        }
+    }
+    return busy;
+}
@@ -0,0 +1,70 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include "unity.h"
+#include "servo_cal.h"
+
+#define PERIOD_US   (20000)
+#define DUTY_BITS   (14)
+
+TEST_CASE("servo cal maps joint angles onto the pulse range", "[servo_cal]")
+{
+    servo_cal_t cal = SERVO_CAL_DEFAULT();
+    TEST_ASSERT_EQUAL(14, sizeof(servo_cal_t));
+    TEST_ASSERT_TRUE(servo_cal_valid(&cal));
+    servo_cal_lut_t lut;
+    servo_cal_build(&cal, PERIOD_US, DUTY_BITS, &lut);
+    // 500, 1500 and 2500 us of a 20 ms period, the same values the host tool test expects
+    TEST_ASSERT_EQUAL(410, servo_cal_duty(&lut, 0));
+    TEST_ASSERT_EQUAL(1229, servo_cal_duty(&lut, 900));
+    TEST_ASSERT_EQUAL(2048, servo_cal_duty(&lut, 1800));
+    TEST_ASSERT_EQUAL(2048, servo_cal_duty(&lut, 2000));
+    uint32_t last = 0;
+    for (uint16_t a = 0; a <= 1800; a++) {
+        uint32_t duty = servo_cal_duty(&lut, a);
+        TEST_ASSERT_TRUE(duty >= last);
+        last = duty;
+    }
+    // tenths fall between the whole degrees
+    TEST_ASSERT_INT_WITHIN(1, (lut.duty[45] + lut.duty[46]) / 2, servo_cal_duty(&lut, 455));
+}
+
+TEST_CASE("servo cal mirrors, trims and holds joints inside their limits", "[servo_cal]")
+{
+    servo_cal_t plain_cal = SERVO_CAL_DEFAULT();
+    servo_cal_lut_t plain;
+    servo_cal_build(&plain_cal, PERIOD_US, DUTY_BITS, &plain);
+
+    servo_cal_t cal = SERVO_CAL_DEFAULT();
+    cal.invert = 1;
+    servo_cal_lut_t lut;
+    servo_cal_build(&cal, PERIOD_US, DUTY_BITS, &lut);
+    for (int deg = 0; deg < SERVO_CAL_LUT_SIZE; deg++) {
+        TEST_ASSERT_EQUAL(plain.duty[SERVO_CAL_MAX_DEG - deg], lut.duty[deg]);
+    }
+
+    cal = (servo_cal_t)SERVO_CAL_DEFAULT();
+    cal.limit_lo = 200;
+    cal.limit_hi = 1500;
+    cal.offset = -50;
+    servo_cal_build(&cal, PERIOD_US, DUTY_BITS, &lut);
+    TEST_ASSERT_EQUAL(plain.duty[15], servo_cal_duty(&lut, 0));
+    TEST_ASSERT_EQUAL(plain.duty[15], servo_cal_duty(&lut, 200));
+    TEST_ASSERT_EQUAL(plain.duty[95], servo_cal_duty(&lut, 1000));
+    TEST_ASSERT_EQUAL(plain.duty[145], servo_cal_duty(&lut, 1800));
+
+    // a trim past the end of the travel stops at the end
+    cal = (servo_cal_t)SERVO_CAL_DEFAULT();
+    cal.offset = 100;
+    servo_cal_build(&cal, PERIOD_US, DUTY_BITS, &lut);
+    TEST_ASSERT_EQUAL(plain.duty[180], servo_cal_duty(&lut, 1750));
+
+    cal = (servo_cal_t)SERVO_CAL_DEFAULT();
+    cal.version = SERVO_CAL_VERSION + 1;
+    TEST_ASSERT_FALSE(servo_cal_valid(&cal));
+    cal = (servo_cal_t)SERVO_CAL_DEFAULT();
+    cal.limit_lo = 1000;
+    cal.limit_hi = 900;
+    TEST_ASSERT_FALSE(servo_cal_valid(&cal));
+}
@@ -0,0 +1,146 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "servo_chor.h"
+
+#define TICK_MS     (20)
+#define SIM_BATCHES (128)
+
+// helmet, faceplate and a flap, the faceplate waits for the helmet to be half way
+static const uint16_t suit_open[] = {
+    SERVO_CHOR(3),
+    SERVO_CHOR_TRACK(0, SERVO_PROFILE_SCURVE, 2), SERVO_CHOR_KEY(300, 90), SERVO_CHOR_KEY(600, 0),
+    SERVO_CHOR_TRACK(2, SERVO_PROFILE_TRAPEZOID, 3), SERVO_CHOR_KEY(300, 20), SERVO_CHOR_KEY(700, 160), SERVO_CHOR_KEY(900, 160),
+    SERVO_CHOR_TRACK(5, SERVO_PROFILE_SCURVE, 1), SERVO_CHOR_KEY(450, 45),
+};
+
+static const uint16_t start_angle[SERVO_MOTION_CHANNELS] = { 1800, 0, 200, 0, 0, 0, 0, 0 };
+
+// every duty batch the PWM would have latched
+typedef struct {
+    uint32_t t_ms;
+    uint32_t mask;
+    uint16_t angles[SERVO_MOTION_CHANNELS];
+} sim_batch_t;
+
+typedef struct {
+    uint32_t    now_ms;
+    int         num;
+    sim_batch_t batch[SIM_BATCHES];
+} sim_pwm_t;
+
+static void sim_write(void *ctx, uint32_t mask, const uint16_t *angles)
+{
+    sim_pwm_t *sim = ctx;
+    TEST_ASSERT_TRUE(sim->num < SIM_BATCHES);
+    sim_batch_t *b = &sim->batch[sim->num++];
+    b->t_ms = sim->now_ms;
+    b->mask = mask;
+    memcpy(b->angles, angles, sizeof(b->angles));
+}
+
+// where a track should be `t_ms` after the start, worked out from the keys alone
+static int expected_angle(const servo_chor_track_t *track, uint32_t t_ms)
+{
+    int from = start_angle[track->channel];
+    uint32_t from_ms = 0;
+    for (int k = 0; k < track->key_num; k++) {
+        uint32_t to_ms = track->keys[2 * k];
+        int to = track->keys[2 * k + 1];
+        if (t_ms < to_ms) {
+            uint32_t u = ((uint64_t)(t_ms - from_ms) << 16) / (to_ms - from_ms);
+            return from + (int)(((int64_t)(to - from) * servo_motion_profile(track->profile, u)) >> 16);
+        }
+        from = to;
+        from_ms = to_ms;
+    }
+    return from;
+}
+
+TEST_CASE("servo chor rejects malformed sequences", "[servo_chor]")
+{
+    servo_chor_t chor;
+    TEST_ASSERT_TRUE(servo_chor_load(&chor, suit_open, sizeof(suit_open) / sizeof(suit_open[0])));
+    TEST_ASSERT_EQUAL(3, chor.track_num);
+    TEST_ASSERT_EQUAL((1 << 0) | (1 << 2) | (1 << 5), chor.mask);
+    TEST_ASSERT_EQUAL(900, chor.length_ms);
+
+    // cut off in the last track
+    TEST_ASSERT_FALSE(servo_chor_load(&chor, suit_open, sizeof(suit_open) / sizeof(suit_open[0]) - 1));
+
+    const uint16_t bad_magic[] = { 0x1234, 1, SERVO_CHOR_TRACK(0, 0, 1), SERVO_CHOR_KEY(100, 10) };
+    const uint16_t same_channel[] = {
+        SERVO_CHOR(2), SERVO_CHOR_TRACK(1, 0, 1), SERVO_CHOR_KEY(100, 10), SERVO_CHOR_TRACK(1, 0, 1), SERVO_CHOR_KEY(100, 10),
+    };
+    const uint16_t out_of_order[] = { SERVO_CHOR(1), SERVO_CHOR_TRACK(0, 0, 2), SERVO_CHOR_KEY(200, 10), SERVO_CHOR_KEY(200, 20) };
+    const uint16_t bad_profile[] = { SERVO_CHOR(1), SERVO_CHOR_TRACK(0, 9, 1), SERVO_CHOR_KEY(100, 10) };
+    const uint16_t bad_channel[] = { SERVO_CHOR(1), SERVO_CHOR_TRACK(SERVO_MOTION_CHANNELS, 0, 1), SERVO_CHOR_KEY(100, 10) };
+    TEST_ASSERT_FALSE(servo_chor_load(&chor, bad_magic, sizeof(bad_magic) / 2));
+    TEST_ASSERT_FALSE(servo_chor_load(&chor, same_channel, sizeof(same_channel) / 2));
+    TEST_ASSERT_FALSE(servo_chor_load(&chor, out_of_order, sizeof(out_of_order) / 2));
+    TEST_ASSERT_FALSE(servo_chor_load(&chor, bad_profile, sizeof(bad_profile) / 2));
+    TEST_ASSERT_FALSE(servo_chor_load(&chor, bad_channel, sizeof(bad_channel) / 2));
+}
+
+TEST_CASE("servo chor keeps tracks in step on a jittery tick", "[servo_chor]")
+{
+    static sim_pwm_t sim;
+    memset(&sim, 0, sizeof(sim));
+    servo_motion_t motion;
+    servo_motion_init(&motion, sim_write, &sim);
+    for (int ch = 0; ch < SERVO_MOTION_CHANNELS; ch++) {
+        servo_motion_move(&motion, ch, start_angle[ch], 0, SERVO_PROFILE_SCURVE, 0);
+    }
+    servo_motion_tick(&motion, 0);
+    sim.num = 0;
+
+    servo_chor_t chor;
+    TEST_ASSERT_TRUE(servo_chor_load(&chor, suit_open, sizeof(suit_open) / sizeof(suit_open[0])));
+    const uint32_t start = 1000;
+    sim.now_ms = start;
+    servo_chor_start(&chor, &motion, start);
+    servo_motion_tick(&motion, start);
+
+    // the timer callback runs up to 7 ms late, never early
+    uint32_t seed = 1;
+    uint32_t tick = start;
+    uint32_t now = start;
+    while (servo_chor_step(&chor, &motion, now)) {
+        servo_motion_tick(&motion, now);
+        tick += TICK_MS;
+        seed = seed * 1103515245 + 12345;
+        now = tick + (seed >> 16) % 8;
+        sim.now_ms = now;
+        TEST_ASSERT_TRUE(now - start < 2 * chor.length_ms);
+    }
+    printf("servo chor sim: %d duty batches, done %u ms after the start\n", sim.num, (unsigned)(now - start));
+    TEST_ASSERT_TRUE(now - start >= chor.length_ms);
+    TEST_ASSERT_TRUE(now - start < chor.length_ms + 2 * TICK_MS);
+
+    // after every batch, every channel is where its keys say it should be at that time, so a
+    // channel never starts or stops a tick after the others
+    TEST_ASSERT_TRUE(sim.num > 0);
+    uint16_t output[SERVO_MOTION_CHANNELS];
+    memcpy(output, start_angle, sizeof(output));
+    for (int b = 0; b < sim.num; b++) {
+        for (int ch = 0; ch < SERVO_MOTION_CHANNELS; ch++) {
+            if (sim.batch[b].mask & (1 << ch)) {
+                output[ch] = sim.batch[b].angles[ch];
+            }
+        }
+        for (int i = 0; i < chor.track_num; i++) {
+            const servo_chor_track_t *track = &chor.tracks[i];
+            int expected = expected_angle(track, sim.batch[b].t_ms - start);
+            TEST_ASSERT_INT_WITHIN(1, expected, output[track->channel]);
+        }
+        // channels without a track are never touched
+        TEST_ASSERT_EQUAL(0, sim.batch[b].mask & ~chor.mask);
+    }
+    TEST_ASSERT_EQUAL(0, motion.tracks[0].angle);
+    TEST_ASSERT_EQUAL(1600, motion.tracks[2].angle);
+    TEST_ASSERT_EQUAL(450, motion.tracks[5].angle);
+    TEST_ASSERT_EQUAL(0, servo_motion_busy(&motion));
+}
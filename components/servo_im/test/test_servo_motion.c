@@ -0,0 +1,122 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "servo_motion.h"
+
+#define TICK_MS     (20)
+
+// stands in for the LEDC duty update
+typedef struct {
+    uint16_t angle[SERVO_MOTION_CHANNELS];
+    int      writes[SERVO_MOTION_CHANNELS];
+} mock_pwm_t;
+
+static void mock_write(void *ctx, uint32_t mask, const uint16_t *angles)
+{
+    mock_pwm_t *pwm = ctx;
+    for (int ch = 0; ch < SERVO_MOTION_CHANNELS; ch++) {
+        if (mask & (1 << ch)) {
+            pwm->angle[ch] = angles[ch];
+            pwm->writes[ch]++;
+        }
+    }
+}
+
+TEST_CASE("servo motion profiles start and end at rest", "[servo_motion]")
+{
+    for (int p = SERVO_PROFILE_TRAPEZOID; p <= SERVO_PROFILE_SCURVE; p++) {
+        TEST_ASSERT_EQUAL(0, servo_motion_profile(p, 0));
+        TEST_ASSERT_EQUAL(65536, servo_motion_profile(p, 65536));
+        TEST_ASSERT_INT_WITHIN(1, 32768, servo_motion_profile(p, 32768));
+        uint32_t last = 0;
+        uint32_t step_start = servo_motion_profile(p, 656);
+        uint32_t step_mid = servo_motion_profile(p, 33423) - servo_motion_profile(p, 32768);
+        for (uint32_t t = 0; t <= 65536; t += 256) {
+            uint32_t s = servo_motion_profile(p, t);
+            TEST_ASSERT_TRUE(s >= last);
+            last = s;
+        }
+        // the first hundredth of the time covers far less than a hundredth of the distance
+        TEST_ASSERT_TRUE(step_start * 10 < step_mid);
+    }
+    // the trapezoid cruises at 4/3 of the average speed
+    uint32_t cruise = servo_motion_profile(SERVO_PROFILE_TRAPEZOID, 40000) - servo_motion_profile(SERVO_PROFILE_TRAPEZOID, 30000);
+    TEST_ASSERT_INT_WITHIN(2, 13333, cruise);
+}
+
+TEST_CASE("servo motion runs moves to the end without blocking", "[servo_motion]")
+{
+    mock_pwm_t pwm;
+    memset(&pwm, 0, sizeof(pwm));
+    servo_motion_t motion;
+    servo_motion_init(&motion, mock_write, &pwm);
+
+    // first move of a channel jumps
+    servo_motion_move(&motion, 0, 1500, 500, SERVO_PROFILE_SCURVE, 0);
+    servo_motion_move(&motion, 1, 300, 500, SERVO_PROFILE_SCURVE, 0);
+    TEST_ASSERT_EQUAL(0x3, servo_motion_tick(&motion, 0));
+    TEST_ASSERT_EQUAL(1500, pwm.angle[0]);
+    TEST_ASSERT_EQUAL(0, servo_motion_busy(&motion));
+
+    servo_motion_move(&motion, 0, 0, 500, SERVO_PROFILE_SCURVE, 1000);
+    servo_motion_move(&motion, 1, 1800, 500, SERVO_PROFILE_TRAPEZOID, 1000);
+    uint32_t now = 1000;
+    uint16_t last0 = pwm.angle[0];
+    uint16_t last1 = pwm.angle[1];
+    uint32_t done = 0;
+    while (done != 0x3) {
+        TEST_ASSERT_EQUAL(0x3, servo_motion_busy(&motion));
+        done |= servo_motion_tick(&motion, now);
+        TEST_ASSERT_TRUE(pwm.angle[0] <= last0);
+        TEST_ASSERT_TRUE(pwm.angle[1] >= last1);
+        last0 = pwm.angle[0];
+        last1 = pwm.angle[1];
+        if (now == 1260) {
+            // just past the middle
+            TEST_ASSERT_INT_WITHIN(100, 750, pwm.angle[0]);
+            TEST_ASSERT_INT_WITHIN(100, 1050, pwm.angle[1]);
+        }
+        now += TICK_MS;
+        TEST_ASSERT_TRUE(now <= 1520);
+    }
+    TEST_ASSERT_EQUAL(1520, now);
+    TEST_ASSERT_EQUAL(0, pwm.angle[0]);
+    TEST_ASSERT_EQUAL(1800, pwm.angle[1]);
+    TEST_ASSERT_EQUAL(0, servo_motion_busy(&motion));
+
+    // nothing moves, nothing is written
+    int writes = pwm.writes[0];
+    TEST_ASSERT_EQUAL(0, servo_motion_tick(&motion, now));
+    TEST_ASSERT_EQUAL(writes, pwm.writes[0]);
+}
+
+TEST_CASE("servo motion retargets from the current position", "[servo_motion]")
+{
+    mock_pwm_t pwm;
+    memset(&pwm, 0, sizeof(pwm));
+    servo_motion_t motion;
+    servo_motion_init(&motion, mock_write, &pwm);
+    servo_motion_move(&motion, 7, 0, 0, SERVO_PROFILE_TRAPEZOID, 0);
+    servo_motion_tick(&motion, 0);
+
+    servo_motion_move(&motion, 7, 1800, 1000, SERVO_PROFILE_TRAPEZOID, 0);
+    servo_motion_tick(&motion, 500);
+    uint16_t mid = pwm.angle[7];
+    TEST_ASSERT_INT_WITHIN(2, 900, mid);
+
+    // turn back halfway, the next tick continues from where the servo is
+    servo_motion_move(&motion, 7, 0, 400, SERVO_PROFILE_SCURVE, 500);
+    TEST_ASSERT_EQUAL(0, servo_motion_tick(&motion, 500));
+    TEST_ASSERT_EQUAL(mid, pwm.angle[7]);
+    servo_motion_tick(&motion, 520);
+    TEST_ASSERT_TRUE(mid - pwm.angle[7] < 10);
+    TEST_ASSERT_EQUAL(1 << 7, servo_motion_tick(&motion, 900));
+    TEST_ASSERT_EQUAL(0, pwm.angle[7]);
+
+    // channels past the last one are ignored
+    servo_motion_move(&motion, SERVO_MOTION_CHANNELS, 900, 100, SERVO_PROFILE_SCURVE, 0);
+    TEST_ASSERT_EQUAL(0, servo_motion_busy(&motion));
+}
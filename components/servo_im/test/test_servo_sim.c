@@ -0,0 +1,147 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "servo_chor.h"
+#include "servo_cal.h"
+#include "act_sim.h"
+#include "act_lat.h"
+
+#define SIM_TICK_US     (20000)
+#define SIM_DUTY_BITS   (14)
+
+// the helmet pair as servo_im drives it, servo 2 mirrored by its calibration
+static const uint16_t helmet_open[] = {
+    SERVO_CHOR(2),
+    SERVO_CHOR_TRACK(0, SERVO_PROFILE_SCURVE, 1), SERVO_CHOR_KEY(500, 0),
+    SERVO_CHOR_TRACK(1, SERVO_PROFILE_SCURVE, 1), SERVO_CHOR_KEY(500, 0),
+};
+
+typedef struct {
+    act_hal_t      *hal;
+    servo_cal_lut_t lut[2];
+} sim_servo_t;
+
+// same batch as servo_im hands the HAL
+static void sim_servo_write(void *ctx, uint32_t mask, const uint16_t *angles)
+{
+    sim_servo_t *servo = ctx;
+    uint32_t duty[2];
+    for (int ch = 0; ch < 2; ch++) {
+        duty[ch] = (mask & (1 << ch)) ? servo_cal_duty(&servo->lut[ch], angles[ch]) : 0;
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, act_pwm_write(servo->hal, mask, duty));
+}
+
+TEST_CASE("servo helmet sequence through the simulated PWM", "[servo_sim]")
+{
+    act_sim_t sim;
+    TEST_ASSERT_EQUAL(ESP_OK, act_sim_init(&sim, 256));
+    static const int gpio[] = { 4, 5 };
+    TEST_ASSERT_EQUAL(ESP_OK, act_pwm_init(&sim.hal, gpio, 2, 50, SIM_DUTY_BITS));
+
+    sim_servo_t servo = { .hal = &sim.hal };
+    servo_cal_t cal[2] = { SERVO_CAL_DEFAULT(), SERVO_CAL_DEFAULT() };
+    cal[1].invert = 1;
+    for (int ch = 0; ch < 2; ch++) {
+        servo_cal_build(&cal[ch], 20000, SIM_DUTY_BITS, &servo.lut[ch]);
+    }
+    servo_motion_t motion;
+    servo_motion_init(&motion, sim_servo_write, &servo);
+
+    // closed, then the open sequence on the 20 ms timer
+    for (int ch = 0; ch < 2; ch++) {
+        servo_motion_move(&motion, ch, 1500, 0, SERVO_PROFILE_SCURVE, 0);
+    }
+    servo_motion_tick(&motion, 0);
+    TEST_ASSERT_EQUAL(2, sim.event_num);
+    // mirrored mounting, one servo at 150 degrees is the other at 30
+    TEST_ASSERT_EQUAL(servo_cal_duty(&servo.lut[0], 300), sim.duty[1]);
+    act_sim_clear(&sim);
+
+    servo_chor_t chor;
+    TEST_ASSERT_TRUE(servo_chor_load(&chor, helmet_open, sizeof(helmet_open) / sizeof(helmet_open[0])));
+    act_sim_advance(&sim, SIM_TICK_US);
+    uint32_t start = act_now_us(&sim.hal) / 1000;
+    servo_chor_start(&chor, &motion, start);
+    for (;;) {
+        uint32_t now = act_now_us(&sim.hal) / 1000;
+        bool playing = servo_chor_step(&chor, &motion, now);
+        servo_motion_tick(&motion, now);
+        if (!playing && servo_motion_busy(&motion) == 0) {
+            break;
+        }
+        act_sim_advance(&sim, SIM_TICK_US);
+        TEST_ASSERT_TRUE(now - start < 2 * chor.length_ms);
+    }
+    printf("servo sim: %d duty writes in %u ms\n", (int)sim.event_num, (unsigned)(act_now_us(&sim.hal) / 1000 - start));
+
+    // every write lands on a timer tick, both servos in the same batch, and the closing
+    // servo only ever moves towards open
+    TEST_ASSERT_EQUAL(0, sim.dropped);
+    TEST_ASSERT_TRUE(sim.event_num > 2 * 500 / 20 - 4);
+    uint32_t last = servo_cal_duty(&servo.lut[0], 1500);
+    for (size_t i = 0; i < sim.event_num; i += 2) {
+        const act_event_t *e = &sim.events[i];
+        TEST_ASSERT_EQUAL(ACT_EVENT_PWM, e->kind);
+        TEST_ASSERT_EQUAL(0, e->t_us % SIM_TICK_US);
+        TEST_ASSERT_EQUAL(0, e->id);
+        TEST_ASSERT_EQUAL(1, sim.events[i + 1].id);
+        TEST_ASSERT_EQUAL(e->t_us, sim.events[i + 1].t_us);
+        TEST_ASSERT_TRUE(e->value <= last);
+        last = e->value;
+    }
+    TEST_ASSERT_EQUAL(servo.lut[0].duty[0], sim.duty[0]);
+    TEST_ASSERT_EQUAL(servo.lut[1].duty[0], sim.duty[1]);
+    TEST_ASSERT_EQUAL(servo.lut[0].duty[SERVO_CAL_MAX_DEG], sim.duty[1]);
+    act_sim_deinit(&sim);
+}
+
+// next period start after `t_us` on a timer started at `on_us`, a new duty shows from there
+static int64_t sim_latch_us(int64_t on_us, int64_t t_us)
+{
+    return on_us + ((t_us - on_us) / SIM_TICK_US + 1) * SIM_TICK_US;
+}
+
+TEST_CASE("servo commands latch sooner on an armed PWM", "[servo_sim]")
+{
+    act_sim_t sim;
+    TEST_ASSERT_EQUAL(ESP_OK, act_sim_init(&sim, 16));
+    static const int gpio[] = { 4, 5 };
+    TEST_ASSERT_EQUAL(ESP_OK, act_pwm_init(&sim.hal, gpio, 2, 50, SIM_DUTY_BITS));
+    act_pwm_enable(&sim.hal, false);
+
+    // commands arrive at any point of a period, the disarmed timer starts with the command and
+    // the armed one has been running since the wake word
+    act_lat_t lat[2];
+    memset(lat, 0, sizeof(lat));
+    uint32_t seed = 7;
+    for (int i = 0; i < 200; i++) {
+        bool armed = i & 1;
+        act_sim_clear(&sim);
+        act_sim_advance(&sim, 300000);
+        int64_t on_us = act_now_us(&sim.hal);
+        if (armed) {
+            act_pwm_enable(&sim.hal, true);
+            seed = seed * 1103515245 + 12345;
+            act_sim_advance(&sim, 500000 + (seed >> 8) % 1000000);
+        }
+        int64_t request_us = act_now_us(&sim.hal);
+        if (!armed) {
+            act_pwm_enable(&sim.hal, true);
+        }
+        const uint32_t duty[] = { 1229, 1229 };
+        act_pwm_write(&sim.hal, 0x3, duty);
+        act_lat_add(&lat[armed], sim_latch_us(on_us, sim.events[sim.event_num - 1].t_us) - request_us);
+        act_pwm_enable(&sim.hal, false);
+    }
+    act_lat_print(&lat[0], "servo sim");
+    act_lat_print(&lat[1], "servo sim armed");
+    // a full period after a start, on average half of one when armed
+    TEST_ASSERT_EQUAL(SIM_TICK_US, lat[0].sum_us / lat[0].count);
+    TEST_ASSERT_TRUE(lat[1].max_us <= SIM_TICK_US);
+    TEST_ASSERT_TRUE(lat[1].sum_us / lat[1].count < SIM_TICK_US * 3 / 4);
+    act_sim_deinit(&sim);
+}
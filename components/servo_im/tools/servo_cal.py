@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+"""
+Turn servo calibration records into NVS data or precomputed angle to duty tables.
+
+Calibration file, JSON, one entry per LEDC channel, missing fields take the defaults:
+    {"channels": [
+        {"channel": 0, "offset": -35, "limit_hi": 1650},
+        {"channel": 1, "invert": 1, "min_us": 550, "max_us": 2450}
+    ]}
+
+    invert      servo turns the other way for the same joint angle
+    min_us      pulse width at servo angle 0
+    max_us      pulse width at servo angle range_deg
+    range_deg   travel between min_us and max_us
+    offset      added to the joint angle, tenths of a degree
+    limit_lo    lowest joint angle, tenths of a degree
+    limit_hi    highest joint angle, tenths of a degree
+
+`nvs` writes a CSV for nvs_partition_gen.py with one servo_cal_t blob per channel, the
+records `sr_servo_init` loads from the `servo_cal` namespace. `header` writes the tables the
+firmware builds from those records, same integer math as servo_cal_build, for review or to
+compile in.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+VERSION = 1
+MAX_DEG = 180
+ANGLE_SCALE = 10
+CHANNELS = 8
+RECORD = struct.Struct('<BBHHHhHH')
+FIELDS = ('invert', 'min_us', 'max_us', 'range_deg', 'offset', 'limit_lo', 'limit_hi')
+DEFAULT = {
+    'invert': 0,
+    'min_us': 500,
+    'max_us': 2500,
+    'range_deg': 180,
+    'offset': 0,
+    'limit_lo': 0,
+    'limit_hi': MAX_DEG * ANGLE_SCALE,
+}
+
+
+class CalError(Exception):
+    pass
+
+
+def check(cal):
+    """Same rules as servo_cal_valid"""
+    joint_max = MAX_DEG * ANGLE_SCALE
+    if cal['invert'] not in (0, 1):
+        raise CalError('invert must be 0 or 1')
+    if not 0 <= cal['min_us'] < cal['max_us'] <= 0xFFFF:
+        raise CalError('min_us must be below max_us')
+    if not 0 < cal['range_deg'] <= 360:
+        raise CalError('range_deg must be 1 to 360')
+    if not 0 <= cal['limit_lo'] <= cal['limit_hi'] <= joint_max:
+        raise CalError('limits must be in order and within 0 to %d' % joint_max)
+    if not -joint_max <= cal['offset'] <= joint_max:
+        raise CalError('offset out of range')
+
+
+def parse(text):
+    """JSON calibration to {channel: record}"""
+    try:
+        entries = json.loads(text)['channels']
+    except (ValueError, KeyError, TypeError) as e:
+        raise CalError('not a calibration file: %s' % e)
+    cals = {}
+    for entry in entries:
+        ch = entry.get('channel')
+        if not isinstance(ch, int) or not 0 <= ch < CHANNELS or ch in cals:
+            raise CalError('bad or repeated channel %r' % ch)
+        unknown = set(entry) - set(FIELDS) - {'channel'}
+        if unknown:
+            raise CalError('channel %d: unknown fields %s' % (ch, ', '.join(sorted(unknown))))
+        cal = dict(DEFAULT, **{k: v for k, v in entry.items() if k != 'channel'})
+        try:
+            check(cal)
+        except CalError as e:
+            raise CalError('channel %d: %s' % (ch, e))
+        cals[ch] = cal
+    return cals
+
+
+def pack(cal):
+    """servo_cal_t as stored in NVS"""
+    return RECORD.pack(VERSION, *(cal[k] for k in FIELDS))
+
+
+def build_lut(cal, period_us=20000, duty_bits=14):
+    """Duty for every whole degree of joint angle, same math as servo_cal_build"""
+    joint_max = MAX_DEG * ANGLE_SCALE
+    span = cal['range_deg'] * ANGLE_SCALE
+    den = period_us * span
+    lut = []
+    for deg in range(MAX_DEG + 1):
+        a = min(max(deg * ANGLE_SCALE, cal['limit_lo']), cal['limit_hi'])
+        if cal['invert']:
+            a = joint_max - a
+        s = min(max(a + cal['offset'], 0), span)
+        width = cal['min_us'] * span + (cal['max_us'] - cal['min_us']) * s
+        lut.append(((width << duty_bits) + den // 2) // den)
+    return lut
+
+
+def nvs_csv(cals):
+    lines = ['key,type,encoding,value', 'servo_cal,namespace,,']
+    for ch in sorted(cals):
+        lines.append('ch%d,data,hex2bin,%s' % (ch, pack(cals[ch]).hex()))
+    return '\n'.join(lines) + '\n'
+
+
+def c_header(cals, period_us, duty_bits):
+    out = ['// Generated by servo_cal.py, %d us period, %d bit duty' % (period_us, duty_bits),
+           '#pragma once', '', '#include "servo_cal.h"', '']
+    for ch in sorted(cals):
+        lut = build_lut(cals[ch], period_us, duty_bits)
+        out.append('static const servo_cal_lut_t servo_cal_lut_ch%d = { .duty = {' % ch)
+        for i in range(0, len(lut), 12):
+            out.append('    ' + ' '.join('%5d,' % d for d in lut[i:i + 12]))
+        out.append('} };')
+        out.append('')
+    return '\n'.join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest='cmd', required=True)
+    nvs = sub.add_parser('nvs', help='Write the NVS partition CSV')
+    nvs.add_argument('cal', help='Calibration file, JSON')
+    nvs.add_argument('-o', '--output', required=True, help='CSV for nvs_partition_gen.py')
+    header = sub.add_parser('header', help='Write the angle to duty tables as a C header')
+    header.add_argument('cal', help='Calibration file, JSON')
+    header.add_argument('-o', '--output', required=True, help='C header')
+    header.add_argument('--period-us', type=int, default=20000, help='PWM period, 20000 for 50 Hz')
+    header.add_argument('--duty-bits', type=int, default=14, help='LEDC duty resolution')
+    args = parser.parse_args()
+
+    try:
+        with open(args.cal) as f:
+            cals = parse(f.read())
+    except CalError as e:
+        sys.exit('%s: %s' % (args.cal, e))
+    with open(args.output, 'w') as f:
+        if args.cmd == 'nvs':
+            f.write(nvs_csv(cals))
+        else:
+            f.write(c_header(cals, args.period_us, args.duty_bits))
+    for ch in sorted(cals):
+        lut = build_lut(cals[ch])
+        print('servo %d: duty %5d at 0, %5d at %d degrees' % (ch, lut[0], lut[-1], MAX_DEG))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+"""
+Host test for servo_cal.py, run by `python3 -m unittest` inside tools
+"""
+
+import json
+import unittest
+
+import servo_cal as cal
+
+
+class TestServoCal(unittest.TestCase):
+
+    def test_default_lut(self):
+        lut = cal.build_lut(dict(cal.DEFAULT))
+        self.assertEqual(len(lut), cal.MAX_DEG + 1)
+        # 500 us and 2500 us of a 20 ms period at 14 bits, the same values test_servo_cal.c expects
+        self.assertEqual(lut[0], 410)
+        self.assertEqual(lut[90], 1229)
+        self.assertEqual(lut[180], 2048)
+        self.assertEqual(lut, sorted(lut))
+
+    def test_invert_offset_and_limits(self):
+        plain = cal.build_lut(dict(cal.DEFAULT))
+        inverted = cal.build_lut(dict(cal.DEFAULT, invert=1))
+        self.assertEqual(inverted, plain[::-1])
+        limited = cal.build_lut(dict(cal.DEFAULT, limit_lo=200, limit_hi=1500, offset=-50))
+        self.assertEqual(limited[0], limited[20])
+        self.assertEqual(limited[150], limited[180])
+        self.assertEqual(limited[20], plain[15])
+        self.assertEqual(limited[150], plain[145])
+
+    def test_record_and_csv(self):
+        cals = cal.parse(json.dumps({'channels': [{'channel': 1, 'invert': 1, 'offset': -35}]}))
+        record = cal.pack(cals[1])
+        # sizeof(servo_cal_t)
+        self.assertEqual(len(record), 14)
+        self.assertEqual(record[:2], bytes([cal.VERSION, 1]))
+        csv = cal.nvs_csv(cals).splitlines()
+        self.assertEqual(csv[1], 'servo_cal,namespace,,')
+        self.assertEqual(csv[2], 'ch1,data,hex2bin,' + record.hex())
+        header = cal.c_header(cals, 20000, 14)
+        self.assertIn('servo_cal_lut_ch1', header)
+
+    def test_bad_records(self):
+        for bad in ({'channel': 8}, {'channel': 0, 'min_us': 2500, 'max_us': 500},
+                    {'channel': 0, 'limit_lo': 900, 'limit_hi': 100}, {'channel': 0, 'speed': 1}):
+            with self.assertRaises(cal.CalError):
+                cal.parse(json.dumps({'channels': [bad]}))
+        with self.assertRaises(cal.CalError):
+            cal.parse(json.dumps({'channels': [{'channel': 2}, {'channel': 2}]}))
+        with self.assertRaises(cal.CalError):
+            cal.parse('[]')
+
+
+if __name__ == '__main__':
+    unittest.main()
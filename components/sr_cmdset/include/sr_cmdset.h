@@ -0,0 +1,142 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SR_CMDSET_MAGIC         (0x444d4353)  /*!< "SCMD" */
+#define SR_CMDSET_VERSION       (1)
+#define SR_CMDSET_NAME_LEN      (16)
+
+/**
+ * @brief Serialized command set header
+ *
+ * A packed set is the header, `count` entries sorted by command id and a pool of
+ * `pool_size` bytes of NUL terminated phrases. The same layout is used in RAM and
+ * in the `cmdsets` partition.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;                     /*!< Number of phrases */
+    uint16_t pool_size;                 /*!< Bytes of phrase strings */
+    uint16_t reserved;
+    uint32_t checksum;                  /*!< FNV-1a over entries and pool */
+    char     name[SR_CMDSET_NAME_LEN];  /*!< Set name, e.g. "flight" or "combat" */
+} sr_cmdset_header_t;
+
+/**
+ * @brief One phrase of a set
+ */
+typedef struct {
+    uint16_t command_id;  /*!< MultiNet command id reported in `esp_mn_results_t` */
+    uint16_t offset;      /*!< Phrase offset in the string pool */
+} sr_cmdset_entry_t;
+
+typedef struct sr_cmdset sr_cmdset_t;
+
+/**
+ * @brief Create an empty set
+ */
+sr_cmdset_t *sr_cmdset_create(const char *name);
+
+/**
+ * @brief Destroy a set
+ */
+void sr_cmdset_destroy(sr_cmdset_t *set);
+
+/**
+ * @brief Get set name
+ */
+const char *sr_cmdset_name(const sr_cmdset_t *set);
+
+/**
+ * @brief Add a phrase, several phrases may share a command id
+ *
+ * @return 0 on success, -1 if the phrase already exists or on out of memory
+ */
+int sr_cmdset_add(sr_cmdset_t *set, int command_id, const char *phrase);
+
+/**
+ * @brief Remove a phrase
+ *
+ * @return 0 on success, -1 if not found
+ */
+int sr_cmdset_remove(sr_cmdset_t *set, const char *phrase);
+
+/**
+ * @brief Remove every phrase of a command id
+ *
+ * @return Number of phrases removed
+ */
+int sr_cmdset_remove_id(sr_cmdset_t *set, int command_id);
+
+/**
+ * @brief Replace a phrase keeping its command id
+ *
+ * @return 0 on success, -1 if `old_phrase` was not found or on out of memory
+ */
+int sr_cmdset_replace(sr_cmdset_t *set, const char *old_phrase, const char *new_phrase);
+
+/**
+ * @brief Number of phrases in the set
+ */
+int sr_cmdset_count(const sr_cmdset_t *set);
+
+/**
+ * @brief Get phrase by position, positions are ordered by command id
+ *
+ * @return Phrase, NULL if `index` is out of range
+ */
+const char *sr_cmdset_get(const sr_cmdset_t *set, int index, int *command_id);
+
+/**
+ * @brief Find the first position of a command id, binary search on the index
+ *
+ * @return Position, -1 if the command id is not in the set
+ */
+int sr_cmdset_find(const sr_cmdset_t *set, int command_id);
+
+/**
+ * @brief Size of the packed form of a set
+ */
+size_t sr_cmdset_packed_size(const sr_cmdset_t *set);
+
+/**
+ * @brief Serialize a set, dropping the space of removed phrases
+ *
+ * @return Bytes written, 0 if `size` is too small
+ */
+size_t sr_cmdset_pack(const sr_cmdset_t *set, void *buf, size_t size);
+
+/**
+ * @brief Create a set from its packed form, the buffer is not referenced afterwards
+ *
+ * @return Set, NULL if the data is not a valid packed set
+ */
+sr_cmdset_t *sr_cmdset_unpack(const void *buf, size_t size);
+
+/**
+ * @brief Queue a set to become active at the next safe point
+ *
+ * Ownership of `set` moves to the queue. A set queued earlier and not yet taken
+ * is destroyed.
+ */
+void sr_cmdset_request(sr_cmdset_t *set);
+
+/**
+ * @brief Take the queued set, if any
+ *
+ * Called by the recognition task between sessions.
+ *
+ * @return Queued set owned by the caller, NULL if nothing is queued
+ */
+sr_cmdset_t *sr_cmdset_take_pending(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "esp_err.h"
+#include "sr_cmdset.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SR_CMDSET_PARTITION_LABEL   "cmdsets"
+#define SR_CMDSET_SLOT_SIZE         (4096)      /*!< One flash sector per packed set */
+
+/**
+ * @brief Save a packed set to the `cmdsets` partition
+ *
+ * A set with the same name is overwritten, otherwise the first free slot is used.
+ *
+ * @return
+ *    - ESP_OK                  Success
+ *    - ESP_ERR_NOT_FOUND       No `cmdsets` partition
+ *    - ESP_ERR_INVALID_SIZE    Packed set larger than one slot
+ *    - ESP_ERR_NO_MEM          No free slot or out of memory
+ *    - Others                  Flash access failed
+ */
+esp_err_t sr_cmdset_store_save(const sr_cmdset_t *set);
+
+/**
+ * @brief Load a set by name from the `cmdsets` partition
+ *
+ * @return Set owned by the caller, NULL if not found or corrupted
+ */
+sr_cmdset_t *sr_cmdset_store_load(const char *name);
+
+/**
+ * @brief Erase a stored set
+ *
+ * @return
+ *    - ESP_OK                  Success
+ *    - ESP_ERR_NOT_FOUND       No such set or no `cmdsets` partition
+ *    - Others                  Flash access failed
+ */
+esp_err_t sr_cmdset_store_erase(const char *name);
+
+/**
+ * @brief Print stored sets
+ */
+void sr_cmdset_store_list(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,414 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sr_cmdset.h"
+
+#define SR_CMDSET_POOL_MAX  (0xFFFF)
+
+struct sr_cmdset {
+    char               name[SR_CMDSET_NAME_LEN];
+    sr_cmdset_entry_t *entries;     // sorted by command id, insertion order within an id
+    int                count;
+    int                entry_cap;
+    char              *pool;        // phrases, removed ones stay until compaction
+    int                pool_len;
+    int                pool_cap;
+    uint16_t          *index;       // phrase hash table, pool offset + 1 per slot, 0 when empty
+    int                index_cap;   // power of two, at most half full
+};
+
+static sr_cmdset_t *pending_set = NULL;
+
+static uint32_t fnv1a(uint32_t hash, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *) data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// linear probing over the phrase hash, the slot holding `phrase` or -1
+static int index_find(const sr_cmdset_t *set, const char *phrase)
+{
+    if (set->index_cap == 0) {
+        return -1;
+    }
+    int mask = set->index_cap - 1;
+    for (int slot = fnv1a(2166136261u, phrase, strlen(phrase)) & mask; set->index[slot]; slot = (slot + 1) & mask) {
+        if (strcmp(set->pool + set->index[slot] - 1, phrase) == 0) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+static void index_insert(sr_cmdset_t *set, int offset)
+{
+    const char *phrase = set->pool + offset;
+    int mask = set->index_cap - 1;
+    int slot = fnv1a(2166136261u, phrase, strlen(phrase)) & mask;
+    while (set->index[slot]) {
+        slot = (slot + 1) & mask;
+    }
+    set->index[slot] = offset + 1;
+}
+
+// backward shift deletion, keeps every probe chain unbroken without tombstones
+static void index_remove(sr_cmdset_t *set, int slot)
+{
+    int mask = set->index_cap - 1;
+    for (int next = (slot + 1) & mask; set->index[next]; next = (next + 1) & mask) {
+        const char *s = set->pool + set->index[next] - 1;
+        int home = fnv1a(2166136261u, s, strlen(s)) & mask;
+        // an entry may fill the hole unless its home lies after the hole on the wrapped probe path
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            set->index[slot] = set->index[next];
+            slot = next;
+        }
+    }
+    set->index[slot] = 0;
+}
+
+// re-hash every live entry, after compaction moved the offsets
+static void index_rebuild(sr_cmdset_t *set)
+{
+    if (set->index_cap) {
+        memset(set->index, 0, set->index_cap * sizeof(uint16_t));
+    }
+    for (int i = 0; i < set->count; i++) {
+        index_insert(set, set->entries[i].offset);
+    }
+}
+
+// room for `count` phrases, the only index operation that allocates
+static int index_reserve(sr_cmdset_t *set, int count)
+{
+    if (count * 2 <= set->index_cap) {
+        return 0;
+    }
+    int cap = set->index_cap ? set->index_cap : 32;
+    while (count * 2 > cap) {
+        cap *= 2;
+    }
+    uint16_t *index = (uint16_t *) realloc(set->index, cap * sizeof(uint16_t));
+    if (index == NULL) {
+        return -1;
+    }
+    set->index = index;
+    set->index_cap = cap;
+    index_rebuild(set);
+    return 0;
+}
+
+// position of a phrase, the index gives its pool offset and the entries are searched by offset
+static int phrase_index(const sr_cmdset_t *set, const char *phrase)
+{
+    int slot = index_find(set, phrase);
+    if (slot < 0) {
+        return -1;
+    }
+    int offset = set->index[slot] - 1;
+    for (int i = 0; i < set->count; i++) {
+        if (set->entries[i].offset == offset) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// rewrite the pool in entry order, dropping removed phrases
+static int pool_compact(sr_cmdset_t *set)
+{
+    char *pool = (char *) malloc(set->pool_cap);
+    if (pool == NULL) {
+        return -1;
+    }
+    int len = 0;
+    for (int i = 0; i < set->count; i++) {
+        const char *s = set->pool + set->entries[i].offset;
+        int n = strlen(s) + 1;
+        memcpy(pool + len, s, n);
+        set->entries[i].offset = len;
+        len += n;
+    }
+    free(set->pool);
+    set->pool = pool;
+    set->pool_len = len;
+    index_rebuild(set);
+    return 0;
+}
+
+static int pool_append(sr_cmdset_t *set, const char *phrase)
+{
+    int n = strlen(phrase) + 1;
+    if (set->pool_len + n > SR_CMDSET_POOL_MAX && pool_compact(set) != 0) {
+        return -1;
+    }
+    if (set->pool_len + n > SR_CMDSET_POOL_MAX) {
+        return -1;
+    }
+    if (set->pool_len + n > set->pool_cap) {
+        int cap = set->pool_cap ? set->pool_cap * 2 : 256;
+        while (cap < set->pool_len + n) {
+            cap *= 2;
+        }
+        char *pool = (char *) realloc(set->pool, cap);
+        if (pool == NULL) {
+            return -1;
+        }
+        set->pool = pool;
+        set->pool_cap = cap;
+    }
+    int offset = set->pool_len;
+    memcpy(set->pool + offset, phrase, n);
+    set->pool_len += n;
+    return offset;
+}
+
+// first position with an id greater than command_id
+static int upper_bound(const sr_cmdset_t *set, int command_id)
+{
+    int lo = 0, hi = set->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (set->entries[mid].command_id <= command_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+sr_cmdset_t *sr_cmdset_create(const char *name)
+{
+    sr_cmdset_t *set = (sr_cmdset_t *) calloc(1, sizeof(sr_cmdset_t));
+    if (set && name) {
+        strncpy(set->name, name, SR_CMDSET_NAME_LEN - 1);
+    }
+    return set;
+}
+
+void sr_cmdset_destroy(sr_cmdset_t *set)
+{
+    if (set) {
+        free(set->entries);
+        free(set->pool);
+        free(set->index);
+        free(set);
+    }
+}
+
+const char *sr_cmdset_name(const sr_cmdset_t *set)
+{
+    return set->name;
+}
+
+int sr_cmdset_add(sr_cmdset_t *set, int command_id, const char *phrase)
+{
+    if (command_id < 0 || command_id > UINT16_MAX || phrase == NULL || index_find(set, phrase) >= 0
+        || index_reserve(set, set->count + 1) != 0) {
+        return -1;
+    }
+    if (set->count == set->entry_cap) {
+        int cap = set->entry_cap ? set->entry_cap * 2 : 16;
+        sr_cmdset_entry_t *entries = (sr_cmdset_entry_t *) realloc(set->entries, cap * sizeof(sr_cmdset_entry_t));
+        if (entries == NULL) {
+            return -1;
+        }
+        set->entries = entries;
+        set->entry_cap = cap;
+    }
+    int offset = pool_append(set, phrase);
+    if (offset < 0) {
+        return -1;
+    }
+    int pos = upper_bound(set, command_id);
+    memmove(&set->entries[pos + 1], &set->entries[pos], (set->count - pos) * sizeof(sr_cmdset_entry_t));
+    set->entries[pos].command_id = command_id;
+    set->entries[pos].offset = offset;
+    set->count++;
+    index_insert(set, offset);
+    return 0;
+}
+
+int sr_cmdset_remove(sr_cmdset_t *set, const char *phrase)
+{
+    int pos = phrase_index(set, phrase);
+    if (pos < 0) {
+        return -1;
+    }
+    index_remove(set, index_find(set, phrase));
+    set->count--;
+    memmove(&set->entries[pos], &set->entries[pos + 1], (set->count - pos) * sizeof(sr_cmdset_entry_t));
+    return 0;
+}
+
+int sr_cmdset_remove_id(sr_cmdset_t *set, int command_id)
+{
+    int first = sr_cmdset_find(set, command_id);
+    if (first < 0) {
+        return 0;
+    }
+    int last = upper_bound(set, command_id);
+    for (int i = first; i < last; i++) {
+        index_remove(set, index_find(set, set->pool + set->entries[i].offset));
+    }
+    memmove(&set->entries[first], &set->entries[last], (set->count - last) * sizeof(sr_cmdset_entry_t));
+    set->count -= last - first;
+    return last - first;
+}
+
+int sr_cmdset_replace(sr_cmdset_t *set, const char *old_phrase, const char *new_phrase)
+{
+    int pos = phrase_index(set, old_phrase);
+    if (pos < 0 || new_phrase == NULL || index_find(set, new_phrase) >= 0
+        || index_reserve(set, set->count + 1) != 0) {
+        return -1;
+    }
+    int offset = pool_append(set, new_phrase);
+    if (offset < 0) {
+        return -1;
+    }
+    // compaction inside pool_append does not reorder entries, the old phrase is still indexed
+    index_remove(set, index_find(set, old_phrase));
+    set->entries[pos].offset = offset;
+    index_insert(set, offset);
+    return 0;
+}
+
+int sr_cmdset_count(const sr_cmdset_t *set)
+{
+    return set->count;
+}
+
+const char *sr_cmdset_get(const sr_cmdset_t *set, int index, int *command_id)
+{
+    if (index < 0 || index >= set->count) {
+        return NULL;
+    }
+    if (command_id) {
+        *command_id = set->entries[index].command_id;
+    }
+    return set->pool + set->entries[index].offset;
+}
+
+int sr_cmdset_find(const sr_cmdset_t *set, int command_id)
+{
+    int lo = 0, hi = set->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (set->entries[mid].command_id < command_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo < set->count && set->entries[lo].command_id == command_id) ? lo : -1;
+}
+
+static size_t live_pool_size(const sr_cmdset_t *set)
+{
+    size_t len = 0;
+    for (int i = 0; i < set->count; i++) {
+        len += strlen(set->pool + set->entries[i].offset) + 1;
+    }
+    return len;
+}
+
+size_t sr_cmdset_packed_size(const sr_cmdset_t *set)
+{
+    return sizeof(sr_cmdset_header_t) + set->count * sizeof(sr_cmdset_entry_t) + live_pool_size(set);
+}
+
+size_t sr_cmdset_pack(const sr_cmdset_t *set, void *buf, size_t size)
+{
+    size_t pool_size = live_pool_size(set);
+    size_t total = sizeof(sr_cmdset_header_t) + set->count * sizeof(sr_cmdset_entry_t) + pool_size;
+    if (buf == NULL || size < total || pool_size > SR_CMDSET_POOL_MAX) {
+        return 0;
+    }
+    sr_cmdset_header_t *hdr = (sr_cmdset_header_t *) buf;
+    sr_cmdset_entry_t *entries = (sr_cmdset_entry_t *) (hdr + 1);
+    char *pool = (char *) (entries + set->count);
+    int len = 0;
+    for (int i = 0; i < set->count; i++) {
+        const char *s = set->pool + set->entries[i].offset;
+        int n = strlen(s) + 1;
+        memcpy(pool + len, s, n);
+        entries[i].command_id = set->entries[i].command_id;
+        entries[i].offset = len;
+        len += n;
+    }
+    memset(hdr, 0, sizeof(sr_cmdset_header_t));
+    hdr->magic = SR_CMDSET_MAGIC;
+    hdr->version = SR_CMDSET_VERSION;
+    hdr->count = set->count;
+    hdr->pool_size = pool_size;
+    memcpy(hdr->name, set->name, SR_CMDSET_NAME_LEN);
+    hdr->checksum = fnv1a(2166136261u, entries, total - sizeof(sr_cmdset_header_t));
+    return total;
+}
+
+sr_cmdset_t *sr_cmdset_unpack(const void *buf, size_t size)
+{
+    const sr_cmdset_header_t *hdr = (const sr_cmdset_header_t *) buf;
+    if (buf == NULL || size < sizeof(sr_cmdset_header_t)
+        || hdr->magic != SR_CMDSET_MAGIC || hdr->version != SR_CMDSET_VERSION) {
+        return NULL;
+    }
+    size_t body = hdr->count * sizeof(sr_cmdset_entry_t) + hdr->pool_size;
+    if (size < sizeof(sr_cmdset_header_t) + body) {
+        return NULL;
+    }
+    const sr_cmdset_entry_t *entries = (const sr_cmdset_entry_t *) (hdr + 1);
+    const char *pool = (const char *) (entries + hdr->count);
+    if (fnv1a(2166136261u, entries, body) != hdr->checksum
+        || (hdr->pool_size && pool[hdr->pool_size - 1] != '\0')) {
+        return NULL;
+    }
+    char name[SR_CMDSET_NAME_LEN + 1] = { 0 };
+    memcpy(name, hdr->name, SR_CMDSET_NAME_LEN);
+    sr_cmdset_t *set = sr_cmdset_create(name);
+    if (set == NULL) {
+        return NULL;
+    }
+    set->entries = (sr_cmdset_entry_t *) malloc((hdr->count ? hdr->count : 1) * sizeof(sr_cmdset_entry_t));
+    set->pool = (char *) malloc(hdr->pool_size ? hdr->pool_size : 1);
+    if (set->entries == NULL || set->pool == NULL) {
+        sr_cmdset_destroy(set);
+        return NULL;
+    }
+    set->entry_cap = hdr->count ? hdr->count : 1;
+    set->pool_cap = hdr->pool_size ? hdr->pool_size : 1;
+    memcpy(set->pool, pool, hdr->pool_size);
+    set->pool_len = hdr->pool_size;
+    for (int i = 0; i < hdr->count; i++) {
+        if (entries[i].offset >= hdr->pool_size || (i && entries[i].command_id < entries[i - 1].command_id)) {
+            sr_cmdset_destroy(set);
+            return NULL;
+        }
+        set->entries[i] = entries[i];
+    }
+    set->count = hdr->count;
+    if (index_reserve(set, set->count) != 0) {
+        sr_cmdset_destroy(set);
+        return NULL;
+    }
+    return set;
+}
+
+void sr_cmdset_request(sr_cmdset_t *set)
+{
+    sr_cmdset_t *old = __atomic_exchange_n(&pending_set, set, __ATOMIC_ACQ_REL);
+    sr_cmdset_destroy(old);
+}
+
+sr_cmdset_t *sr_cmdset_take_pending(void)
+{
+    if (__atomic_load_n(&pending_set, __ATOMIC_ACQUIRE) == NULL) {
+        return NULL;
+    }
+    return __atomic_exchange_n(&pending_set, NULL, __ATOMIC_ACQ_REL);
+}
@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "sr_cmdset_store.h"
+
+static const char *TAG = "MK39 Command Sets";
+
+static const esp_partition_t *store_partition(void)
+{
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                            SR_CMDSET_PARTITION_LABEL);
+    if (part == NULL) {
+        ESP_LOGW(TAG, "no %s partition", SR_CMDSET_PARTITION_LABEL);
+    }
+    return part;
+}
+
+// slot holding `name`, or -1. `free_slot` receives the first unused slot, or -1
+static int store_find(const esp_partition_t *part, const char *name, int *free_slot)
+{
+    sr_cmdset_header_t hdr;
+    int slots = part->size / SR_CMDSET_SLOT_SIZE;
+    if (free_slot) {
+        *free_slot = -1;
+    }
+    for (int i = 0; i < slots; i++) {
+        if (esp_partition_read(part, i * SR_CMDSET_SLOT_SIZE, &hdr, sizeof(hdr)) != ESP_OK) {
+            continue;
+        }
+        if (hdr.magic != SR_CMDSET_MAGIC) {
+            if (free_slot && *free_slot < 0) {
+                *free_slot = i;
+            }
+            continue;
+        }
+        if (name && strncmp(hdr.name, name, SR_CMDSET_NAME_LEN) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+esp_err_t sr_cmdset_store_save(const sr_cmdset_t *set)
+{
+    const esp_partition_t *part = store_partition();
+    if (part == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    size_t size = sr_cmdset_packed_size(set);
+    if (size > SR_CMDSET_SLOT_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    int free_slot;
+    int slot = store_find(part, sr_cmdset_name(set), &free_slot);
+    if (slot < 0) {
+        slot = free_slot;
+    }
+    if (slot < 0) {
+        return ESP_ERR_NO_MEM;
+    }
+    void *buf = malloc(size);
+    if (buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    sr_cmdset_pack(set, buf, size);
+    esp_err_t ret = esp_partition_erase_range(part, slot * SR_CMDSET_SLOT_SIZE, SR_CMDSET_SLOT_SIZE);
+    if (ret == ESP_OK) {
+        ret = esp_partition_write(part, slot * SR_CMDSET_SLOT_SIZE, buf, size);
+    }
+    free(buf);
+    ESP_LOGI(TAG, "save %s to slot %d, %d bytes: %s", sr_cmdset_name(set), slot, (int) size, esp_err_to_name(ret));
+    return ret;
+}
+
+sr_cmdset_t *sr_cmdset_store_load(const char *name)
+{
+    const esp_partition_t *part = store_partition();
+    if (part == NULL) {
+        return NULL;
+    }
+    int slot = store_find(part, name, NULL);
+    if (slot < 0) {
+        return NULL;
+    }
+    sr_cmdset_header_t hdr;
+    if (esp_partition_read(part, slot * SR_CMDSET_SLOT_SIZE, &hdr, sizeof(hdr)) != ESP_OK) {
+        return NULL;
+    }
+    size_t size = sizeof(hdr) + hdr.count * sizeof(sr_cmdset_entry_t) + hdr.pool_size;
+    if (size > SR_CMDSET_SLOT_SIZE) {
+        return NULL;
+    }
+    void *buf = malloc(size);
+    if (buf == NULL) {
+        return NULL;
+    }
+    sr_cmdset_t *set = NULL;
+    if (esp_partition_read(part, slot * SR_CMDSET_SLOT_SIZE, buf, size) == ESP_OK) {
+        set = sr_cmdset_unpack(buf, size);
+    }
+    free(buf);
+    if (set == NULL) {
+        ESP_LOGE(TAG, "slot %d (%s) is corrupted", slot, name);
+    }
+    return set;
+}
+
+esp_err_t sr_cmdset_store_erase(const char *name)
+{
+    const esp_partition_t *part = store_partition();
+    if (part == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    int slot = store_find(part, name, NULL);
+    if (slot < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return esp_partition_erase_range(part, slot * SR_CMDSET_SLOT_SIZE, SR_CMDSET_SLOT_SIZE);
+}
+
+void sr_cmdset_store_list(void)
+{
+    const esp_partition_t *part = store_partition();
+    if (part == NULL) {
+        return;
+    }
+    sr_cmdset_header_t hdr;
+    int slots = part->size / SR_CMDSET_SLOT_SIZE;
+    for (int i = 0; i < slots; i++) {
+        if (esp_partition_read(part, i * SR_CMDSET_SLOT_SIZE, &hdr, sizeof(hdr)) == ESP_OK
+            && hdr.magic == SR_CMDSET_MAGIC) {
+            printf("slot %d: %.*s, %d phrases\n", i, SR_CMDSET_NAME_LEN, hdr.name, hdr.count);
+        }
+    }
+}
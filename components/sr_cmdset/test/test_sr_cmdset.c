@@ -0,0 +1,199 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "sr_cmdset.h"
+
+static sr_cmdset_t *flight_set(void)
+{
+    sr_cmdset_t *set = sr_cmdset_create("flight");
+    TEST_ASSERT_NOT_NULL(set);
+    TEST_ASSERT_EQUAL(0, sr_cmdset_add(set, 2, "close helmet"));
+    TEST_ASSERT_EQUAL(0, sr_cmdset_add(set, 0, "open helmet"));
+    TEST_ASSERT_EQUAL(0, sr_cmdset_add(set, 5, "lights on"));
+    TEST_ASSERT_EQUAL(0, sr_cmdset_add(set, 0, "helmet up"));
+    return set;
+}
+
+TEST_CASE("sr_cmdset add, remove and replace phrases", "[sr_cmdset]")
+{
+    sr_cmdset_t *set = flight_set();
+    int id = -1;
+    // ordered by command id, insertion order within an id
+    TEST_ASSERT_EQUAL(4, sr_cmdset_count(set));
+    TEST_ASSERT_EQUAL_STRING("open helmet", sr_cmdset_get(set, 0, &id));
+    TEST_ASSERT_EQUAL(0, id);
+    TEST_ASSERT_EQUAL_STRING("helmet up", sr_cmdset_get(set, 1, &id));
+    TEST_ASSERT_EQUAL_STRING("lights on", sr_cmdset_get(set, 3, &id));
+    TEST_ASSERT_EQUAL(5, id);
+    TEST_ASSERT_NULL(sr_cmdset_get(set, 4, NULL));
+    TEST_ASSERT_EQUAL(2, sr_cmdset_find(set, 2));
+    TEST_ASSERT_EQUAL(-1, sr_cmdset_find(set, 3));
+
+    TEST_ASSERT_EQUAL(-1, sr_cmdset_add(set, 7, "lights on"));
+    TEST_ASSERT_EQUAL(-1, sr_cmdset_remove(set, "lights off"));
+    TEST_ASSERT_EQUAL(-1, sr_cmdset_replace(set, "lights off", "lights dim"));
+    TEST_ASSERT_EQUAL(-1, sr_cmdset_replace(set, "lights on", "helmet up"));
+    TEST_ASSERT_EQUAL(0, sr_cmdset_replace(set, "lights on", "lights full"));
+    TEST_ASSERT_EQUAL(3, sr_cmdset_find(set, 5));
+    TEST_ASSERT_EQUAL_STRING("lights full", sr_cmdset_get(set, 3, &id));
+    TEST_ASSERT_EQUAL(5, id);
+    // the replaced phrase is free again
+    TEST_ASSERT_EQUAL(0, sr_cmdset_add(set, 6, "lights on"));
+
+    TEST_ASSERT_EQUAL(0, sr_cmdset_remove(set, "close helmet"));
+    TEST_ASSERT_EQUAL(-1, sr_cmdset_find(set, 2));
+    TEST_ASSERT_EQUAL(2, sr_cmdset_remove_id(set, 0));
+    TEST_ASSERT_EQUAL(0, sr_cmdset_remove_id(set, 0));
+    TEST_ASSERT_EQUAL(2, sr_cmdset_count(set));
+    TEST_ASSERT_EQUAL(0, sr_cmdset_add(set, 0, "open helmet"));
+    sr_cmdset_destroy(set);
+}
+
+TEST_CASE("sr_cmdset phrase index survives growth and removal", "[sr_cmdset]")
+{
+    sr_cmdset_t *set = sr_cmdset_create("many");
+    char phrase[32];
+    for (int i = 0; i < 500; i++) {
+        snprintf(phrase, sizeof(phrase), "command %d", i);
+        TEST_ASSERT_EQUAL(0, sr_cmdset_add(set, i % 50, phrase));
+    }
+    for (int i = 0; i < 500; i += 2) {
+        snprintf(phrase, sizeof(phrase), "command %d", i);
+        TEST_ASSERT_EQUAL(0, sr_cmdset_remove(set, phrase));
+    }
+    TEST_ASSERT_EQUAL(250, sr_cmdset_count(set));
+    // removed phrases can come back, the others are still found as duplicates
+    for (int i = 0; i < 500; i++) {
+        snprintf(phrase, sizeof(phrase), "command %d", i);
+        TEST_ASSERT_EQUAL(i % 2 ? -1 : 0, sr_cmdset_add(set, i % 50, phrase));
+    }
+    TEST_ASSERT_EQUAL(500, sr_cmdset_count(set));
+    sr_cmdset_destroy(set);
+}
+
+TEST_CASE("sr_cmdset pack and unpack round trip", "[sr_cmdset]")
+{
+    sr_cmdset_t *set = flight_set();
+    // the removed phrase is dropped from the packed pool
+    TEST_ASSERT_EQUAL(0, sr_cmdset_remove(set, "helmet up"));
+    size_t size = sr_cmdset_packed_size(set);
+    TEST_ASSERT_EQUAL(sizeof(sr_cmdset_header_t) + 3 * sizeof(sr_cmdset_entry_t) +
+                      sizeof("close helmet") + sizeof("open helmet") + sizeof("lights on"), size);
+    uint8_t *buf = malloc(size);
+    TEST_ASSERT_NOT_NULL(buf);
+    TEST_ASSERT_EQUAL(0, sr_cmdset_pack(set, buf, size - 1));
+    TEST_ASSERT_EQUAL(size, sr_cmdset_pack(set, buf, size));
+
+    sr_cmdset_t *copy = sr_cmdset_unpack(buf, size);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_EQUAL_STRING("flight", sr_cmdset_name(copy));
+    TEST_ASSERT_EQUAL(sr_cmdset_count(set), sr_cmdset_count(copy));
+    for (int i = 0; i < sr_cmdset_count(set); i++) {
+        int id = -1, copy_id = -2;
+        TEST_ASSERT_EQUAL_STRING(sr_cmdset_get(set, i, &id), sr_cmdset_get(copy, i, &copy_id));
+        TEST_ASSERT_EQUAL(id, copy_id);
+    }
+    // the unpacked set is indexed and editable
+    TEST_ASSERT_EQUAL(-1, sr_cmdset_add(copy, 9, "open helmet"));
+    TEST_ASSERT_EQUAL(0, sr_cmdset_replace(copy, "open helmet", "visor up"));
+    TEST_ASSERT_EQUAL(0, sr_cmdset_find(copy, 0));
+    sr_cmdset_destroy(copy);
+    sr_cmdset_destroy(set);
+    free(buf);
+}
+
+TEST_CASE("sr_cmdset unpack rejects damaged data", "[sr_cmdset]")
+{
+    sr_cmdset_t *set = flight_set();
+    size_t size = sr_cmdset_packed_size(set);
+    uint8_t *buf = malloc(size);
+    TEST_ASSERT_EQUAL(size, sr_cmdset_pack(set, buf, size));
+    sr_cmdset_destroy(set);
+
+    // a flipped bit in the pool or the entries fails the checksum
+    buf[size - 3] ^= 0x01;
+    TEST_ASSERT_NULL(sr_cmdset_unpack(buf, size));
+    buf[size - 3] ^= 0x01;
+    buf[sizeof(sr_cmdset_header_t)] ^= 0x80;
+    TEST_ASSERT_NULL(sr_cmdset_unpack(buf, size));
+    buf[sizeof(sr_cmdset_header_t)] ^= 0x80;
+
+    TEST_ASSERT_NULL(sr_cmdset_unpack(buf, size - 1));
+    TEST_ASSERT_NULL(sr_cmdset_unpack(buf, sizeof(sr_cmdset_header_t) - 1));
+    ((sr_cmdset_header_t *) buf)->magic ^= 1;
+    TEST_ASSERT_NULL(sr_cmdset_unpack(buf, size));
+    ((sr_cmdset_header_t *) buf)->magic ^= 1;
+
+    sr_cmdset_t *copy = sr_cmdset_unpack(buf, size);
+    TEST_ASSERT_NOT_NULL(copy);
+    sr_cmdset_destroy(copy);
+    free(buf);
+}
+
+TEST_CASE("sr_cmdset compacts the pool instead of passing 64 KiB", "[sr_cmdset]")
+{
+    sr_cmdset_t *set = flight_set();
+    char phrase[200];
+    memset(phrase, 'a', sizeof(phrase) - 8);
+    phrase[sizeof(phrase) - 1] = '\0';
+    // every replace appends to the pool, removed phrases are only dropped by compaction
+    char old[200] = "lights on";
+    for (int i = 0; i < 1000; i++) {
+        snprintf(phrase + sizeof(phrase) - 8, 8, "%05d", i);
+        TEST_ASSERT_EQUAL(0, sr_cmdset_replace(set, old, phrase));
+        strcpy(old, phrase);
+    }
+    int id = -1;
+    TEST_ASSERT_EQUAL(4, sr_cmdset_count(set));
+    TEST_ASSERT_EQUAL_STRING(phrase, sr_cmdset_get(set, 3, &id));
+    TEST_ASSERT_EQUAL(5, id);
+    TEST_ASSERT_EQUAL_STRING("open helmet", sr_cmdset_get(set, 0, NULL));
+    TEST_ASSERT_EQUAL(-1, sr_cmdset_add(set, 1, "open helmet"));
+
+    // live phrases which do not fit are refused, the set stays usable
+    int added = 0;
+    for (int i = 0; i < 1000; i++) {
+        snprintf(phrase + sizeof(phrase) - 8, 8, "x%04d", i);
+        if (sr_cmdset_add(set, 7, phrase) != 0) {
+            break;
+        }
+        added++;
+    }
+    TEST_ASSERT_TRUE(added > 300 && added < 1000);
+    TEST_ASSERT_TRUE(sr_cmdset_packed_size(set) - sizeof(sr_cmdset_header_t) -
+                     sr_cmdset_count(set) * sizeof(sr_cmdset_entry_t) <= 0xFFFF);
+    TEST_ASSERT_EQUAL(0, sr_cmdset_remove(set, "open helmet"));
+    TEST_ASSERT_EQUAL(0, sr_cmdset_add(set, 0, "open"));
+    sr_cmdset_destroy(set);
+}
+
+TEST_CASE("sr_cmdset swaps sets between sessions", "[sr_cmdset]")
+{
+    TEST_ASSERT_NULL(sr_cmdset_take_pending());
+    sr_cmdset_t *active = flight_set();
+
+    // a set queued while a session runs is replaced by a later one, only the last becomes active
+    sr_cmdset_request(sr_cmdset_create("combat"));
+    sr_cmdset_request(sr_cmdset_create("landing"));
+    sr_cmdset_t *next = sr_cmdset_take_pending();
+    TEST_ASSERT_NOT_NULL(next);
+    TEST_ASSERT_EQUAL_STRING("landing", sr_cmdset_name(next));
+    TEST_ASSERT_NULL(sr_cmdset_take_pending());
+    sr_cmdset_destroy(active);
+    active = next;
+
+    // and the previous one can be queued again for the next session
+    size_t size = sr_cmdset_packed_size(active);
+    void *buf = malloc(size);
+    TEST_ASSERT_EQUAL(size, sr_cmdset_pack(active, buf, size));
+    sr_cmdset_request(sr_cmdset_unpack(buf, size));
+    next = sr_cmdset_take_pending();
+    TEST_ASSERT_EQUAL_STRING("landing", sr_cmdset_name(next));
+    sr_cmdset_destroy(next);
+    sr_cmdset_destroy(active);
+    free(buf);
+}
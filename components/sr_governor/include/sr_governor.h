@@ -0,0 +1,48 @@
+#pragma once
+
+#include "esp_afe_sr_iface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief AFE work profiles
+ */
+typedef enum {
+    SR_PERF_IDLE = 0,   /*!< Waiting for the wake word: WakeNet and VAD only, AEC too with a playback reference */
+    SR_PERF_SESSION,    /*!< Wake word heard: AEC, NS and beamforming (SE) enabled as well */
+    SR_PERF_MODE_MAX,
+} sr_perf_mode_t;
+
+/**
+ * @brief Attach the governor to an AFE instance and enter `SR_PERF_IDLE`
+ *
+ * Only stages initialized in `afe_config` are toggled, the others are left alone.
+ *
+ * @param afe_handle AFE interface
+ * @param afe_data AFE instance created from `afe_config`
+ * @param afe_config Configuration used to create `afe_data`
+ */
+void sr_governor_init(esp_afe_sr_iface_t *afe_handle, esp_afe_sr_data_t *afe_data, const afe_config_t *afe_config);
+
+/**
+ * @brief Switch AFE profile, does nothing if the profile is already active
+ *
+ * The CPU load measured while in the previous profile is logged on every switch.
+ */
+void sr_governor_set_mode(sr_perf_mode_t mode);
+
+/**
+ * @brief Get the active profile
+ */
+sr_perf_mode_t sr_governor_get_mode(void);
+
+/**
+ * @brief Log the accumulated CPU load of each profile
+ */
+void sr_governor_print_load(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sr_governor.h"
+
+static const char *TAG = "MK39 SR Governor";
+
+typedef struct {
+    int64_t  wall_us;
+    uint64_t idle_us[portNUM_PROCESSORS];
+} sr_perf_load_t;
+
+typedef struct {
+    esp_afe_sr_iface_t *afe_handle;
+    esp_afe_sr_data_t  *afe_data;
+    bool                aec;
+    bool                se;
+    bool                ns;
+    bool                vad;
+    sr_perf_mode_t      mode;
+    int64_t             mode_start_us;
+    uint64_t            idle_start_us[portNUM_PROCESSORS];
+    sr_perf_load_t      load[SR_PERF_MODE_MAX];
+} sr_governor_t;
+
+static sr_governor_t gov;
+
+static const char *mode_names[SR_PERF_MODE_MAX] = {
+    [SR_PERF_IDLE] = "idle",
+    [SR_PERF_SESSION] = "session",
+};
+
+// idle task run time per core in us, needs CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+// with the 64 bit counter so long idle stretches do not wrap
+static void idle_time_get(uint64_t *idle_us)
+{
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+        idle_us[i] = ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(i));
+#else
+        idle_us[i] = 0;
+#endif
+    }
+}
+
+static void load_sample(int64_t now_us)
+{
+    uint64_t idle_us[portNUM_PROCESSORS];
+    idle_time_get(idle_us);
+    sr_perf_load_t *load = &gov.load[gov.mode];
+    load->wall_us += now_us - gov.mode_start_us;
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        load->idle_us[i] += idle_us[i] - gov.idle_start_us[i];
+        gov.idle_start_us[i] = idle_us[i];
+    }
+    gov.mode_start_us = now_us;
+}
+
+static void load_print(sr_perf_mode_t mode)
+{
+    sr_perf_load_t *load = &gov.load[mode];
+    if (load->wall_us <= 0) {
+        return;
+    }
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    char buf[16 * portNUM_PROCESSORS];
+    int len = 0;
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        int busy = 100 - (int) (load->idle_us[i] * 100 / load->wall_us);
+        len += snprintf(buf + len, sizeof(buf) - len, " cpu%d %d%%", i, busy < 0 ? 0 : busy);
+    }
+    ESP_LOGI(TAG, "%s mode:%s over %lld ms", mode_names[mode], buf, load->wall_us / 1000);
+#else
+    ESP_LOGI(TAG, "%s mode: %lld ms, enable CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS for CPU load",
+             mode_names[mode], load->wall_us / 1000);
+#endif
+}
+
+static void stages_apply(sr_perf_mode_t mode)
+{
+    esp_afe_sr_iface_t *afe_handle = gov.afe_handle;
+    esp_afe_sr_data_t *afe_data = gov.afe_data;
+    bool full = (mode == SR_PERF_SESSION);
+
+    // with a playback reference the speaker can talk over the wake word, AEC must keep running
+#if CONFIG_AUDIO_PLAY_REF
+    if (gov.aec) {
+        afe_handle->enable_aec(afe_data);
+    }
+#else
+    if (gov.aec && full) {
+        afe_handle->enable_aec(afe_data);
+    } else if (gov.aec) {
+        afe_handle->disable_aec(afe_data);
+    }
+#endif
+    if (gov.se && full) {
+        afe_handle->enable_se(afe_data);
+    } else if (gov.se) {
+        afe_handle->disable_se(afe_data);
+    }
+    if (gov.ns && full) {
+        afe_handle->enable_ns(afe_data);
+    } else if (gov.ns) {
+        afe_handle->disable_ns(afe_data);
+    }
+    // VAD is cheap and stays on in both modes
+    if (gov.vad) {
+        afe_handle->enable_vad(afe_data);
+    }
+}
+
+void sr_governor_init(esp_afe_sr_iface_t *afe_handle, esp_afe_sr_data_t *afe_data, const afe_config_t *afe_config)
+{
+    memset(&gov, 0, sizeof(gov));
+    gov.afe_handle = afe_handle;
+    gov.afe_data = afe_data;
+    gov.aec = afe_config->aec_init;
+    gov.se = afe_config->se_init;
+    gov.ns = afe_config->ns_init;
+    gov.vad = afe_config->vad_init;
+    gov.mode = SR_PERF_IDLE;
+    gov.mode_start_us = esp_timer_get_time();
+    idle_time_get(gov.idle_start_us);
+    stages_apply(SR_PERF_IDLE);
+    ESP_LOGI(TAG, "stages aec:%d se:%d ns:%d vad:%d, starting in %s mode",
+             gov.aec, gov.se, gov.ns, gov.vad, mode_names[gov.mode]);
+}
+
+void sr_governor_set_mode(sr_perf_mode_t mode)
+{
+    if (gov.afe_handle == NULL || mode == gov.mode || mode >= SR_PERF_MODE_MAX) {
+        return;
+    }
+    load_sample(esp_timer_get_time());
+    load_print(gov.mode);
+    stages_apply(mode);
+    gov.mode = mode;
+}
+
+sr_perf_mode_t sr_governor_get_mode(void)
+{
+    return gov.mode;
+}
+
+void sr_governor_print_load(void)
+{
+    if (gov.afe_handle == NULL) {
+        return;
+    }
+    load_sample(esp_timer_get_time());
+    for (int i = 0; i < SR_PERF_MODE_MAX; i++) {
+        load_print(i);
+    }
+}
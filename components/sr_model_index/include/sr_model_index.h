@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+#include "model_path.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SR_MODEL_INDEX_PARTITION_LABEL  "srmodel_idx"
+#define SR_MODEL_INDEX_MAGIC            (0x494D5253)    /*!< 'SRMI' */
+#define SR_MODEL_INDEX_VERSION          (1)
+#define SR_MODEL_INDEX_NAME_LEN         (32)
+
+/**
+ * @brief Index header, written by `tools/sr_model_index.py` at build time
+ *
+ * Followed by `model_num` model entries, then `file_num` file entries.
+ */
+typedef struct {
+    uint32_t magic;         /*!< SR_MODEL_INDEX_MAGIC */
+    uint16_t version;       /*!< SR_MODEL_INDEX_VERSION */
+    uint16_t model_num;
+    uint16_t file_num;
+    uint16_t reserved;
+    uint32_t image_size;    /*!< Size of the srmodels.bin the index was built from */
+    uint32_t header_size;   /*!< Size of the srmodels.bin header */
+    uint32_t header_crc;    /*!< CRC32 of the srmodels.bin header, tells a stale index apart */
+    uint32_t table_crc;     /*!< CRC32 of the model and file entries */
+    uint32_t pad;
+} sr_model_index_header_t;
+
+typedef struct {
+    char     name[SR_MODEL_INDEX_NAME_LEN];
+    uint16_t first_file;    /*!< First entry of the model in the file table */
+    uint16_t file_num;
+} sr_model_index_model_t;
+
+typedef struct {
+    char     name[SR_MODEL_INDEX_NAME_LEN];
+    uint32_t offset;        /*!< Data offset in the model partition */
+    uint32_t size;
+    uint32_t crc;           /*!< CRC32 of the data */
+} sr_model_index_file_t;
+
+/**
+ * @brief Load models through the `srmodel_idx` partition instead of walking the model partition
+ *
+ * Only the flash range holding the selected models is mapped. Returns NULL when there is no
+ * index or it was built for another model image, callers then fall back to `esp_srmodel_init`.
+ *
+ * @param model_label Label of the model partition, "model" in partitions.csv
+ * @param prefixes Name prefixes of the models to load, e.g. ESP_WN_PREFIX, NULL for all
+ * @param prefix_num Number of prefixes
+ * @return Model list usable with `esp_srmodel_filter` and the AFE, NULL on failure
+ */
+srmodel_list_t *sr_model_index_init(const char *model_label, const char *const *prefixes, int prefix_num);
+
+/**
+ * @brief Unmap and free a list returned by `sr_model_index_init`
+ */
+void sr_model_index_deinit(srmodel_list_t *models);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "sr_model_index.h"
+
+static const char *TAG = "MK39 Model Index";
+
+// set to 1 to check the CRC of every mapped file, costs a full read of the models at boot
+#ifndef SR_MODEL_INDEX_VERIFY
+#define SR_MODEL_INDEX_VERIFY 0
+#endif
+
+static bool model_selected(const char *name, const char *const *prefixes, int prefix_num)
+{
+    if (prefixes == NULL) {
+        return true;
+    }
+    for (int i = 0; i < prefix_num; i++) {
+        if (strncmp(name, prefixes[i], strlen(prefixes[i])) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the index is only valid for the image whose header it hashed
+static bool image_matches(const esp_partition_t *part, const sr_model_index_header_t *hdr)
+{
+    uint8_t buf[256];
+    uint32_t crc = 0;
+    if (hdr->image_size > part->size || hdr->header_size > hdr->image_size) {
+        return false;
+    }
+    for (uint32_t pos = 0; pos < hdr->header_size; pos += sizeof(buf)) {
+        uint32_t len = hdr->header_size - pos < sizeof(buf) ? hdr->header_size - pos : sizeof(buf);
+        if (esp_partition_read(part, pos, buf, len) != ESP_OK) {
+            return false;
+        }
+        crc = esp_rom_crc32_le(crc, buf, len);
+    }
+    return crc == hdr->header_crc;
+}
+
+// header and tables of the index partition, NULL when missing or corrupted
+static sr_model_index_header_t *index_load(void)
+{
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                            SR_MODEL_INDEX_PARTITION_LABEL);
+    if (part == NULL) {
+        ESP_LOGW(TAG, "no %s partition", SR_MODEL_INDEX_PARTITION_LABEL);
+        return NULL;
+    }
+    sr_model_index_header_t hdr;
+    if (esp_partition_read(part, 0, &hdr, sizeof(hdr)) != ESP_OK || hdr.magic != SR_MODEL_INDEX_MAGIC ||
+        hdr.version != SR_MODEL_INDEX_VERSION) {
+        ESP_LOGW(TAG, "%s partition holds no index", SR_MODEL_INDEX_PARTITION_LABEL);
+        return NULL;
+    }
+    size_t tables = hdr.model_num * sizeof(sr_model_index_model_t) + hdr.file_num * sizeof(sr_model_index_file_t);
+    if (sizeof(hdr) + tables > part->size) {
+        ESP_LOGE(TAG, "index tables run past the partition");
+        return NULL;
+    }
+    sr_model_index_header_t *index = malloc(sizeof(hdr) + tables);
+    if (index == NULL) {
+        return NULL;
+    }
+    *index = hdr;
+    if (esp_partition_read(part, sizeof(hdr), index + 1, tables) != ESP_OK ||
+        esp_rom_crc32_le(0, (const uint8_t *)(index + 1), tables) != hdr.table_crc) {
+        ESP_LOGE(TAG, "index table CRC mismatch");
+        free(index);
+        return NULL;
+    }
+    return index;
+}
+
+srmodel_list_t *sr_model_index_init(const char *model_label, const char *const *prefixes, int prefix_num)
+{
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                            model_label);
+    if (part == NULL) {
+        ESP_LOGE(TAG, "no %s partition", model_label);
+        return NULL;
+    }
+    sr_model_index_header_t *index = index_load();
+    if (index == NULL) {
+        return NULL;
+    }
+    if (!image_matches(part, index)) {
+        ESP_LOGW(TAG, "index was built for another model image");
+        free(index);
+        return NULL;
+    }
+    const sr_model_index_model_t *entries = (const sr_model_index_model_t *)(index + 1);
+    const sr_model_index_file_t *files = (const sr_model_index_file_t *)(entries + index->model_num);
+
+    // flash range covering the data of every selected model
+    uint32_t lo = UINT32_MAX, hi = 0;
+    int num = 0;
+    for (int i = 0; i < index->model_num; i++) {
+        const sr_model_index_model_t *m = &entries[i];
+        if (m->first_file + m->file_num > index->file_num) {
+            ESP_LOGE(TAG, "model %.*s refers past the file table", SR_MODEL_INDEX_NAME_LEN, m->name);
+            free(index);
+            return NULL;
+        }
+        if (!model_selected(m->name, prefixes, prefix_num)) {
+            continue;
+        }
+        for (int j = m->first_file; j < m->first_file + m->file_num; j++) {
+            if (files[j].offset < index->header_size || files[j].offset + files[j].size > index->image_size) {
+                ESP_LOGE(TAG, "file %.*s lies outside the model image", SR_MODEL_INDEX_NAME_LEN, files[j].name);
+                free(index);
+                return NULL;
+            }
+            lo = files[j].offset < lo ? files[j].offset : lo;
+            hi = files[j].offset + files[j].size > hi ? files[j].offset + files[j].size : hi;
+        }
+        num++;
+    }
+    if (num == 0 || hi <= lo) {
+        ESP_LOGW(TAG, "no model selected");
+        free(index);
+        return NULL;
+    }
+
+    srmodel_list_t *models = calloc(1, sizeof(srmodel_list_t));
+    if (models == NULL) {
+        free(index);
+        return NULL;
+    }
+    const void *base = NULL;
+    if (esp_partition_mmap(part, lo, hi - lo, ESP_PARTITION_MMAP_DATA, &base, &models->mmap_handle) != ESP_OK) {
+        ESP_LOGE(TAG, "failed to map %lu bytes of %s", (unsigned long)(hi - lo), model_label);
+        free(models);
+        free(index);
+        return NULL;
+    }
+    models->partition = (esp_partition_t *)part;
+    models->model_name = calloc(num, sizeof(char *));
+    models->model_data = calloc(num, sizeof(srmodel_data_t *));
+    if (models->model_name == NULL || models->model_data == NULL) {
+        goto err;
+    }
+
+    for (int i = 0; i < index->model_num; i++) {
+        const sr_model_index_model_t *m = &entries[i];
+        if (!model_selected(m->name, prefixes, prefix_num)) {
+            continue;
+        }
+        srmodel_data_t *data = calloc(1, sizeof(srmodel_data_t));
+        models->model_data[models->num] = data;
+        models->model_name[models->num] = strndup(m->name, SR_MODEL_INDEX_NAME_LEN);
+        models->num++;
+        if (data == NULL || models->model_name[models->num - 1] == NULL) {
+            goto err;
+        }
+        data->files = calloc(m->file_num, sizeof(char *));
+        data->data = calloc(m->file_num, sizeof(char *));
+        data->sizes = calloc(m->file_num, sizeof(int));
+        if (data->files == NULL || data->data == NULL || data->sizes == NULL) {
+            goto err;
+        }
+        for (int j = 0; j < m->file_num; j++) {
+            const sr_model_index_file_t *f = &files[m->first_file + j];
+            data->files[j] = strndup(f->name, SR_MODEL_INDEX_NAME_LEN);
+            data->data[j] = (char *)base + (f->offset - lo);
+            data->sizes[j] = f->size;
+            data->num++;
+            if (data->files[j] == NULL) {
+                goto err;
+            }
+#if SR_MODEL_INDEX_VERIFY
+            if (esp_rom_crc32_le(0, (const uint8_t *)data->data[j], f->size) != f->crc) {
+                ESP_LOGE(TAG, "%s/%s CRC mismatch", models->model_name[models->num - 1], data->files[j]);
+                goto err;
+            }
+#endif
+        }
+    }
+    ESP_LOGI(TAG, "%d of %d models, %lu KB mapped", models->num, index->model_num,
+             (unsigned long)((hi - lo) / 1024));
+    free(index);
+    return models;
+
+err:
+    free(index);
+    sr_model_index_deinit(models);
+    return NULL;
+}
+
+void sr_model_index_deinit(srmodel_list_t *models)
+{
+    if (models == NULL) {
+        return;
+    }
+    for (int i = 0; i < models->num; i++) {
+        srmodel_data_t *data = models->model_data[i];
+        if (data) {
+            for (int j = 0; j < data->num; j++) {
+                free(data->files[j]);
+            }
+            free(data->files);
+            free(data->data);
+            free(data->sizes);
+            free(data);
+        }
+        free(models->model_name[i]);
+    }
+    free(models->model_data);
+    free(models->model_name);
+    esp_partition_munmap(models->mmap_handle);
+    free(models);
+}
@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+"""
+Build or check the index of a packed esp-sr model image (srmodels.bin).
+
+srmodels.bin layout, all integers little endian:
+    model number (u32)
+    per model: name (32 bytes), file number (u32)
+        per file: name (32 bytes), data offset from image start (u32), size (u32)
+    file data
+
+Index layout, flashed to the `srmodel_idx` partition, see `sr_model_index.h`:
+    header  magic 'SRMI', version, model number, file number, image size,
+            size and CRC32 of the srmodels.bin header, CRC32 of the tables
+    models  name (32 bytes), first file (u16), file number (u16)
+    files   name (32 bytes), offset (u32), size (u32), CRC32 of the data (u32)
+
+The header CRC lets the device notice an index left over from another model
+image and fall back to esp_srmodel_init.
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+INDEX_MAGIC = 0x494D5253
+INDEX_VERSION = 1
+NAME_LEN = 32
+HEADER = struct.Struct('<IHHHHIIII4x')
+MODEL = struct.Struct('<32sHH')
+FILE = struct.Struct('<32sIII')
+PACK_FILE = struct.Struct('<32sII')
+
+
+class ModelIndexError(Exception):
+    pass
+
+
+def crc32(data):
+    return zlib.crc32(data) & 0xFFFFFFFF
+
+
+def c_name(raw):
+    return raw.split(b'\0', 1)[0].decode()
+
+
+def parse_image(image):
+    """srmodels.bin to (header size, [(model name, [(file name, offset, size)])])"""
+    if len(image) < 4:
+        raise ModelIndexError('image too short')
+    num = struct.unpack_from('<I', image)[0]
+    pos = 4
+    models = []
+    for _ in range(num):
+        if pos + NAME_LEN + 4 > len(image):
+            raise ModelIndexError('model table runs past the image')
+        name = c_name(image[pos:pos + NAME_LEN])
+        file_num = struct.unpack_from('<I', image, pos + NAME_LEN)[0]
+        pos += NAME_LEN + 4
+        files = []
+        for _ in range(file_num):
+            if pos + PACK_FILE.size > len(image):
+                raise ModelIndexError('file table of %s runs past the image' % name)
+            fname, offset, size = PACK_FILE.unpack_from(image, pos)
+            pos += PACK_FILE.size
+            files.append((c_name(fname), offset, size))
+        models.append((name, files))
+    for name, files in models:
+        for fname, offset, size in files:
+            if offset < pos or offset + size > len(image):
+                raise ModelIndexError('%s/%s lies outside the image data' % (name, fname))
+    return pos, models
+
+
+def build_index(image):
+    header_size, models = parse_image(image)
+    model_table = bytearray()
+    file_table = bytearray()
+    file_num = 0
+    for name, files in models:
+        if len(name.encode()) >= NAME_LEN:
+            raise ModelIndexError('model name %s too long' % name)
+        model_table += MODEL.pack(name.encode(), file_num, len(files))
+        for fname, offset, size in files:
+            file_table += FILE.pack(fname.encode(), offset, size, crc32(image[offset:offset + size]))
+            file_num += 1
+    tables = bytes(model_table + file_table)
+    header = HEADER.pack(INDEX_MAGIC, INDEX_VERSION, len(models), file_num, 0, len(image), header_size,
+                         crc32(image[:header_size]), crc32(tables))
+    return header + tables
+
+
+def parse_index(index):
+    """Index to (header fields, [(model name, [(file name, offset, size, crc)])])"""
+    if len(index) < HEADER.size:
+        raise ModelIndexError('index too short')
+    magic, version, model_num, file_num, _, image_size, header_size, header_crc, table_crc = HEADER.unpack_from(index)
+    if magic != INDEX_MAGIC or version != INDEX_VERSION:
+        raise ModelIndexError('not a model index')
+    end = HEADER.size + model_num * MODEL.size + file_num * FILE.size
+    if len(index) < end:
+        raise ModelIndexError('index tables truncated')
+    if crc32(index[HEADER.size:end]) != table_crc:
+        raise ModelIndexError('index table CRC mismatch')
+    files = [FILE.unpack_from(index, HEADER.size + model_num * MODEL.size + i * FILE.size) for i in range(file_num)]
+    models = []
+    for i in range(model_num):
+        name, first, num = MODEL.unpack_from(index, HEADER.size + i * MODEL.size)
+        if first + num > file_num:
+            raise ModelIndexError('model %s refers past the file table' % c_name(name))
+        models.append((c_name(name), [(c_name(f[0]), f[1], f[2], f[3]) for f in files[first:first + num]]))
+    return (image_size, header_size, header_crc), models
+
+
+def check_index(index, image):
+    """Raise when the index does not describe the image exactly"""
+    (image_size, header_size, header_crc), models = parse_index(index)
+    if image_size != len(image) or header_size > len(image) or crc32(image[:header_size]) != header_crc:
+        raise ModelIndexError('index belongs to another model image')
+    if parse_image(image)[1] != [(n, [f[:3] for f in fs]) for n, fs in models]:
+        raise ModelIndexError('model tables differ from the image')
+    for name, files in models:
+        for fname, offset, size, crc in files:
+            if crc32(image[offset:offset + size]) != crc:
+                raise ModelIndexError('%s/%s CRC mismatch' % (name, fname))
+    return models
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest='cmd', required=True)
+    build = sub.add_parser('build', help='Write the index of srmodels.bin')
+    build.add_argument('image', help='Packed model image, srmodels.bin')
+    build.add_argument('-o', '--output', required=True, help='Index file')
+    build.add_argument('--max-size', type=lambda x: int(x, 0), default=0, help='Fail when the index is larger')
+    check = sub.add_parser('check', help='Verify an index against srmodels.bin')
+    check.add_argument('image', help='Packed model image, srmodels.bin')
+    check.add_argument('index', help='Index file')
+    args = parser.parse_args()
+
+    try:
+        with open(args.image, 'rb') as f:
+            image = f.read()
+        if args.cmd == 'build':
+            index = build_index(image)
+            if args.max_size and len(index) > args.max_size:
+                raise ModelIndexError('index of %d bytes does not fit %d' % (len(index), args.max_size))
+            check_index(index, image)
+            with open(args.output, 'wb') as f:
+                f.write(index)
+            models = parse_index(index)[1]
+        else:
+            with open(args.index, 'rb') as f:
+                models = check_index(f.read(), image)
+    except ModelIndexError as e:
+        sys.exit('%s: %s' % (args.image, e))
+    for name, files in models:
+        print('%-24s %2d files %8d bytes' % (name, len(files), sum(f[2] for f in files)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+"""
+Host test for sr_model_index.py, run by `python3 -m unittest` inside tools
+"""
+
+import random
+import struct
+import unittest
+
+import sr_model_index as idx
+
+
+def pack_models(models, align=16):
+    """Same layout as the srmodels.bin written by esp-sr"""
+    header_size = 4 + sum(idx.NAME_LEN + 4 + len(files) * idx.PACK_FILE.size for _, files in models)
+    header = bytearray(struct.pack('<I', len(models)))
+    data = bytearray()
+    for name, files in models:
+        header += struct.pack('<32sI', name.encode(), len(files))
+        for fname, content in files:
+            data += bytes(-(header_size + len(data)) % align)
+            header += idx.PACK_FILE.pack(fname.encode(), header_size + len(data), len(content))
+            data += content
+    return bytes(header + data)
+
+
+class TestModelIndex(unittest.TestCase):
+
+    def setUp(self):
+        rnd = random.Random(5168)
+        blob = lambda n: bytes(rnd.getrandbits(8) for _ in range(n))
+        self.models = [
+            ('wn9_jarvis_tts', [('_MODEL_INFO_', blob(60)), ('wn9_data', blob(3000)), ('wn9_index', blob(77))]),
+            ('mn5q8_en', [('_MODEL_INFO_', blob(40)), ('mn5q8_data', blob(5000)), ('vocab', blob(1))]),
+            ('nsnet1', [('nsnet1_data', blob(900))]),
+        ]
+        self.image = pack_models(self.models)
+
+    def test_build_and_check(self):
+        index = idx.build_index(self.image)
+        models = idx.check_index(index, self.image)
+        self.assertEqual([m[0] for m in models], [m[0] for m in self.models])
+        for (name, files), (_, ref_files) in zip(models, self.models):
+            for (fname, offset, size, _), (ref_name, content) in zip(files, ref_files):
+                self.assertEqual(fname, ref_name)
+                self.assertEqual(self.image[offset:offset + size], content)
+        # Index stays far below the 4 KB partition
+        self.assertLess(len(index), 1024)
+
+    def test_stale_index(self):
+        index = idx.build_index(self.image)
+        other = pack_models(self.models[:2])
+        with self.assertRaises(idx.ModelIndexError):
+            idx.check_index(index, other)
+        # Same layout but different model data is caught by the file CRCs
+        changed = bytearray(self.image)
+        changed[-1] ^= 0x80
+        with self.assertRaises(idx.ModelIndexError):
+            idx.check_index(index, bytes(changed))
+
+    def test_corrupt_index(self):
+        index = bytearray(idx.build_index(self.image))
+        index[idx.HEADER.size + 3] ^= 0x01
+        with self.assertRaises(idx.ModelIndexError):
+            idx.parse_index(bytes(index))
+        with self.assertRaises(idx.ModelIndexError):
+            idx.parse_index(bytes(index[:40]))
+
+    def test_bad_image(self):
+        truncated = self.image[:len(self.image) - 10]
+        with self.assertRaises(idx.ModelIndexError):
+            idx.build_index(truncated)
+        with self.assertRaises(idx.ModelIndexError):
+            idx.build_index(b'\x05\x00')
+
+
+if __name__ == '__main__':
+    unittest.main()
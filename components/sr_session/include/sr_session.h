@@ -0,0 +1,164 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Wake word -> command states
+ *
+ * The session module only keeps the bookkeeping. It does not call into the AFE
+ * or MultiNet itself, the caller translates fetch/detect results into events and
+ * applies the returned actions. This keeps it free of ESP-IDF dependencies.
+ */
+typedef enum {
+    SR_STATE_IDLE = 0,       /*!< Only WakeNet is running, waiting for the wake word */
+    SR_STATE_WAKE_VERIFY,    /*!< Wake word detected, waiting for the AFE channel verification */
+    SR_STATE_LISTEN,         /*!< MultiNet decoding the first command after the wake word */
+    SR_STATE_CONTINUOUS,     /*!< Multi-command session, MultiNet keeps decoding after a command */
+    SR_STATE_MAX,
+} sr_state_t;
+
+/**
+ * @brief Inputs to the state machine, mapped from AFE and MultiNet results
+ */
+typedef enum {
+    SR_EVENT_NONE = 0,       /*!< Nothing happened on this frame, only deadlines are checked */
+    SR_EVENT_WAKE_DETECTED,  /*!< AFE reported WAKENET_DETECTED */
+    SR_EVENT_WAKE_VERIFIED,  /*!< AFE reported WAKENET_CHANNEL_VERIFIED */
+    SR_EVENT_CMD_DETECTED,   /*!< MultiNet returned ESP_MN_STATE_DETECTED */
+    SR_EVENT_CMD_DETECTED_KEEP, /*!< As `SR_EVENT_CMD_DETECTED`, for a command which leaves the listen window open */
+    SR_EVENT_CMD_TIMEOUT,    /*!< MultiNet returned ESP_MN_STATE_TIMEOUT */
+} sr_event_t;
+
+/**
+ * @brief Actions the caller must perform after a step, combined as a bit mask
+ */
+typedef enum {
+    SR_ACTION_NONE            = 0,
+    SR_ACTION_MN_CLEAN        = (1 << 0), /*!< Reset MultiNet decoder state (`multinet->clean`) */
+    SR_ACTION_WAKENET_ENABLE  = (1 << 1), /*!< Re-enable WakeNet (`afe_handle->enable_wakenet`) */
+    SR_ACTION_DISPATCH        = (1 << 2), /*!< The detected command has been accepted and should be executed */
+    SR_ACTION_LISTEN_END      = (1 << 3), /*!< Command recognition finished, back to waiting for the wake word */
+    SR_ACTION_WAKENET_DISABLE = (1 << 4), /*!< Disable WakeNet while commands are decoded (`afe_handle->disable_wakenet`) */
+} sr_action_t;
+
+/**
+ * @brief Listen window configuration, all values in milliseconds
+ */
+typedef struct {
+    uint32_t verify_window_ms;  /*!< Maximum time between wake detection and channel verification */
+    uint32_t listen_window_ms;  /*!< Time allowed for the first command after the wake word */
+    uint32_t continuous_ms;     /*!< Keep recognising commands for this long after the first one, 0 for no limit */
+    uint32_t session_idle_ms;   /*!< End the session when no command follows within this time, re-armed on
+                                     every command. Session mode is off when this and `continuous_ms` are 0 */
+} sr_session_cfg_t;
+
+#define SR_SESSION_DEFAULT_CONFIG() {   \
+    .verify_window_ms = 1000,           \
+    .listen_window_ms = 6000,           \
+    .continuous_ms = 0,                 \
+    .session_idle_ms = 0,               \
+}
+
+/**
+ * @brief Latency accumulator in milliseconds
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t min_ms;
+    uint32_t max_ms;
+    uint64_t total_ms;
+} sr_latency_stat_t;
+
+/**
+ * @brief Session counters
+ */
+typedef struct {
+    uint32_t time_in_state_ms[SR_STATE_MAX]; /*!< Accumulated time spent in each state */
+    uint32_t enter_count[SR_STATE_MAX];      /*!< Number of times each state has been entered */
+    uint32_t wakes;                          /*!< Verified wake words */
+    uint32_t commands;                       /*!< Dispatched commands */
+    uint32_t timeouts;                       /*!< Listen windows which ended without a command */
+    uint32_t sessions;                       /*!< Finished sessions which dispatched at least one command */
+    uint32_t last_session_commands;          /*!< Commands dispatched in the last finished session */
+    uint32_t last_session_ms;                /*!< Wake verification to end of the last finished session */
+    sr_latency_stat_t first_cmd;             /*!< Wake verification to first command */
+    sr_latency_stat_t next_cmd;              /*!< Command to the following command in the same session */
+    sr_latency_stat_t session_len;           /*!< Session length, wake verification to session end */
+} sr_session_stats_t;
+
+/**
+ * @brief Session instance, allocated by the caller
+ */
+typedef struct {
+    sr_session_cfg_t   cfg;
+    sr_state_t         state;
+    uint32_t           state_enter_ms;
+    uint32_t           deadline_ms;
+    uint32_t           session_start_ms;
+    uint32_t           first_cmd_ms;
+    uint32_t           last_cmd_ms;
+    uint32_t           session_commands;
+    sr_session_stats_t stats;
+} sr_session_t;
+
+/**
+ * @brief Initialize a session in `SR_STATE_IDLE`
+ *
+ * @param session Session instance
+ * @param cfg Listen window configuration, NULL to use `SR_SESSION_DEFAULT_CONFIG`
+ * @param now_ms Current time in milliseconds
+ */
+void sr_session_init(sr_session_t *session, const sr_session_cfg_t *cfg, uint32_t now_ms);
+
+/**
+ * @brief Advance the state machine
+ *
+ * Call once per fetched AFE frame with the wake event (or `SR_EVENT_NONE`), and
+ * once more with the MultiNet event if `sr_session_wants_command` was true and
+ * MultiNet reported something other than detecting.
+ *
+ * @param session Session instance
+ * @param event Event observed on this frame
+ * @param now_ms Current time in milliseconds
+ * @return Bit mask of `sr_action_t` to be applied by the caller
+ */
+uint32_t sr_session_step(sr_session_t *session, sr_event_t event, uint32_t now_ms);
+
+/**
+ * @brief Whether the current frame should be fed to MultiNet
+ */
+bool sr_session_wants_command(const sr_session_t *session);
+
+/**
+ * @brief Whether a multi-command session is open, commands keep being decoded after the last one
+ */
+bool sr_session_is_continuous(const sr_session_t *session);
+
+/**
+ * @brief Whether the session waits for the wake word, only WakeNet has to run
+ */
+bool sr_session_is_idle(const sr_session_t *session);
+
+/**
+ * @brief Get counters, including the time spent so far in the current state
+ */
+void sr_session_get_stats(const sr_session_t *session, uint32_t now_ms, sr_session_stats_t *stats);
+
+/**
+ * @brief Print counters and per-session latency to the console
+ */
+void sr_session_print_stats(const sr_session_t *session, uint32_t now_ms);
+
+/**
+ * @brief Get printable state name
+ */
+const char *sr_state_name(sr_state_t state);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <string.h>
+#include "sr_session.h"
+
+static const char *state_names[SR_STATE_MAX] = {
+    [SR_STATE_IDLE] = "idle",
+    [SR_STATE_WAKE_VERIFY] = "wake_verify",
+    [SR_STATE_LISTEN] = "listen",
+    [SR_STATE_CONTINUOUS] = "continuous",
+};
+
+// deadline comparison which survives the 32 bit millisecond counter wrapping
+static inline bool time_reached(uint32_t now_ms, uint32_t deadline_ms)
+{
+    return (int32_t)(now_ms - deadline_ms) >= 0;
+}
+
+static void session_enter(sr_session_t *session, sr_state_t state, uint32_t now_ms, uint32_t window_ms)
+{
+    session->stats.time_in_state_ms[session->state] += now_ms - session->state_enter_ms;
+    session->stats.enter_count[state]++;
+    session->state = state;
+    session->state_enter_ms = now_ms;
+    session->deadline_ms = now_ms + window_ms;
+}
+
+static void latency_add(sr_latency_stat_t *stat, uint32_t value_ms)
+{
+    if (stat->count == 0 || value_ms < stat->min_ms) {
+        stat->min_ms = value_ms;
+    }
+    if (value_ms > stat->max_ms) {
+        stat->max_ms = value_ms;
+    }
+    stat->total_ms += value_ms;
+    stat->count++;
+}
+
+static void latency_print(const char *name, const sr_latency_stat_t *stat)
+{
+    if (stat->count == 0) {
+        printf("  %-12s -\n", name);
+        return;
+    }
+    printf("  %-12s avg %u ms, min %u ms, max %u ms (%u)\n", name,
+           (unsigned) (stat->total_ms / stat->count), (unsigned) stat->min_ms,
+           (unsigned) stat->max_ms, (unsigned) stat->count);
+}
+
+static inline bool session_mode(const sr_session_t *session)
+{
+    return session->cfg.continuous_ms || session->cfg.session_idle_ms;
+}
+
+// idle timeout from the last command, capped by the continuous window from the first one
+static uint32_t session_deadline(const sr_session_t *session)
+{
+    uint32_t cap_ms = session->first_cmd_ms + session->cfg.continuous_ms;
+    if (session->cfg.session_idle_ms == 0) {
+        return cap_ms;
+    }
+    uint32_t idle_ms = session->last_cmd_ms + session->cfg.session_idle_ms;
+    if (session->cfg.continuous_ms && time_reached(idle_ms, cap_ms)) {
+        return cap_ms;
+    }
+    return idle_ms;
+}
+
+static uint32_t session_finish(sr_session_t *session, uint32_t now_ms)
+{
+    if (session->session_commands) {
+        session->stats.sessions++;
+        session->stats.last_session_commands = session->session_commands;
+        session->stats.last_session_ms = now_ms - session->session_start_ms;
+        latency_add(&session->stats.session_len, session->stats.last_session_ms);
+        session->session_commands = 0;
+    }
+    session_enter(session, SR_STATE_IDLE, now_ms, 0);
+    return SR_ACTION_WAKENET_ENABLE | SR_ACTION_LISTEN_END;
+}
+
+void sr_session_init(sr_session_t *session, const sr_session_cfg_t *cfg, uint32_t now_ms)
+{
+    sr_session_cfg_t default_cfg = SR_SESSION_DEFAULT_CONFIG();
+    memset(session, 0, sizeof(sr_session_t));
+    session->cfg = cfg ? *cfg : default_cfg;
+    session->state = SR_STATE_IDLE;
+    session->state_enter_ms = now_ms;
+    session->stats.enter_count[SR_STATE_IDLE] = 1;
+}
+
+uint32_t sr_session_step(sr_session_t *session, sr_event_t event, uint32_t now_ms)
+{
+    uint32_t actions = SR_ACTION_NONE;
+
+    // Listen windows are enforced here and not only by the MultiNet timeout
+    if (session->state != SR_STATE_IDLE && time_reached(now_ms, session->deadline_ms)) {
+        if (session->state == SR_STATE_WAKE_VERIFY) {
+            session_enter(session, SR_STATE_IDLE, now_ms, 0);
+        } else {
+            if (session->state == SR_STATE_LISTEN && session->session_commands == 0) {
+                session->stats.timeouts++;
+            }
+            actions |= session_finish(session, now_ms);
+        }
+    }
+
+    switch (event) {
+    case SR_EVENT_WAKE_DETECTED:
+        // WakeNet is off while commands are decoded, never restart a running session
+        if (sr_session_wants_command(session)) {
+            break;
+        }
+        session_enter(session, SR_STATE_WAKE_VERIFY, now_ms, session->cfg.verify_window_ms);
+        actions |= SR_ACTION_MN_CLEAN;
+        break;
+
+    case SR_EVENT_WAKE_VERIFIED:
+        if (sr_session_wants_command(session)) {
+            break;
+        }
+        if (session->state != SR_STATE_WAKE_VERIFY) {
+            actions |= SR_ACTION_MN_CLEAN;
+        }
+        session->stats.wakes++;
+        session->session_start_ms = now_ms;
+        session->session_commands = 0;
+        session_enter(session, SR_STATE_LISTEN, now_ms, session->cfg.listen_window_ms);
+        actions |= SR_ACTION_WAKENET_DISABLE;
+        break;
+
+    case SR_EVENT_CMD_DETECTED:
+    case SR_EVENT_CMD_DETECTED_KEEP:
+        if (!sr_session_wants_command(session)) {
+            break;
+        }
+        if (session->session_commands == 0) {
+            latency_add(&session->stats.first_cmd, now_ms - session->session_start_ms);
+            session->first_cmd_ms = now_ms;
+        } else {
+            latency_add(&session->stats.next_cmd, now_ms - session->last_cmd_ms);
+        }
+        session->last_cmd_ms = now_ms;
+        session->session_commands++;
+        session->stats.commands++;
+        actions |= SR_ACTION_DISPATCH;
+        if (!session_mode(session)) {
+            // the listen window stays open and MultiNet keeps decoding until it times out
+            if (event == SR_EVENT_CMD_DETECTED) {
+                actions |= session_finish(session, now_ms);
+            }
+            break;
+        }
+        if (session->state == SR_STATE_LISTEN) {
+            session_enter(session, SR_STATE_CONTINUOUS, now_ms, 0);
+        }
+        session->deadline_ms = session_deadline(session);
+        // decode the next command from a clean state, WakeNet stays off
+        actions |= SR_ACTION_MN_CLEAN;
+        break;
+
+    case SR_EVENT_CMD_TIMEOUT:
+        if (session->state == SR_STATE_LISTEN) {
+            if (session->session_commands == 0) {
+                session->stats.timeouts++;
+            }
+            actions |= session_finish(session, now_ms);
+        } else if (session->state == SR_STATE_CONTINUOUS) {
+            // MultiNet gave up on this command but the session is still open
+            actions |= SR_ACTION_MN_CLEAN;
+        }
+        break;
+
+    default:
+        break;
+    }
+    return actions;
+}
+
+bool sr_session_wants_command(const sr_session_t *session)
+{
+    return session->state == SR_STATE_LISTEN || session->state == SR_STATE_CONTINUOUS;
+}
+
+bool sr_session_is_continuous(const sr_session_t *session)
+{
+    return session->state == SR_STATE_CONTINUOUS;
+}
+
+bool sr_session_is_idle(const sr_session_t *session)
+{
+    return session->state == SR_STATE_IDLE;
+}
+
+void sr_session_get_stats(const sr_session_t *session, uint32_t now_ms, sr_session_stats_t *stats)
+{
+    *stats = session->stats;
+    stats->time_in_state_ms[session->state] += now_ms - session->state_enter_ms;
+}
+
+void sr_session_print_stats(const sr_session_t *session, uint32_t now_ms)
+{
+    sr_session_stats_t stats;
+    sr_session_get_stats(session, now_ms, &stats);
+    printf("session: wakes %u, commands %u, timeouts %u, sessions %u\n",
+           (unsigned) stats.wakes, (unsigned) stats.commands, (unsigned) stats.timeouts,
+           (unsigned) stats.sessions);
+    for (int i = 0; i < SR_STATE_MAX; i++) {
+        printf("  %-12s entered %u, %u ms\n", state_names[i],
+               (unsigned) stats.enter_count[i], (unsigned) stats.time_in_state_ms[i]);
+    }
+    if (stats.sessions) {
+        printf("  last session %u commands in %u ms\n",
+               (unsigned) stats.last_session_commands, (unsigned) stats.last_session_ms);
+    }
+    latency_print("first_cmd", &stats.first_cmd);
+    latency_print("next_cmd", &stats.next_cmd);
+    latency_print("session_len", &stats.session_len);
+}
+
+const char *sr_state_name(sr_state_t state)
+{
+    if (state < SR_STATE_IDLE || state >= SR_STATE_MAX) {
+        return "unknown";
+    }
+    return state_names[state];
+}
@@ -0,0 +1,162 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "sr_session.h"
+
+/*
+ * One AFE fetch or MultiNet result as detect_Task turns it into an event, with the
+ * state and actions the session must answer with
+ */
+typedef struct {
+    uint32_t   t_ms;
+    sr_event_t event;
+    sr_state_t state;
+    uint32_t   actions;
+} script_step_t;
+
+#define ACT_WAKE_END    (SR_ACTION_WAKENET_ENABLE | SR_ACTION_LISTEN_END)
+
+static void run_script(sr_session_t *session, const script_step_t *script, int num)
+{
+    for (int i = 0; i < num; i++) {
+        uint32_t actions = sr_session_step(session, script[i].event, script[i].t_ms);
+        char msg[48];
+        snprintf(msg, sizeof(msg), "step %d at %u ms", i, (unsigned) script[i].t_ms);
+        TEST_ASSERT_EQUAL_MESSAGE(script[i].state, session->state, msg);
+        TEST_ASSERT_EQUAL_HEX32_MESSAGE(script[i].actions, actions, msg);
+        TEST_ASSERT_EQUAL_MESSAGE(script[i].state == SR_STATE_LISTEN || script[i].state == SR_STATE_CONTINUOUS,
+                                  sr_session_wants_command(session), msg);
+        TEST_ASSERT_EQUAL_MESSAGE(script[i].state == SR_STATE_CONTINUOUS, sr_session_is_continuous(session), msg);
+        TEST_ASSERT_EQUAL_MESSAGE(script[i].state == SR_STATE_IDLE, sr_session_is_idle(session), msg);
+    }
+}
+
+TEST_CASE("sr_session wake word, command, timeout", "[sr_session]")
+{
+    sr_session_t session;
+    sr_session_init(&session, NULL, 0);
+    const script_step_t script[] = {
+        { 100,  SR_EVENT_NONE,           SR_STATE_IDLE,        0 },
+        { 200,  SR_EVENT_WAKE_DETECTED,  SR_STATE_WAKE_VERIFY, SR_ACTION_MN_CLEAN },
+        { 260,  SR_EVENT_WAKE_VERIFIED,  SR_STATE_LISTEN,      SR_ACTION_WAKENET_DISABLE },
+        { 1000, SR_EVENT_NONE,           SR_STATE_LISTEN,      0 },
+        { 1500, SR_EVENT_CMD_DETECTED,   SR_STATE_IDLE,        SR_ACTION_DISPATCH | ACT_WAKE_END },
+        // a command after the window closed is not dispatched
+        { 1600, SR_EVENT_CMD_DETECTED,   SR_STATE_IDLE,        0 },
+        { 3000, SR_EVENT_WAKE_DETECTED,  SR_STATE_WAKE_VERIFY, SR_ACTION_MN_CLEAN },
+        { 3050, SR_EVENT_WAKE_VERIFIED,  SR_STATE_LISTEN,      SR_ACTION_WAKENET_DISABLE },
+        { 9000, SR_EVENT_CMD_TIMEOUT,    SR_STATE_IDLE,        ACT_WAKE_END },
+    };
+    run_script(&session, script, sizeof(script) / sizeof(script[0]));
+
+    sr_session_stats_t stats;
+    sr_session_get_stats(&session, 10000, &stats);
+    TEST_ASSERT_EQUAL(2, stats.wakes);
+    TEST_ASSERT_EQUAL(1, stats.commands);
+    TEST_ASSERT_EQUAL(1, stats.timeouts);
+    TEST_ASSERT_EQUAL(1, stats.first_cmd.count);
+    TEST_ASSERT_EQUAL(1500 - 260, stats.first_cmd.max_ms);
+    TEST_ASSERT_EQUAL(3, stats.enter_count[SR_STATE_IDLE]);
+    TEST_ASSERT_EQUAL(2, stats.enter_count[SR_STATE_LISTEN]);
+    TEST_ASSERT_EQUAL(10000, stats.time_in_state_ms[SR_STATE_IDLE] + stats.time_in_state_ms[SR_STATE_WAKE_VERIFY] +
+                      stats.time_in_state_ms[SR_STATE_LISTEN]);
+}
+
+TEST_CASE("sr_session windows close on their own deadlines", "[sr_session]")
+{
+    sr_session_t session;
+    sr_session_cfg_t cfg = SR_SESSION_DEFAULT_CONFIG();
+    cfg.verify_window_ms = 500;
+    cfg.listen_window_ms = 2000;
+    sr_session_init(&session, &cfg, 0);
+    const script_step_t script[] = {
+        // channel verification never came
+        { 100,  SR_EVENT_WAKE_DETECTED,  SR_STATE_WAKE_VERIFY, SR_ACTION_MN_CLEAN },
+        { 599,  SR_EVENT_NONE,           SR_STATE_WAKE_VERIFY, 0 },
+        { 600,  SR_EVENT_NONE,           SR_STATE_IDLE,        0 },
+        // verified without a detection first, MultiNet still starts clean
+        { 1000, SR_EVENT_WAKE_VERIFIED,  SR_STATE_LISTEN,      SR_ACTION_MN_CLEAN | SR_ACTION_WAKENET_DISABLE },
+        // WakeNet is off while listening, late results are ignored
+        { 1200, SR_EVENT_WAKE_DETECTED,  SR_STATE_LISTEN,      0 },
+        { 1300, SR_EVENT_WAKE_VERIFIED,  SR_STATE_LISTEN,      0 },
+        // the listen window holds even when MultiNet does not time out
+        { 3000, SR_EVENT_NONE,           SR_STATE_IDLE,        ACT_WAKE_END },
+    };
+    run_script(&session, script, sizeof(script) / sizeof(script[0]));
+    TEST_ASSERT_EQUAL(1, session.stats.wakes);
+    TEST_ASSERT_EQUAL(1, session.stats.timeouts);
+    TEST_ASSERT_EQUAL(0, session.stats.sessions);
+}
+
+TEST_CASE("sr_session keeps listening after a command which leaves the window open", "[sr_session]")
+{
+    sr_session_t session;
+    sr_session_init(&session, NULL, 0);
+    const script_step_t script[] = {
+        { 0,    SR_EVENT_WAKE_DETECTED,     SR_STATE_WAKE_VERIFY, SR_ACTION_MN_CLEAN },
+        { 50,   SR_EVENT_WAKE_VERIFIED,     SR_STATE_LISTEN,      SR_ACTION_WAKENET_DISABLE },
+        // MultiNet keeps its state, no clean between the two commands
+        { 900,  SR_EVENT_CMD_DETECTED_KEEP, SR_STATE_LISTEN,      SR_ACTION_DISPATCH },
+        { 1700, SR_EVENT_CMD_DETECTED,      SR_STATE_IDLE,        SR_ACTION_DISPATCH | ACT_WAKE_END },
+        { 2000, SR_EVENT_WAKE_DETECTED,     SR_STATE_WAKE_VERIFY, SR_ACTION_MN_CLEAN },
+        { 2050, SR_EVENT_WAKE_VERIFIED,     SR_STATE_LISTEN,      SR_ACTION_WAKENET_DISABLE },
+        { 2500, SR_EVENT_CMD_DETECTED_KEEP, SR_STATE_LISTEN,      SR_ACTION_DISPATCH },
+        { 8050, SR_EVENT_CMD_TIMEOUT,       SR_STATE_IDLE,        ACT_WAKE_END },
+    };
+    run_script(&session, script, sizeof(script) / sizeof(script[0]));
+    TEST_ASSERT_EQUAL(3, session.stats.commands);
+    // both windows saw a command, neither counts as a timeout
+    TEST_ASSERT_EQUAL(0, session.stats.timeouts);
+    TEST_ASSERT_EQUAL(2, session.stats.sessions);
+    TEST_ASSERT_EQUAL(1, session.stats.next_cmd.count);
+    TEST_ASSERT_EQUAL(800, session.stats.next_cmd.max_ms);
+}
+
+TEST_CASE("sr_session multi-command session ends when idle", "[sr_session]")
+{
+    sr_session_t session;
+    sr_session_cfg_t cfg = SR_SESSION_DEFAULT_CONFIG();
+    cfg.session_idle_ms = 4000;
+    sr_session_init(&session, &cfg, 0);
+    const script_step_t script[] = {
+        { 0,     SR_EVENT_WAKE_DETECTED,     SR_STATE_WAKE_VERIFY, SR_ACTION_MN_CLEAN },
+        { 50,    SR_EVENT_WAKE_VERIFIED,     SR_STATE_LISTEN,      SR_ACTION_WAKENET_DISABLE },
+        { 1000,  SR_EVENT_CMD_DETECTED,      SR_STATE_CONTINUOUS,  SR_ACTION_DISPATCH | SR_ACTION_MN_CLEAN },
+        // MultiNet giving up on one command does not end the session
+        { 3000,  SR_EVENT_CMD_TIMEOUT,       SR_STATE_CONTINUOUS,  SR_ACTION_MN_CLEAN },
+        { 4500,  SR_EVENT_CMD_DETECTED_KEEP, SR_STATE_CONTINUOUS,  SR_ACTION_DISPATCH | SR_ACTION_MN_CLEAN },
+        { 8499,  SR_EVENT_NONE,              SR_STATE_CONTINUOUS,  0 },
+        { 8500,  SR_EVENT_NONE,              SR_STATE_IDLE,        ACT_WAKE_END },
+    };
+    run_script(&session, script, sizeof(script) / sizeof(script[0]));
+    TEST_ASSERT_EQUAL(1, session.stats.sessions);
+    TEST_ASSERT_EQUAL(2, session.stats.last_session_commands);
+    TEST_ASSERT_EQUAL(8500 - 50, session.stats.last_session_ms);
+    TEST_ASSERT_EQUAL(3500, session.stats.next_cmd.max_ms);
+}
+
+TEST_CASE("sr_session continuous window caps the session and survives the clock wrap", "[sr_session]")
+{
+    sr_session_t session;
+    sr_session_cfg_t cfg = SR_SESSION_DEFAULT_CONFIG();
+    cfg.continuous_ms = 3000;
+    cfg.session_idle_ms = 2000;
+    const uint32_t t0 = UINT32_MAX - 1000;
+    sr_session_init(&session, &cfg, t0);
+    const script_step_t script[] = {
+        { t0 + 0,    SR_EVENT_WAKE_DETECTED, SR_STATE_WAKE_VERIFY, SR_ACTION_MN_CLEAN },
+        { t0 + 10,   SR_EVENT_WAKE_VERIFIED, SR_STATE_LISTEN,      SR_ACTION_WAKENET_DISABLE },
+        { t0 + 500,  SR_EVENT_CMD_DETECTED,  SR_STATE_CONTINUOUS,  SR_ACTION_DISPATCH | SR_ACTION_MN_CLEAN },
+        { t0 + 2000, SR_EVENT_CMD_DETECTED,  SR_STATE_CONTINUOUS,  SR_ACTION_DISPATCH | SR_ACTION_MN_CLEAN },
+        { t0 + 3000, SR_EVENT_CMD_DETECTED,  SR_STATE_CONTINUOUS,  SR_ACTION_DISPATCH | SR_ACTION_MN_CLEAN },
+        // idle would allow until 5000, the first command plus the continuous window stops at 3500
+        { t0 + 3499, SR_EVENT_NONE,          SR_STATE_CONTINUOUS,  0 },
+        { t0 + 3500, SR_EVENT_NONE,          SR_STATE_IDLE,        ACT_WAKE_END },
+    };
+    run_script(&session, script, sizeof(script) / sizeof(script[0]));
+    TEST_ASSERT_EQUAL(3, session.stats.last_session_commands);
+    TEST_ASSERT_EQUAL(3490, session.stats.last_session_ms);
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Energy/zero-crossing pre-VAD placed in front of `afe_handle->feed`
+ *
+ * Frames are the raw interleaved int16 buffers returned by `esp_get_feed_data`.
+ * While the gate is closed nothing reaches the AFE, the latest frames are kept in
+ * a pre-roll ring which is flushed in order as soon as the gate opens, so the start
+ * of the wake word is never lost. Every open period is one contiguous run of audio.
+ */
+typedef struct {
+    int      channels;            /*!< Interleaved channels per frame */
+    int      frame_samples;       /*!< Samples per channel in one frame (AFE feed chunk size) */
+    uint32_t mic_mask;            /*!< Channels carrying a microphone, bit n for channel n, 0 for all */
+    uint16_t open_ratio_q8;       /*!< Energy over the noise floor needed to open the gate, Q8 */
+    uint16_t close_ratio_q8;      /*!< Energy over the noise floor needed to keep the gate open, Q8 */
+    uint32_t min_energy;          /*!< Lowest noise floor, mean square of a sample */
+    uint16_t zcr_min;             /*!< Zero crossings per channel which mark a quiet fricative as active */
+    int      hangover_frames;     /*!< Frames the gate stays open after the signal became quiet */
+    int      preroll_frames;      /*!< Dropped frames kept for replay when the gate opens */
+    int      open_rise_shift;     /*!< While open the noise floor rises by 1/2^N of the gap to the frame
+                                       energy, so a lasting step in background noise closes the gate again */
+} sr_vad_gate_cfg_t;
+
+#define SR_VAD_GATE_DEFAULT_CONFIG(ch, samples) {   \
+    .channels = (ch),                               \
+    .frame_samples = (samples),                     \
+    .mic_mask = 0,                                  \
+    .open_ratio_q8 = 4 * 256,                       \
+    .close_ratio_q8 = 2 * 256,                      \
+    .min_energy = 64,                               \
+    .zcr_min = 96,                                  \
+    .hangover_frames = 30,                          \
+    .preroll_frames = 10,                           \
+    .open_rise_shift = 9,                           \
+}
+
+/**
+ * @brief Gate counters
+ */
+typedef struct {
+    uint32_t frames;        /*!< Frames processed */
+    uint32_t fed;           /*!< Frames passed to the AFE, including replayed pre-roll */
+    uint32_t dropped;       /*!< Frames never passed to the AFE */
+    uint32_t opens;         /*!< Closed -> open transitions */
+    uint32_t noise_floor;   /*!< Current noise floor estimate */
+} sr_vad_gate_stats_t;
+
+typedef struct sr_vad_gate sr_vad_gate_t;
+
+/**
+ * @brief Called for each frame which should reach the AFE, in capture order
+ */
+typedef void (*sr_vad_gate_feed_t)(void *ctx, const int16_t *frame);
+
+/**
+ * @brief Create a gate
+ *
+ * @return Gate handle, NULL on invalid configuration or out of memory
+ */
+sr_vad_gate_t *sr_vad_gate_create(const sr_vad_gate_cfg_t *cfg);
+
+/**
+ * @brief Destroy a gate
+ */
+void sr_vad_gate_destroy(sr_vad_gate_t *gate);
+
+/**
+ * @brief Classify one frame and forward it, together with any pending pre-roll, to `feed`
+ *
+ * @param gate Gate handle
+ * @param frame Interleaved frame of `channels * frame_samples` samples
+ * @param feed Callback which passes a frame to the AFE
+ * @param ctx User context for `feed`
+ * @return Number of frames passed to `feed`
+ */
+int sr_vad_gate_process(sr_vad_gate_t *gate, const int16_t *frame, sr_vad_gate_feed_t feed, void *ctx);
+
+/**
+ * @brief Force the gate open, e.g. while a command session is running
+ *
+ * Pending pre-roll is replayed on the next processed frame. May be called from another task.
+ */
+void sr_vad_gate_set_bypass(sr_vad_gate_t *gate, bool bypass);
+
+/**
+ * @brief Whether the gate is currently passing every frame
+ */
+bool sr_vad_gate_is_open(const sr_vad_gate_t *gate);
+
+/**
+ * @brief Get counters
+ */
+void sr_vad_gate_get_stats(const sr_vad_gate_t *gate, sr_vad_gate_stats_t *stats);
+
+/**
+ * @brief Mean square energy of the `mic_mask` channels of an interleaved buffer
+ */
+uint32_t sr_vad_frame_energy(const int16_t *data, int samples, int channels, uint32_t mic_mask);
+
+/**
+ * @brief Zero crossings of an interleaved buffer, summed over the `mic_mask` channels
+ */
+uint32_t sr_vad_frame_zero_crossings(const int16_t *data, int samples, int channels, uint32_t mic_mask);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,208 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sr_vad_gate.h"
+
+struct sr_vad_gate {
+    sr_vad_gate_cfg_t   cfg;
+    int                 frame_len;      // samples per interleaved frame
+    int                 mics;           // channels in cfg.mic_mask
+    bool                open;
+    volatile bool       bypass;         // set by the detect task while a command may follow
+    int                 hangover;
+    uint32_t            noise_floor;
+    int16_t            *preroll;        // ring of preroll_frames frames
+    int                 preroll_head;   // oldest frame
+    int                 preroll_count;
+    sr_vad_gate_stats_t stats;
+};
+
+/*
+ * Both loops walk one microphone channel at a time with independent accumulators
+ * and no data dependent branches so they stay cheap on the Xtensa cores and
+ * vectorize on hosts when replaying recordings. Reference and unused channels are
+ * skipped, playback on the reference must not open the gate.
+ */
+uint32_t sr_vad_frame_energy(const int16_t *data, int samples, int channels, uint32_t mic_mask)
+{
+    int64_t acc = 0;
+    int mics = 0;
+    for (int ch = 0; ch < channels; ch++) {
+        if (!(mic_mask & (1u << ch))) {
+            continue;
+        }
+        const int16_t *p = data + ch;
+        int64_t acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+        int i = 0;
+        for (; i + 4 <= samples; i += 4) {
+            int32_t s0 = p[i * channels], s1 = p[(i + 1) * channels];
+            int32_t s2 = p[(i + 2) * channels], s3 = p[(i + 3) * channels];
+            acc0 += s0 * s0;
+            acc1 += s1 * s1;
+            acc2 += s2 * s2;
+            acc3 += s3 * s3;
+        }
+        for (; i < samples; i++) {
+            acc0 += (int32_t) p[i * channels] * p[i * channels];
+        }
+        acc += acc0 + acc1 + acc2 + acc3;
+        mics++;
+    }
+    return mics && samples > 0 ? (uint32_t) (acc / ((int64_t) mics * samples)) : 0;
+}
+
+uint32_t sr_vad_frame_zero_crossings(const int16_t *data, int samples, int channels, uint32_t mic_mask)
+{
+    uint32_t count = 0;
+    for (int ch = 0; ch < channels; ch++) {
+        if (!(mic_mask & (1u << ch))) {
+            continue;
+        }
+        // previous sample of the same channel, sign bit of the xor marks a crossing
+        const int16_t *p = data + ch;
+        for (int i = 1; i < samples; i++) {
+            count += ((uint16_t) (p[i * channels] ^ p[(i - 1) * channels])) >> 15;
+        }
+    }
+    return count;
+}
+
+// the oldest frame leaves the ring when it is full, so the ring always holds the latest audio
+static void preroll_push(sr_vad_gate_t *gate, const int16_t *frame)
+{
+    int n = gate->cfg.preroll_frames;
+    if (n <= 0) {
+        gate->stats.dropped++;
+        return;
+    }
+    int slot;
+    if (gate->preroll_count < n) {
+        slot = (gate->preroll_head + gate->preroll_count) % n;
+        gate->preroll_count++;
+    } else {
+        slot = gate->preroll_head;
+        gate->preroll_head = (gate->preroll_head + 1) % n;
+        gate->stats.dropped++;
+    }
+    memcpy(gate->preroll + slot * gate->frame_len, frame, gate->frame_len * sizeof(int16_t));
+}
+
+static int preroll_flush(sr_vad_gate_t *gate, sr_vad_gate_feed_t feed, void *ctx)
+{
+    int fed = gate->preroll_count;
+    while (gate->preroll_count) {
+        feed(ctx, gate->preroll + gate->preroll_head * gate->frame_len);
+        gate->preroll_head = (gate->preroll_head + 1) % gate->cfg.preroll_frames;
+        gate->preroll_count--;
+    }
+    gate->preroll_head = 0;
+    return fed;
+}
+
+static bool frame_active(sr_vad_gate_t *gate, const int16_t *frame)
+{
+    const sr_vad_gate_cfg_t *cfg = &gate->cfg;
+    uint64_t energy = sr_vad_frame_energy(frame, cfg->frame_samples, cfg->channels, cfg->mic_mask);
+    uint64_t floor = gate->noise_floor;
+    uint64_t ratio = gate->open ? cfg->close_ratio_q8 : cfg->open_ratio_q8;
+    bool active = (energy << 8) > floor * ratio;
+
+    // quiet but noisy-looking frames (fricatives) count once above the lower threshold
+    if (!active && (energy << 8) > floor * cfg->close_ratio_q8) {
+        uint32_t zc = sr_vad_frame_zero_crossings(frame, cfg->frame_samples, cfg->channels, cfg->mic_mask);
+        active = zc / gate->mics >= cfg->zcr_min;
+    }
+    if (active) {
+        // a lasting step in background noise slowly becomes the new floor, speech is too short to
+        // move it much
+        if (gate->open && energy > floor) {
+            floor += (energy - floor) >> cfg->open_rise_shift;
+        }
+    } else if (energy < floor) {
+        floor -= (floor - energy) >> 3;
+    } else {
+        floor += (energy - floor) >> 6;
+    }
+    gate->noise_floor = floor < cfg->min_energy ? cfg->min_energy : (uint32_t) floor;
+    return active;
+}
+
+sr_vad_gate_t *sr_vad_gate_create(const sr_vad_gate_cfg_t *cfg)
+{
+    if (cfg == NULL || cfg->channels <= 0 || cfg->channels > 32 || cfg->frame_samples <= 0 || cfg->preroll_frames < 0
+            || cfg->open_rise_shift < 0 || cfg->open_rise_shift > 31) {
+        return NULL;
+    }
+    uint32_t all = cfg->channels == 32 ? UINT32_MAX : (1u << cfg->channels) - 1;
+    uint32_t mic_mask = cfg->mic_mask ? cfg->mic_mask & all : all;
+    if (mic_mask == 0) {
+        return NULL;
+    }
+    sr_vad_gate_t *gate = (sr_vad_gate_t *) calloc(1, sizeof(sr_vad_gate_t));
+    if (gate == NULL) {
+        return NULL;
+    }
+    gate->cfg = *cfg;
+    gate->cfg.mic_mask = mic_mask;
+    gate->mics = __builtin_popcount(mic_mask);
+    gate->frame_len = cfg->channels * cfg->frame_samples;
+    gate->noise_floor = cfg->min_energy;
+    if (cfg->preroll_frames) {
+        gate->preroll = (int16_t *) malloc(cfg->preroll_frames * gate->frame_len * sizeof(int16_t));
+        if (gate->preroll == NULL) {
+            free(gate);
+            return NULL;
+        }
+    }
+    return gate;
+}
+
+void sr_vad_gate_destroy(sr_vad_gate_t *gate)
+{
+    if (gate) {
+        free(gate->preroll);
+        free(gate);
+    }
+}
+
+int sr_vad_gate_process(sr_vad_gate_t *gate, const int16_t *frame, sr_vad_gate_feed_t feed, void *ctx)
+{
+    int fed = 0;
+    gate->stats.frames++;
+
+    bool active = frame_active(gate, frame);
+    if (active) {
+        if (!gate->open) {
+            gate->stats.opens++;
+        }
+        gate->open = true;
+        gate->hangover = gate->cfg.hangover_frames;
+    } else if (gate->open && gate->hangover-- <= 0) {
+        gate->open = false;
+    }
+
+    if (gate->open || gate->bypass) {
+        fed += preroll_flush(gate, feed, ctx);
+        feed(ctx, frame);
+        fed++;
+    } else {
+        preroll_push(gate, frame);
+    }
+    gate->stats.fed += fed;
+    return fed;
+}
+
+void sr_vad_gate_set_bypass(sr_vad_gate_t *gate, bool bypass)
+{
+    gate->bypass = bypass;
+}
+
+bool sr_vad_gate_is_open(const sr_vad_gate_t *gate)
+{
+    return gate->open || gate->bypass;
+}
+
+void sr_vad_gate_get_stats(const sr_vad_gate_t *gate, sr_vad_gate_stats_t *stats)
+{
+    *stats = gate->stats;
+    stats->noise_floor = gate->noise_floor;
+}
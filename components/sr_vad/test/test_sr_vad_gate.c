@@ -0,0 +1,195 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "unity.h"
+#include "sr_vad_gate.h"
+
+/*
+ * Replays a synthetic 90 s "MMNR" recording through the gate, 32 ms frames at 16 kHz:
+ * background noise with a step up at 50 s, loud playback on the reference channel and
+ * wake word sized bursts at several levels. The unused channel carries the frame index
+ * so the frames reaching the AFE can be traced back to the recording.
+ */
+#define REC_CHANNELS        (4)
+#define REC_MIC_MASK        (0x3)
+#define REC_INDEX_CH        (2)
+#define REC_REF_CH          (3)
+#define REC_SAMPLES         (512)
+#define REC_FRAME_MS        (32)
+#define REC_FRAMES          (90 * 1000 / REC_FRAME_MS)
+#define REC_MS(ms)          ((ms) / REC_FRAME_MS)
+
+#define NOISE_LOW           (30)
+#define NOISE_HIGH          (90)
+#define NOISE_STEP_FRAME    REC_MS(50000)
+#define REF_START_FRAME     REC_MS(10000)
+#define REF_END_FRAME       REC_MS(20000)
+#define WORD_FRAMES         REC_MS(800)
+#define WORD_RAMP_FRAMES    (6)
+// frames before the onset the AFE must see as well, WakeNet needs the lead-in
+#define WORD_LEAD_FRAMES    (2)
+// quieter words may be missed, these may not
+#define WORD_MUST_AMP       (150)
+
+typedef struct {
+    int start_ms;
+    int amp;
+} rec_word_t;
+
+static const rec_word_t rec_words[] = {
+    { 3000, 3000 }, { 8000, 600 }, { 14000, 600 }, { 24000, 150 }, { 30000, 100 },
+    { 36000, 50 }, { 39000, 25 }, { 42000, 3000 }, { 47000, 300 }, { 72000, 600 }, { 76000, 3000 },
+};
+#define REC_WORDS   ((int)(sizeof(rec_words) / sizeof(rec_words[0])))
+
+static uint32_t rec_seed;
+
+static int16_t rec_noise(int amp)
+{
+    rec_seed = rec_seed * 1103515245 + 12345;
+    return (int16_t) ((int) ((rec_seed >> 8) % (2 * amp + 1)) - amp);
+}
+
+// 500 Hz triangle
+static int rec_tone(int n, int amp)
+{
+    int phase = n % 32;
+    int tri = phase < 16 ? phase * 4 - 32 : 96 - phase * 4;
+    return tri * amp / 32;
+}
+
+static void rec_frame(int index, int16_t *frame)
+{
+    int noise = index >= NOISE_STEP_FRAME ? NOISE_HIGH : NOISE_LOW;
+    int amp = 0;
+    int ramp = WORD_RAMP_FRAMES;
+    for (int w = 0; w < REC_WORDS; w++) {
+        int start = REC_MS(rec_words[w].start_ms);
+        if (index >= start && index < start + WORD_FRAMES) {
+            int pos = index - start;
+            amp = pos < ramp ? rec_words[w].amp * (pos + 1) / (ramp + 1) : rec_words[w].amp;
+        }
+    }
+    bool ref = index >= REF_START_FRAME && index < REF_END_FRAME;
+    for (int i = 0; i < REC_SAMPLES; i++) {
+        int16_t *s = frame + i * REC_CHANNELS;
+        int n = index * REC_SAMPLES + i;
+        s[0] = rec_noise(noise) + rec_tone(n, amp);
+        s[1] = rec_noise(noise) + rec_tone(n + 3, amp);
+        s[REC_INDEX_CH] = i == 0 ? (int16_t) index : 0;
+        s[REC_REF_CH] = ref ? rec_tone(n * 3, 8000) : 0;
+    }
+}
+
+typedef struct {
+    int     fed;
+    int     runs;
+    int     last;
+    uint8_t seen[REC_FRAMES];
+} rec_afe_t;
+
+static void rec_feed(void *ctx, const int16_t *frame)
+{
+    rec_afe_t *afe = ctx;
+    int index = frame[REC_INDEX_CH];
+    TEST_ASSERT_TRUE(index >= 0 && index < REC_FRAMES);
+    TEST_ASSERT_EQUAL(0, afe->seen[index]);
+    if (index != afe->last + 1) {
+        afe->runs++;
+    }
+    afe->seen[index] = 1;
+    afe->last = index;
+    afe->fed++;
+}
+
+static int rec_fed_between(const rec_afe_t *afe, int from, int to)
+{
+    int fed = 0;
+    for (int i = from; i < to; i++) {
+        fed += afe->seen[i];
+    }
+    return fed;
+}
+
+TEST_CASE("sr_vad_gate replay, AFE work saved against missed wake words", "[sr_vad]")
+{
+    sr_vad_gate_cfg_t cfg = SR_VAD_GATE_DEFAULT_CONFIG(REC_CHANNELS, REC_SAMPLES);
+    cfg.mic_mask = REC_MIC_MASK;
+    sr_vad_gate_t *gate = sr_vad_gate_create(&cfg);
+    TEST_ASSERT_NOT_NULL(gate);
+    int16_t *frame = malloc(REC_CHANNELS * REC_SAMPLES * sizeof(int16_t));
+    rec_afe_t *afe = calloc(1, sizeof(rec_afe_t));
+    TEST_ASSERT_NOT_NULL(frame);
+    TEST_ASSERT_NOT_NULL(afe);
+    afe->last = -2;
+
+    rec_seed = 1;
+    clock_t gate_ticks = 0;
+    for (int i = 0; i < REC_FRAMES; i++) {
+        rec_frame(i, frame);
+        clock_t start = clock();
+        sr_vad_gate_process(gate, frame, rec_feed, afe);
+        gate_ticks += clock() - start;
+    }
+
+    int misses = 0;
+    for (int w = 0; w < REC_WORDS; w++) {
+        int start = REC_MS(rec_words[w].start_ms);
+        int heard = rec_fed_between(afe, start - WORD_LEAD_FRAMES, start + WORD_FRAMES);
+        bool missed = heard < WORD_LEAD_FRAMES + WORD_FRAMES;
+        printf("vad replay: word at %5d ms, level %4d, %d of %d frames fed%s\n", rec_words[w].start_ms,
+               rec_words[w].amp, heard, WORD_LEAD_FRAMES + WORD_FRAMES, missed ? ", missed" : "");
+        if (rec_words[w].amp >= WORD_MUST_AMP) {
+            TEST_ASSERT_FALSE(missed);
+        }
+        misses += missed;
+    }
+    sr_vad_gate_stats_t stats;
+    sr_vad_gate_get_stats(gate, &stats);
+    printf("vad replay: %d frames, %d fed in %d runs, AFE work saved %d%%, %d of %d words missed, gate %.1f us/frame\n",
+           REC_FRAMES, afe->fed, afe->runs, 100 - afe->fed * 100 / REC_FRAMES, misses, REC_WORDS,
+           (double) gate_ticks * 1000000 / CLOCKS_PER_SEC / REC_FRAMES);
+
+    TEST_ASSERT_EQUAL(REC_FRAMES, stats.frames);
+    TEST_ASSERT_EQUAL(afe->fed, stats.fed);
+    // the last pre-roll is still held back
+    TEST_ASSERT_EQUAL(REC_FRAMES - afe->fed - cfg.preroll_frames, stats.dropped);
+    // every open period reaches the AFE as one gapless run, pre-roll included
+    TEST_ASSERT_EQUAL(stats.opens, afe->runs);
+    // playback on the reference channel alone never opens the gate
+    TEST_ASSERT_EQUAL(0, rec_fed_between(afe, REC_MS(16000), REF_END_FRAME));
+    // the noise step opens the gate, the rising floor closes it again well before the next word
+    TEST_ASSERT_TRUE(afe->seen[NOISE_STEP_FRAME]);
+    TEST_ASSERT_EQUAL(0, rec_fed_between(afe, REC_MS(66000), REC_MS(72000) - cfg.preroll_frames));
+    TEST_ASSERT_EQUAL(0, rec_fed_between(afe, REC_MS(82000), REC_FRAMES));
+    TEST_ASSERT_TRUE(afe->fed * 2 < REC_FRAMES);
+
+    free(afe);
+    free(frame);
+    sr_vad_gate_destroy(gate);
+}
+
+TEST_CASE("sr_vad frame energy and zero crossings only count microphones", "[sr_vad]")
+{
+    int16_t frame[4 * 8];
+    for (int i = 0; i < 8; i++) {
+        frame[i * 4 + 0] = i & 1 ? 100 : -100;
+        frame[i * 4 + 1] = 10;
+        frame[i * 4 + 2] = 30000;
+        frame[i * 4 + 3] = i & 1 ? 20000 : -20000;
+    }
+    TEST_ASSERT_EQUAL(10000, sr_vad_frame_energy(frame, 8, 4, 0x1));
+    TEST_ASSERT_EQUAL((10000 + 100) / 2, sr_vad_frame_energy(frame, 8, 4, 0x3));
+    TEST_ASSERT_EQUAL(7, sr_vad_frame_zero_crossings(frame, 8, 4, 0x3));
+    TEST_ASSERT_EQUAL(14, sr_vad_frame_zero_crossings(frame, 8, 4, 0x9));
+    // a partial last group of four
+    TEST_ASSERT_EQUAL(10000, sr_vad_frame_energy(frame, 7, 4, 0x1));
+
+    sr_vad_gate_cfg_t cfg = SR_VAD_GATE_DEFAULT_CONFIG(4, 8);
+    cfg.mic_mask = 0x30;
+    TEST_ASSERT_NULL(sr_vad_gate_create(&cfg));
+}
@@ -13,9 +13,14 @@
 #include "esp_afe_sr_iface.h"
 #include "esp_afe_sr_models.h"
 #include "esp_board_init.h"
+#include "i2s_capture.h"
+#include "play_ref.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
 #include "esp_mn_iface.h"
 #include "esp_mn_models.h"
+#include "esp_mn_speech_commands.h"
 #include "esp_process_sdkconfig.h"
 #include "esp_wn_iface.h"
 #include "esp_wn_models.h"
@@ -29,15 +34,60 @@
 // specific includes for iron man suit control
 #include "led_im.h"
 #include "servo_im.h"
+#include "sr_session.h"
+#include "sr_governor.h"
+#include "sr_vad_gate.h"
+#include "sr_cmdset.h"
+#include "sr_cmdset_store.h"
+#include "boot_graph.h"
+#include "boot_prof.h"
+#include "sr_model_index.h"
 
 static const char *TAG = "MK39 Master Control";
 
-//
-int detect_flag = 0;
+// time allowed for a command after the wake word, also used as the MultiNet timeout
+#define SR_LISTEN_WINDOW_MS     6000
+// keep recognising commands for this long after the first one, 0 for no limit
+#define SR_CONTINUOUS_MS        0
+// end a multi-command session when no command follows within this time,
+// set this and SR_CONTINUOUS_MS to 0 to require the wake word for every command
+#define SR_SESSION_IDLE_MS      4000
+// command set loaded from the cmdsets partition at boot instead of the sdkconfig commands
+#define SR_CMDSET_BOOT_NAME     "default"
+// from the wake word to the end of the session, keep the servo signal running and draw LED
+// effects right away, comment out to compare the latencies printed after each session
+#define SR_ARM_ON_WAKE
+// also write the startup profile here, needs the SD card mounted by esp_sdcard_init
+// #define BOOT_PROF_SAVE_PATH     "/sdcard/boot_prof.txt"
+
 static esp_afe_sr_iface_t *afe_handle = NULL;
 static volatile int task_flag = 0;
 srmodel_list_t *models = NULL;
-static int play_voice = -2;
+static sr_session_t session;
+static sr_vad_gate_t *feed_gate = NULL;
+static sr_cmdset_t *active_cmdset = NULL;
+// shared by the feed and detect tasks, filled in by the afe boot step
+static afe_task_into_t task_info;
+// feed channels carrying a microphone, the pre-VAD ignores the reference
+static uint32_t feed_mic_mask = 0;
+
+static void feed_gate_cb(void *ctx, const int16_t *frame)
+{
+    afe_task_into_t *afe_task_info = (afe_task_into_t *)ctx;
+    afe_task_info->afe_handle->feed(afe_task_info->afe_data, frame);
+}
+
+static void feed_gate_print(void)
+{
+    if (feed_gate == NULL) {
+        return;
+    }
+    sr_vad_gate_stats_t stats;
+    sr_vad_gate_get_stats(feed_gate, &stats);
+    printf("feed gate: %u frames, %u fed, %u dropped, %u opens, noise floor %u\n",
+           (unsigned) stats.frames, (unsigned) stats.fed, (unsigned) stats.dropped,
+           (unsigned) stats.opens, (unsigned) stats.noise_floor);
+}
 
 void feed_Task(void *arg)
 {
@@ -51,19 +101,156 @@ void feed_Task(void *arg)
     assert(nch == feed_channel);
     int16_t *i2s_buff = malloc(audio_chunksize * sizeof(int16_t) * feed_channel);
     assert(i2s_buff);
+    // skip AFE work on silence while waiting for the wake word
+    sr_vad_gate_cfg_t gate_cfg = SR_VAD_GATE_DEFAULT_CONFIG(feed_channel, audio_chunksize);
+    gate_cfg.mic_mask = feed_mic_mask;
+    feed_gate = sr_vad_gate_create(&gate_cfg);
+
+    int feed_len = audio_chunksize * sizeof(int16_t) * feed_channel;
+    bool fed = false;
 
     while (task_flag) {
-        esp_get_feed_data(true, i2s_buff, audio_chunksize * sizeof(int16_t) * feed_channel);
+        int16_t *frame = i2s_buff;
+#if CONFIG_AUDIO_CAPTURE_CALLBACK
+        // the DMA buffer itself, handed over by the capture ISR
+        if (esp_get_feed_frame(&frame, feed_len, portMAX_DELAY) != ESP_OK) {
+            continue;
+        }
+#else
+        esp_get_feed_data(true, i2s_buff, feed_len);
+#endif
 
-        afe_handle->feed(afe_data, i2s_buff);
+        if (feed_gate == NULL) {
+            afe_handle->feed(afe_data, frame);
+        } else {
+            sr_vad_gate_process(feed_gate, frame, feed_gate_cb, afe_task_info);
+        }
+#if CONFIG_AUDIO_CAPTURE_CALLBACK
+        esp_release_feed_frame();
+#endif
+        if (!fed) {
+            // boot ends with the first captured frame, the detect task prints the profile
+            fed = true;
+            boot_prof_mark("detect_start");
+            xTaskNotifyGive(afe_task_info->fetch_task);
+        }
     }
     if (i2s_buff) {
         free(i2s_buff);
         i2s_buff = NULL;
     }
+    if (feed_gate) {
+        sr_vad_gate_destroy(feed_gate);
+        feed_gate = NULL;
+    }
     vTaskDelete(NULL);
 }
 
+static void actuators_arm(bool arm)
+{
+#ifdef SR_ARM_ON_WAKE
+    servo_arm(arm);
+    led_arm(arm);
+#endif
+}
+
+static void sr_session_apply(uint32_t actions, esp_afe_sr_iface_t *afe_handle, esp_afe_sr_data_t *afe_data,
+                             esp_mn_iface_t *multinet, model_iface_data_t *model_data)
+{
+    if (actions & SR_ACTION_MN_CLEAN) {
+        multinet->clean(model_data);
+    }
+    if (actions & SR_ACTION_WAKENET_DISABLE) {
+        afe_handle->disable_wakenet(afe_data);
+    }
+    if (actions & SR_ACTION_WAKENET_ENABLE) {
+        afe_handle->enable_wakenet(afe_data);
+    }
+    if (actions & SR_ACTION_LISTEN_END) {
+        actuators_arm(false);
+        sr_session_print_stats(&session, esp_log_timestamp());
+        feed_gate_print();
+        i2s_capture_print_stats();
+#if CONFIG_AUDIO_PLAY_REF
+        play_ref_print_stats();
+#endif
+        servo_print_latency();
+        led_print_latency();
+    }
+    // full front end, and MultiNet fed every frame, only while a command may follow
+    bool listening = !sr_session_is_idle(&session);
+    sr_governor_set_mode(listening ? SR_PERF_SESSION : SR_PERF_IDLE);
+    if (feed_gate) {
+        sr_vad_gate_set_bypass(feed_gate, listening);
+    }
+}
+
+// replace the MultiNet vocabulary, only call while no command is being decoded
+static esp_err_t command_set_apply(sr_cmdset_t *set)
+{
+    int64_t start = esp_timer_get_time();
+    esp_mn_commands_clear();
+    for (int i = 0; i < sr_cmdset_count(set); i++) {
+        int command_id;
+        const char *phrase = sr_cmdset_get(set, i, &command_id);
+        esp_mn_commands_add(command_id, phrase);
+    }
+    esp_mn_error_t *err = esp_mn_commands_update();
+    if (err) {
+        for (int i = 0; i < err->num; i++) {
+            printf("command set %s: invalid phrase %s\n", sr_cmdset_name(set), err->phrases[i]->string);
+        }
+        return ESP_FAIL;
+    }
+    printf("command set %s active, %d phrases in %lld us\n", sr_cmdset_name(set),
+           sr_cmdset_count(set), esp_timer_get_time() - start);
+    if (active_cmdset != set) {
+        sr_cmdset_destroy(active_cmdset);
+        active_cmdset = set;
+    }
+    return ESP_OK;
+}
+
+// the helmet sequences end the listen window, other commands leave it open until MultiNet times out
+static bool command_ends_listen(int command_id)
+{
+    return command_id == 0 || command_id == 2;
+}
+
+static void command_dispatch(int command_id)
+{
+    switch (command_id)
+    {
+        case 0:
+            //open helmet
+            helmet_open();
+            printf("Open Sequence\n");
+            //the visor moves in the background, the lights change with it
+            led_eye_control(0);
+            //change reactor and jetpack color to yellow
+            led_color(50, 50, 0);
+            break;
+
+        case 1:
+            //hulk out
+            //change reactor and jetpack color to green
+            led_color(100, 0, 0);
+            break;
+
+        case 2:
+            //close helmet
+            helmet_close();
+            printf("Close Sequence\n");
+            led_eye_control(1);
+            //change reactor and jetpack color to blue
+            led_color(0, 0, 100);
+            break;
+
+        default:
+            break;
+    }
+}
+
 void detect_Task(void *arg)
 {
     afe_task_into_t *afe_task_info = (afe_task_into_t *)arg;
@@ -74,13 +261,36 @@ void detect_Task(void *arg)
     char *mn_name = esp_srmodel_filter(models, ESP_MN_PREFIX, ESP_MN_ENGLISH);
     printf("multinet:%s\n", mn_name);
     esp_mn_iface_t *multinet = esp_mn_handle_from_name(mn_name);
-    model_iface_data_t *model_data = multinet->create(mn_name, 6000);
+    int prof = boot_prof_begin("mn_create");
+    model_iface_data_t *model_data = multinet->create(mn_name, SR_LISTEN_WINDOW_MS);
+    boot_prof_end(prof);
     int mu_chunksize = multinet->get_samp_chunksize(model_data);
+    prof = boot_prof_begin("commands");
     esp_mn_commands_update_from_sdkconfig(multinet, model_data); // Add speech commands from sdkconfig
+    // a set saved in the cmdsets partition overrides the sdkconfig commands
+    sr_cmdset_t *boot_set = sr_cmdset_store_load(SR_CMDSET_BOOT_NAME);
+    if (boot_set && command_set_apply(boot_set) != ESP_OK) {
+        sr_cmdset_destroy(boot_set);
+        esp_mn_commands_update_from_sdkconfig(multinet, model_data);
+    }
+    boot_prof_end(prof);
     assert(mu_chunksize == afe_chunksize);
     //print active speech commands
     multinet->print_active_speech_commands(model_data);
 
+    sr_session_cfg_t session_cfg = SR_SESSION_DEFAULT_CONFIG();
+    session_cfg.listen_window_ms = SR_LISTEN_WINDOW_MS;
+    session_cfg.continuous_ms = SR_CONTINUOUS_MS;
+    session_cfg.session_idle_ms = SR_SESSION_IDLE_MS;
+    sr_session_init(&session, &session_cfg, esp_log_timestamp());
+
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    boot_prof_report(stdout);
+#ifdef BOOT_PROF_SAVE_PATH
+    if (boot_prof_save(BOOT_PROF_SAVE_PATH) != 0) {
+        printf("boot profile not saved to %s\n", BOOT_PROF_SAVE_PATH);
+    }
+#endif
     printf("------------detect start------------\n");
     while (task_flag) {
         afe_fetch_result_t* res = afe_handle->fetch(afe_data); 
@@ -89,83 +299,75 @@ void detect_Task(void *arg)
             break;
         }
 
+        sr_event_t event = SR_EVENT_NONE;
         if (res->wakeup_state == WAKENET_DETECTED) {
             printf("WAKEWORD DETECTED\n");
-            multinet->clean(model_data);
-            //custom task to process chest reactor LEDs
-            xTaskCreatePinnedToCore(&led_process, "led", 8 * 1024, NULL, 5, NULL, 1);	    
+            event = SR_EVENT_WAKE_DETECTED;
+            //a command may follow, get the servos and LEDs ready for it
+            actuators_arm(true);
+            //chest reactor LEDs, rendered in the background by the led task
+            led_process();
         } else if (res->wakeup_state == WAKENET_CHANNEL_VERIFIED) {
-            play_voice = -1;
-            detect_flag = 1;
+            event = SR_EVENT_WAKE_VERIFIED;
             printf("AFE_FETCH_CHANNEL_VERIFIED, channel index: %d\n", res->trigger_channel_id);
-            // afe_handle->disable_wakenet(afe_data);
-            // afe_handle->disable_aec(afe_data);
+        }
+        uint32_t actions = sr_session_step(&session, event, esp_log_timestamp());
+        sr_session_apply(actions, afe_handle, afe_data, multinet, model_data);
+        if (actions & SR_ACTION_LISTEN_END) {
+            printf("listen window closed\n");
+            printf("\n-----------Awaiting Order-----------\n");
         }
 
-        if (detect_flag == 1) {
-            esp_mn_state_t mn_state = multinet->detect(model_data, res->data);
-
-            if (mn_state == ESP_MN_STATE_DETECTING) {
-                continue;
+        if (!sr_session_wants_command(&session)) {
+            // vocabulary swaps only happen between sessions
+            sr_cmdset_t *next_set = sr_cmdset_take_pending();
+            if (next_set && command_set_apply(next_set) != ESP_OK) {
+                sr_cmdset_destroy(next_set);
+                if (active_cmdset) {
+                    command_set_apply(active_cmdset);
+                } else {
+                    esp_mn_commands_update_from_sdkconfig(multinet, model_data);
+                }
             }
+            continue;
+        }
 
-            if (mn_state == ESP_MN_STATE_DETECTED) {
-                esp_mn_results_t *mn_result = multinet->get_results(model_data);
-                for (int i = 0; i < mn_result->num; i++) {
-                    printf("TOP %d, command_id: %d, phrase_id: %d, string: %s, prob: %f\n", 
-                    i+1, mn_result->command_id[i], mn_result->phrase_id[i], mn_result->string, mn_result->prob[i]);
-                }
-                if(mn_result->num >0){
-                    printf("processing\n");
-                    switch (mn_result->command_id[0])
-                    {
-                        case 0:
-                            //open helmet
-                            helmet_open();
-                            detect_flag = 2;
-                            printf("Open Sequence\n");
-                            //allow time for helmet to open
-                            vTaskDelay(50 / portTICK_PERIOD_MS);
-                            led_eye_control(0);
-                            //change reactor and jetpack color to yellow
-                            led_color(50, 50, 0);
-                            break;
-                        
-                        case 1:
-                            //hulk out
-                            //change reactor and jetpack color to green
-                            led_color(100, 0, 0);
-                            break;
-
-                        case 2:
-                            //close helmet
-                            helmet_close();
-                            detect_flag = 2;
-                            printf("Close Sequence\n");
-                            //allow time for helmet to close
-                            vTaskDelay(50 / portTICK_PERIOD_MS);
-                            led_eye_control(1);
-                            //change reactor and jetpack color to blue
-                            led_color(0, 0, 100);
-                            break;
-
-                        default:
-                            break;
-                    }
-                }
-                printf("-----------Awaiting Order-----------\n");
+        esp_mn_state_t mn_state = multinet->detect(model_data, res->data);
 
-                
+        if (mn_state == ESP_MN_STATE_DETECTING) {
+            continue;
+        }
+
+        if (mn_state == ESP_MN_STATE_DETECTED) {
+            esp_mn_results_t *mn_result = multinet->get_results(model_data);
+            for (int i = 0; i < mn_result->num; i++) {
+                printf("TOP %d, command_id: %d, phrase_id: %d, string: %s, prob: %f\n", 
+                i+1, mn_result->command_id[i], mn_result->phrase_id[i], mn_result->string, mn_result->prob[i]);
+            }
+            bool ends_listen = mn_result->num > 0 && command_ends_listen(mn_result->command_id[0]);
+            actions = sr_session_step(&session, ends_listen ? SR_EVENT_CMD_DETECTED : SR_EVENT_CMD_DETECTED_KEEP,
+                                      esp_log_timestamp());
+            if ((actions & SR_ACTION_DISPATCH) && mn_result->num > 0) {
+                printf("processing\n");
+                command_dispatch(mn_result->command_id[0]);
             }
+            sr_session_apply(actions, afe_handle, afe_data, multinet, model_data);
+            if (sr_session_is_continuous(&session)) {
+                printf("-----------Awaiting Next Order------\n");
+            } else {
+                printf("-----------Awaiting Order-----------\n");
+            }
+        }
 
-            if (mn_state == ESP_MN_STATE_TIMEOUT) {
-                esp_mn_results_t *mn_result = multinet->get_results(model_data);
-                printf("timeout, string:%s\n", mn_result->string);
-                afe_handle->enable_wakenet(afe_data);
-                detect_flag = 0;
+        if (mn_state == ESP_MN_STATE_TIMEOUT) {
+            esp_mn_results_t *mn_result = multinet->get_results(model_data);
+            printf("timeout, string:%s\n", mn_result->string);
+            actions = sr_session_step(&session, SR_EVENT_CMD_TIMEOUT, esp_log_timestamp());
+            sr_session_apply(actions, afe_handle, afe_data, multinet, model_data);
+            if (actions & SR_ACTION_LISTEN_END) {
                 printf("\n-----------Awaiting Order-----------\n");
-                continue;
             }
+            continue;
         }
     }
     if (model_data) {
@@ -176,50 +378,181 @@ void detect_Task(void *arg)
     vTaskDelete(NULL);
 }
 
-void app_main()
+static esp_err_t boot_leds(void *arg)
 {
     led_set();
+    return ESP_OK;
+}
+
+static esp_err_t boot_servo(void *arg)
+{
+    // servo calibration is kept in NVS, the servos use their defaults without it
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase();
+        ret = nvs_flash_init();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "NVS unavailable: %s", esp_err_to_name(ret));
+    }
     sr_servo_init();
+    return ESP_OK;
+}
 
-    models = esp_srmodel_init("model"); // partition label defined in partitions.csv
-    ESP_ERROR_CHECK(esp_board_init(AUDIO_HAL_16K_SAMPLES, 1, 16));
+static esp_err_t boot_models(void *arg)
+{
+    // one WakeNet and one MultiNet, noise suppression and VAD are the WebRTC ones without a model
+    static const char *const prefixes[] = { ESP_WN_PREFIX, ESP_MN_PREFIX };
+    int prof = boot_prof_begin("models");
+    models = sr_model_index_init("model", prefixes, 2); // partition label defined in partitions.csv
+    if (models == NULL) {
+        models = esp_srmodel_init("model");
+    }
+    boot_prof_end(prof);
+    return models ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+static esp_err_t boot_board(void *arg)
+{
+    int prof = boot_prof_begin("board");
+    esp_err_t ret = esp_board_init(AUDIO_HAL_16K_SAMPLES, 1, 16);
+    boot_prof_end(prof);
     // ESP_ERROR_CHECK(esp_sdcard_init("/sdcard", 10));
 #if defined CONFIG_ESP32_KORVO_V1_1_BOARD
-    led_init();
+    if (ret == ESP_OK) {
+        led_init();
+    }
 #endif
+    return ret;
+}
 
+// channels marked 'M' in an AFE input format
+static uint32_t input_format_mics(const char *format)
+{
+    uint32_t mask = 0;
+    for (int i = 0; format[i]; i++) {
+        if (format[i] == 'M') {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+static esp_err_t boot_afe(void *arg)
+{
 #if CONFIG_IDF_TARGET_ESP32
     printf("This demo only support ESP32S3\n");
-    return;
+    return ESP_ERR_NOT_SUPPORTED;
 #else 
     // M - Microphone channel
     // R - Playback reference channel
     // N - Unused or unknown channel
-    afe_config_t *afe_config = afe_config_init("MMNR", models, AFE_TYPE_SR, AFE_MODE_HIGH_PERF);
+    // boards with a software playback reference feed one microphone and the reference
+#if CONFIG_AUDIO_PLAY_REF
+    const char *input_format = "MR";
+#else
+    const char *input_format = "MMNR";
+#endif
+    feed_mic_mask = input_format_mics(input_format);
+    int prof = boot_prof_begin("afe_config");
+    afe_config_t *afe_config = afe_config_init(input_format, models, AFE_TYPE_SR, AFE_MODE_HIGH_PERF);
     afe_config_print(afe_config); // print all configurations
     esp_afe_sr_iface_t *afe_handle = esp_afe_handle_from_config(afe_config);
-#endif
 
     afe_config->wakenet_model_name = esp_srmodel_filter(models, ESP_WN_PREFIX, NULL);
-#if defined CONFIG_ESP32_S3_BOX_BOARD || defined CONFIG_ESP32_S3_EYE_BOARD || CONFIG_ESP32_S3_DEVKIT_C
+#if CONFIG_AUDIO_PLAY_REF
+    afe_config->aec_init = true;
+#elif defined CONFIG_ESP32_S3_BOX_BOARD || defined CONFIG_ESP32_S3_EYE_BOARD || CONFIG_ESP32_S3_DEVKIT_C
     afe_config->aec_init = false;
     #if defined CONFIG_ESP32_S3_EYE_BOARD || CONFIG_ESP32_S3_DEVKIT_C
         afe_config->pcm_config.total_ch_num = 2;
         afe_config->pcm_config.mic_num = 1;
         afe_config->pcm_config.ref_num = 1;
+        feed_mic_mask = 0x1;
     #endif
 #endif
 
+    boot_prof_end(prof);
+
+    prof = boot_prof_begin("afe_create");
     esp_afe_sr_data_t *afe_data = afe_handle->create_from_config(afe_config);
-    afe_task_into_t task_info;
+    boot_prof_end(prof);
+    if (afe_data == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    // the board came up beside the AFE with the capture DMA sized from Kconfig
+    int feed_chunksize = afe_handle->get_feed_chunksize(afe_data);
+    if (feed_chunksize != CONFIG_AUDIO_CAPTURE_CHUNK_FRAMES) {
+        printf("AFE feed chunk is %d frames, set AUDIO_CAPTURE_CHUNK_FRAMES to it\n", feed_chunksize);
+#if CONFIG_AUDIO_CAPTURE_CALLBACK
+        // each DMA buffer is fed as one chunk
+        return ESP_ERR_INVALID_SIZE;
+#endif
+    }
+    // start with WakeNet and VAD only, the rest is enabled once the wake word is heard
+    sr_governor_init(afe_handle, afe_data, afe_config);
     task_info.afe_data = afe_data;
     task_info.afe_handle = afe_handle;
     task_info.feed_task = NULL;
     task_info.fetch_task = NULL;
     task_flag = 1;
+    return ESP_OK;
+#endif
+}
 
-    xTaskCreatePinnedToCore(&detect_Task, "detect", 8 * 1024, (void*)&task_info, 5, NULL, 1);
-    xTaskCreatePinnedToCore(&feed_Task, "feed", 8 * 1024, (void*)&task_info, 5, NULL, 0);
+// MultiNet is created inside the detect task, so it overlaps with the board bring-up
+static esp_err_t boot_detect(void *arg)
+{
+    BaseType_t ret = xTaskCreatePinnedToCore(&detect_Task, "detect", 8 * 1024, (void*)&task_info, 5,
+                                             &task_info.fetch_task, 1);
+    return ret == pdPASS ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+static esp_err_t boot_feed(void *arg)
+{
+    BaseType_t ret = xTaskCreatePinnedToCore(&feed_Task, "feed", 8 * 1024, (void*)&task_info, 5,
+                                             &task_info.feed_task, 0);
+    return ret == pdPASS ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+enum {
+    BOOT_LEDS = 0,
+    BOOT_SERVO,
+    BOOT_MODELS,
+    BOOT_BOARD,
+    BOOT_AFE,
+    BOOT_DETECT,
+    BOOT_FEED,
+    BOOT_STEP_NUM,
+};
+
+// the AFE only waits for the models, the codec and the actuators come up beside it,
+// feed starts last so the detect task is there to hear about its first frame
+static const boot_step_t boot_steps[BOOT_STEP_NUM] = {
+    [BOOT_LEDS]   = { "leds",   boot_leds,   NULL, 0, 0, 0 },
+    [BOOT_SERVO]  = { "servo",  boot_servo,  NULL, 0, 0, 0 },
+    [BOOT_MODELS] = { "models", boot_models, NULL, 0, 1, 0 },
+    [BOOT_BOARD]  = { "board",  boot_board,  NULL, 0, 0, 0 },
+    [BOOT_AFE]    = { "afe",    boot_afe,    NULL, BOOT_STEP_BIT(BOOT_MODELS), 1, 8 * 1024 },
+    [BOOT_DETECT] = { "detect", boot_detect, NULL, BOOT_STEP_BIT(BOOT_AFE), 1, 0 },
+    [BOOT_FEED]   = { "feed",   boot_feed,   NULL,
+                      BOOT_STEP_BIT(BOOT_AFE) | BOOT_STEP_BIT(BOOT_BOARD) | BOOT_STEP_BIT(BOOT_DETECT), 0, 0 },
+};
+
+void app_main()
+{
+    // app_main runs at a lower priority, the steps preempt it
+    boot_graph_t *boot = boot_graph_start(boot_steps, BOOT_STEP_NUM, 5);
+    if (boot == NULL) {
+        printf("boot graph failed\n");
+        return;
+    }
+    boot_graph_wait(boot, BOOT_STEP_BIT(BOOT_STEP_NUM) - 1, portMAX_DELAY);
+    boot_graph_print(boot);
+    // a board without working codec still restarts, as before
+    esp_err_t board_ret = boot_graph_wait(boot, BOOT_STEP_BIT(BOOT_BOARD), 0);
+    boot_graph_destroy(boot);
+    ESP_ERROR_CHECK(board_ret);
 
     // // You can call afe_handle->destroy to destroy AFE.
     // task_flag = 0;